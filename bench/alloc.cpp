@@ -0,0 +1,154 @@
+/*
+ * 2mat/bench/alloc.cpp -- allocation counting for the 2mat benchmarks
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "alloc.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+    std::atomic<uint64_t> count(0);
+
+    void *allocate(std::size_t n)
+    {
+        count.fetch_add(1,std::memory_order_relaxed);
+        return std::malloc(n ? n : 1);
+    }
+
+    void *allocate(std::size_t n, std::align_val_t alignment)
+    {
+        count.fetch_add(1,std::memory_order_relaxed);
+        std::size_t align = std::max(static_cast<std::size_t>(alignment),sizeof(void *));
+        return std::aligned_alloc(align,(std::max<std::size_t>(n,1)+align-1)/align*align);
+    }
+
+}
+
+uint64_t allocations()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t n)
+{
+    if (void *p = allocate(n)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t n)
+{
+    if (void *p = allocate(n)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept
+{
+    return allocate(n);
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept
+{
+    return allocate(n);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void *operator new(std::size_t n, std::align_val_t alignment)
+{
+    if (void *p = allocate(n,alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void *operator new[](std::size_t n, std::align_val_t alignment)
+{
+    if (void *p = allocate(n,alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t n, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate(n,alignment);
+}
+
+void *operator new[](std::size_t n, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate(n,alignment);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,35 @@
+/*
+ * 2mat/bench/alloc.hpp -- allocation counting for the 2mat benchmarks
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_BENCH_ALLOC_H
+#define TOO_MAT_BENCH_ALLOC_H
+
+#include <cstdint>
+
+/*
+ * uint64_t allocations()
+ *
+ * Returns the number of allocations made by the program so far, so that the benchmarks can report
+ * the number of allocations made per element. Every replaceable form of operator new is counted.
+ * They are defined in their own file so that their malloc and free are never inlined into the
+ * code that calls them, where GCC reports them as mismatched with new and delete.
+ */
+uint64_t allocations();
+
+#endif
@@ -0,0 +1,788 @@
+/*
+ * 2mat/bench/bench.cpp -- write throughput benchmarks for the 2mat library
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Usage: 2mat_bench [options]
+ *
+ *  --suite a,b,...  run only the named suites: count, size, depth, type, level, entropy, datenum,
+ *                   fwriter, contention, scalars, rowmajor, labels, half, estimate
+ *                   (default: all)
+ *  --format f       csv (default) or json
+ *  --out path       write the results here instead of to stdout
+ *  --dir path       directory for the files written (default: the current directory)
+ *  --repeat n       run each case n times and report the fastest (default: 3)
+ *  --max-size n     largest element in the size suite, in bytes (default: 64 MiB, at most 1 GiB)
+ *  --quick          smaller ranges and a single repeat, for a quick check
+ *
+ * Each file benchmark times creating the file, adding the elements and closing it; MB/s is the
+ * number of bytes of element data (not of the file) per second of wall time. Progress is written
+ * to stderr.
+ */
+
+#include "2mat.hpp"
+#include "datenum.hpp"
+#include "io/fwriter.hpp"
+#include "alloc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    typedef std::chrono::steady_clock bclock;
+
+    struct settings
+    {
+        std::vector<std::string> suites;
+        std::string format = "csv";
+        std::string out;
+        std::string dir = ".";
+        unsigned int repeat = 3;
+        mat::dim_t max_size = 64ull << 20;
+        bool quick = false;
+
+        [[nodiscard]] bool run(const std::string &suite) const
+        {
+            return suites.empty() || std::find(suites.begin(),suites.end(),suite) != suites.end();
+        }
+    };
+
+    // One line of output
+    struct result
+    {
+        std::string suite, name, version, param;
+        mat::dim_t bytes = 0, file_bytes = 0, ops = 0;
+        double seconds = 0, allocs = 0;
+    };
+
+    std::vector<result> results;
+
+    // Stops the compiler discarding results that are otherwise unused
+    volatile double sink;
+
+    mat::dim_t file_size(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        return in ? (mat::dim_t)in.tellg() : 0;
+    }
+
+    void report(result r)
+    {
+        std::cerr << r.suite << " " << r.name << " " << r.version << " " << r.param << ": "
+            << r.seconds*1e3 << " ms";
+        if (r.allocs) std::cerr << ", " << r.allocs << " allocations/op";
+        std::cerr << "\n";
+        results.push_back(std::move(r));
+    }
+
+    // Runs fn the requested number of times, returning the fastest wall time in seconds
+    double best_of(unsigned int repeat, const std::function<void()> &fn)
+    {
+        double best = 1e300;
+        for (unsigned int i = 0; i < std::max(repeat,1u); ++i)
+        {
+            auto start = bclock::now();
+            fn();
+            std::chrono::duration<double> dt = bclock::now()-start;
+            best = std::min(best,dt.count());
+        }
+        return best;
+    }
+
+    //------------------------------------- test data -------------------------------------//
+
+    enum entropy { ZEROS, SMOOTH, RANDOM };
+
+    const char *entropy_name(entropy e)
+    {
+        return e == ZEROS ? "zeros" : e == SMOOTH ? "smooth" : "random";
+    }
+
+    uint64_t xorshift(uint64_t &s)
+    {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        return s;
+    }
+
+    template <typename T>
+    T sample(entropy e, mat::dim_t i, uint64_t &rng)
+    {
+        if (e == ZEROS) return T();
+        if (e == SMOOTH) return (T)(100*std::sin(i*1e-3));
+        uint64_t r = xorshift(rng);
+        T v;
+        std::memcpy(&v,&r,std::min(sizeof(T),sizeof(r)));
+        return v;
+    }
+
+    template <>
+    bool sample<bool>(entropy e, mat::dim_t i, uint64_t &rng)
+    {
+        if (e == ZEROS) return false;
+        if (e == SMOOTH) return std::sin(i*1e-3) > 0;
+        return xorshift(rng) & 1;
+    }
+
+    template <>
+    double sample<double>(entropy e, mat::dim_t i, uint64_t &rng)
+    {
+        if (e == RANDOM) return (double)xorshift(rng)/(double)UINT64_MAX;
+        return e == ZEROS ? 0 : std::sin(i*1e-3);
+    }
+
+    template <>
+    float sample<float>(entropy e, mat::dim_t i, uint64_t &rng)
+    {
+        return (float)sample<double>(e,i,rng);
+    }
+
+    template <>
+    std::complex<double> sample<std::complex<double>>(entropy e, mat::dim_t i, uint64_t &rng)
+    {
+        return {sample<double>(e,i,rng), sample<double>(e,i+1,rng)};
+    }
+
+    template <typename T>
+    std::unique_ptr<T[]> make_data(mat::dim_t n, entropy e)
+    {
+        std::unique_ptr<T[]> data(new T[std::max<mat::dim_t>(n,1)]);
+        uint64_t rng = 0x9E3779B97F4A7C15ull;
+        for (mat::dim_t i = 0; i < n; ++i) data[i] = sample<T>(e,i,rng);
+        return data;
+    }
+
+    //----------------------------------- file benchmarks -----------------------------------//
+
+    const mat::file_version versions[] = {mat::V6, mat::V7};
+
+    const char *version_name(mat::file_version v)
+    {
+        return v == mat::V6 ? "V6" : "V7";
+    }
+
+    // Times writing a file of the given version, with the elements added by fill
+    void time_file(const settings &s, const std::string &suite, const std::string &name,
+        mat::file_version v, const std::string &param, mat::dim_t bytes, mat::dim_t ops,
+        const std::function<void(mat::container &)> &fill,
+        const mat::compress_options &zopts = {})
+    {
+        std::string path = s.dir + "/2mat_bench_" + suite + ".mat";
+        result r;
+        r.suite = suite;
+        r.name = name;
+        r.version = version_name(v);
+        r.param = param;
+        r.bytes = bytes;
+        r.ops = ops;
+        r.seconds = best_of(s.repeat, [&] {
+            if (v == mat::V6)
+            {
+                mat::file<mat::V6> f(path);
+                fill(f);
+                f.close().get();
+            } else {
+                mat::file<mat::V7> f(path);
+                f.compression(zopts);
+                fill(f);
+                f.close().get();
+            }
+        });
+        r.file_bytes = file_size(path);
+        std::remove(path.c_str());
+        report(r);
+    }
+
+    void bench_count(const settings &s)
+    {
+        // Many small (8 double) elements, to measure the cost per element
+        mat::dim_t top = s.quick ? 10000 : 1000000;
+        auto data = make_data<double>(8,SMOOTH);
+        for (mat::dim_t n = 1; n <= top; n *= 10)
+        {
+            std::vector<std::string> names(n);
+            for (mat::dim_t i = 0; i < n; ++i) names[i] = "v" + std::to_string(i);
+            for (auto v : versions)
+                time_file(s,"count","elements",v,std::to_string(n),n*8*sizeof(double),n,
+                    [&](mat::container &f) {
+                        for (auto &nm : names) f.add(nm,data.get(),8);
+                    });
+        }
+    }
+
+    void bench_size(const settings &s)
+    {
+        // One element of increasing size. Element sizes are 32-bit in the v5 format, so this
+        // stops at 1 GiB; elements too big to comfortably hold in memory are generated as they
+        // are written instead
+        mat::dim_t top = std::min<mat::dim_t>(s.quick ? 1ull << 20 : s.max_size, 1ull << 30);
+        const mat::dim_t in_memory = 256ull << 20;
+        for (mat::dim_t bytes = 8; bytes <= top; bytes *= 8)
+        {
+            mat::dim_t n = bytes/sizeof(double);
+            std::unique_ptr<double[]> data;
+            if (bytes <= in_memory) data = make_data<double>(n,SMOOTH);
+            for (auto v : versions)
+                time_file(s,"size",data ? "double" : "generated",v,std::to_string(bytes),bytes,1,
+                    [&](mat::container &f) {
+                        if (data)
+                        {
+                            f.add("x",data.get(),n);
+                            return;
+                        }
+                        f.add("x",mat::generate<double>(n,[](mat::dim_t first, mat::dim_t k,
+                                double *buf) {
+                            for (mat::dim_t i = 0; i < k; ++i) buf[i] = std::sin((first+i)*1e-3);
+                        }));
+                    });
+        }
+    }
+
+    mat::mstruct nest(unsigned int depth, const double *leaf, mat::dim_t n)
+    {
+        mat::mstruct st("s");
+        st.add("id",{(double)depth});
+        if (depth <= 1) st.add("x",leaf,n);
+        else st.add(nest(depth-1,leaf,n));
+        return st;
+    }
+
+    void bench_depth(const settings &s)
+    {
+        // 1 MiB of data at the bottom of a chain of nested structs
+        mat::dim_t n = (1ull << 20)/sizeof(double);
+        auto data = make_data<double>(n,SMOOTH);
+        unsigned int top = s.quick ? 4 : 16;
+        for (unsigned int depth = 0; depth <= top; depth = depth ? depth*2 : 1)
+        {
+            for (auto v : versions)
+                time_file(s,"depth","mstruct",v,std::to_string(depth),n*sizeof(double),1,
+                    [&](mat::container &f) {
+                        if (depth == 0) f.add("x",data.get(),n);
+                        else f.add(nest(depth,data.get(),n));
+                    });
+        }
+    }
+
+    template <typename T>
+    void bench_type(const settings &s, const std::string &name)
+    {
+        mat::dim_t bytes = s.quick ? 1ull << 20 : 8ull << 20;
+        mat::dim_t n = bytes/sizeof(T);
+        auto data = make_data<T>(n,SMOOTH);
+        for (auto v : versions)
+            time_file(s,"type",name,v,std::to_string(bytes),n*sizeof(T),1,
+                [&](mat::container &f) { f.add("x",data.get(),n); });
+    }
+
+    void bench_types(const settings &s)
+    {
+        bench_type<int8_t>(s,"int8");
+        bench_type<uint8_t>(s,"uint8");
+        bench_type<int16_t>(s,"int16");
+        bench_type<uint16_t>(s,"uint16");
+        bench_type<int32_t>(s,"int32");
+        bench_type<uint32_t>(s,"uint32");
+        bench_type<int64_t>(s,"int64");
+        bench_type<uint64_t>(s,"uint64");
+        bench_type<float>(s,"single");
+        bench_type<double>(s,"double");
+        bench_type<bool>(s,"logical");
+        bench_type<std::complex<double>>(s,"complex");
+
+        mat::dim_t bytes = s.quick ? 1ull << 20 : 8ull << 20;
+        std::string str(bytes,'a');
+        for (mat::dim_t i = 0; i < str.size(); ++i) str[i] = (char)('a'+i%26);
+        for (auto v : versions)
+            time_file(s,"type","char",v,std::to_string(bytes),str.size(),1,
+                [&](mat::container &f) { f.add("x",str); });
+    }
+
+    void bench_level(const settings &s)
+    {
+        mat::dim_t bytes = s.quick ? 1ull << 20 : 16ull << 20;
+        mat::dim_t n = bytes/sizeof(double);
+        auto data = make_data<double>(n,SMOOTH);
+        for (int level = 0; level <= 9; ++level)
+        {
+            mat::compress_options z;
+            z.level = level;
+            time_file(s,"level","double",mat::V7,std::to_string(level),bytes,1,
+                [&](mat::container &f) { f.add("x",data.get(),n); }, z);
+        }
+    }
+
+    void bench_entropy(const settings &s)
+    {
+        mat::dim_t bytes = s.quick ? 1ull << 20 : 16ull << 20;
+        mat::dim_t n = bytes/sizeof(double);
+        for (auto e : {ZEROS, SMOOTH, RANDOM})
+        {
+            auto data = make_data<double>(n,e);
+            for (auto v : versions)
+                time_file(s,"entropy","double",v,entropy_name(e),bytes,1,
+                    [&](mat::container &f) { f.add("x",data.get(),n); });
+        }
+    }
+
+    //---------------------------------- micro-benchmarks ----------------------------------//
+
+    // Times fn, which performs ops operations on bytes bytes of data
+    void time_op(const settings &s, const std::string &suite, const std::string &name,
+        const std::string &param, mat::dim_t bytes, mat::dim_t ops, const std::function<void()> &fn)
+    {
+        result r;
+        r.suite = suite;
+        r.name = name;
+        r.version = "-";
+        r.param = param;
+        r.bytes = bytes;
+        r.ops = ops;
+        r.seconds = best_of(s.repeat,fn);
+        report(r);
+    }
+
+    void bench_datenum(const settings &s)
+    {
+        mat::dim_t n = s.quick ? 1ull << 18 : 1ull << 22;
+        std::vector<double> in(n), out(n);
+        std::vector<long long> tt(n);
+        for (mat::dim_t i = 0; i < n; ++i)
+        {
+            in[i] = 1.6e9 + i*0.01;
+            tt[i] = 536500869184000000ll + (long long)i*1000000;
+        }
+        mat::dim_t bytes = n*sizeof(double);
+
+        auto scalar = [&](const std::string &name, double (*fn)(double)) {
+            time_op(s,"datenum",name,"scalar",bytes,n,[&] {
+                for (mat::dim_t i = 0; i < n; ++i) out[i] = fn(in[i]);
+                sink = out[n-1];
+            });
+        };
+        auto batch = [&](const std::string &name, void (*fn)(const double *, double *,
+                mat::dim_t)) {
+            time_op(s,"datenum",name,"batch",bytes,n,[&] {
+                fn(in.data(),out.data(),n);
+                sink = out[n-1];
+            });
+        };
+
+        scalar("unix2dn",mat::unix2dn);
+        batch("unix2dn",mat::unix2dn);
+        scalar("j19002dn",mat::j19002dn);
+        batch("j19002dn",mat::j19002dn);
+        scalar("j20002dn",mat::j20002dn);
+        batch("j20002dn",mat::j20002dn);
+        scalar("mjd2dn",mat::mjd2dn);
+        batch("mjd2dn",mat::mjd2dn);
+
+        time_op(s,"datenum","tt20002dn","scalar",bytes,n,[&] {
+            for (mat::dim_t i = 0; i < n; ++i) out[i] = mat::tt20002dn(tt[i]);
+            sink = out[n-1];
+        });
+        time_op(s,"datenum","tt20002dn","batch",bytes,n,[&] {
+            mat::tt20002dn(tt.data(),out.data(),n);
+            sink = out[n-1];
+        });
+
+        time_op(s,"datenum","datenum","calendar",n*6*sizeof(int),n,[&] {
+            double acc = 0;
+            for (mat::dim_t i = 0; i < n; ++i)
+                acc += mat::datenum(2000+(int)(i%50),1+(int)(i%12),1+(int)(i%28),12,30,(double)(i%60));
+            sink = acc;
+        });
+    }
+
+    void bench_fwriter(const settings &s)
+    {
+        // The cost of each call to fwriter::write, for the small writes made by the element
+        // headers as well as for bulk data
+        std::string path = s.dir + "/2mat_bench_fwriter.bin";
+        mat::dim_t n = s.quick ? 1ull << 20 : 1ull << 24;
+        std::vector<double> buf(1024, 1.0);
+
+        for (bool compressed : {false, true})
+        {
+            std::string param = compressed ? "zfilter" : "nofilter";
+            auto with_writer = [&](const std::function<void(mat::fwriter &)> &fn) {
+                return [&, fn] {
+                    mat::fwriter fw(path);
+                    if (compressed) fw.addfilter<mat::zfilter>();
+                    fn(fw);
+                    fw.close();
+                };
+            };
+            time_op(s,"fwriter","write<uint32_t>(val)",param,n*4,n,with_writer([&](mat::fwriter &fw) {
+                for (mat::dim_t i = 0; i < n; ++i) fw.write<uint32_t>((uint32_t)i);
+            }));
+            time_op(s,"fwriter","write<int32_t,uint32_t>(val)",param,n*4,n,
+                with_writer([&](mat::fwriter &fw) {
+                    for (mat::dim_t i = 0; i < n; ++i) fw.write<int32_t,uint32_t>((int32_t)i);
+                }));
+            time_op(s,"fwriter","write(ptr,1)",param,n*8,n,with_writer([&](mat::fwriter &fw) {
+                for (mat::dim_t i = 0; i < n; ++i) fw.write(buf.data(),1);
+            }));
+            time_op(s,"fwriter","write(ptr,1024)",param,n*8,n/1024,
+                with_writer([&](mat::fwriter &fw) {
+                    for (mat::dim_t i = 0; i < n/1024; ++i) fw.write(buf.data(),1024);
+                }));
+            time_op(s,"fwriter","write<double,float>(ptr,1024)",param,n*4,n/1024,
+                with_writer([&](mat::fwriter &fw) {
+                    for (mat::dim_t i = 0; i < n/1024; ++i) fw.write<double,float>(buf.data(),1024);
+                }));
+        }
+        std::remove(path.c_str());
+    }
+
+    void bench_contention(const settings &s)
+    {
+        // Several threads adding small elements to the same struct at once
+        mat::dim_t per = s.quick ? 2000 : 50000;
+        auto data = make_data<double>(8,SMOOTH);
+        for (unsigned int threads : {1u, 2u, 4u, 8u})
+        {
+            time_op(s,"contention","mstruct::add",std::to_string(threads),
+                threads*per*8*sizeof(double),threads*per,[&] {
+                    mat::mstruct st("s");
+                    std::vector<std::thread> pool;
+                    for (unsigned int t = 0; t < threads; ++t)
+                        pool.emplace_back([&, t] {
+                            std::string prefix = "t" + std::to_string(t) + "_";
+                            for (mat::dim_t i = 0; i < per; ++i)
+                                st.add(prefix + std::to_string(i),data.get(),8);
+                        });
+                    for (auto &th : pool) th.join();
+                });
+        }
+    }
+
+    void bench_scalars(const settings &s)
+    {
+        // A struct with a great many scalar fields, which is dominated by the cost of creating
+        // each element rather than of writing its data. The allocations per field are counted
+        // over building the struct alone
+        mat::dim_t n = s.quick ? 10000 : 1000000;
+        std::vector<std::string> names(n);
+        for (mat::dim_t i = 0; i < n; ++i) names[i] = "f" + std::to_string(i);
+
+        for (bool use_arena : {false, true})
+        {
+            result r;
+            r.suite = "scalars";
+            r.name = use_arena ? "mstruct::add (arena)" : "mstruct::add";
+            r.version = "-";
+            r.param = std::to_string(n);
+            r.bytes = n*sizeof(double);
+            r.ops = n;
+            uint64_t before = 0, after = 0;
+            r.seconds = best_of(s.repeat, [&] {
+                before = allocations();
+                mat::mstruct st("s");
+                if (use_arena) st.memory(std::make_shared<mat::arena>());
+                for (mat::dim_t i = 0; i < n; ++i) st.add(names[i],{(double)i});
+                after = allocations();
+            });
+            r.allocs = (double)(after-before)/n;
+            report(r);
+
+            for (auto v : versions)
+                time_file(s,"scalars",use_arena ? "mstruct (arena)" : "mstruct",v,std::to_string(n),
+                    n*sizeof(double),n,[&](mat::container &f) {
+                        mat::mstruct st("s");
+                        if (use_arena)
+                        {
+                            f.memory(std::make_shared<mat::arena>());
+                            st.memory(f.memory());
+                        }
+                        for (mat::dim_t i = 0; i < n; ++i) st.add(names[i],{(double)i});
+                        f.add(st);
+                    });
+        }
+    }
+
+    template <typename T>
+    void time_row_major(const settings &s, const std::string &type, mat::dim_t rows,
+        mat::dim_t cols)
+    {
+        // A row-major array written as it is, or transposed into a temporary first (as callers
+        // had to before matrices could be row-major)
+        mat::dim_t n = rows*cols;
+        auto data = make_data<T>(n,SMOOTH);
+        std::string param = std::to_string(rows) + "x" + std::to_string(cols);
+        std::vector<mat::dim_t> dims{rows,cols};
+        time_file(s,"rowmajor",type + " (transposed copy)",mat::V6,param,n*sizeof(T),1,
+            [&](mat::container &f) {
+                std::unique_ptr<T[]> tmp(new T[n]);
+                for (mat::dim_t i = 0; i < rows; ++i)
+                    for (mat::dim_t j = 0; j < cols; ++j)
+                        tmp[j*rows+i] = data[i*cols+j];
+                f.add("x",tmp.get(),n,dims);
+            });
+        time_file(s,"rowmajor",type + " (row_major)",mat::V6,param,n*sizeof(T),1,
+            [&](mat::container &f) {
+                f.add("x",data.get(),n,dims,mat::row_major);
+            });
+    }
+
+    void bench_rowmajor(const settings &s)
+    {
+        if (s.quick)
+        {
+            time_row_major<double>(s,"double",512,512);
+            time_row_major<uint8_t>(s,"uint8",480,640);
+            return;
+        }
+        time_row_major<double>(s,"double",4096,4096);
+        time_row_major<float>(s,"single",4096,4096);
+        time_row_major<uint8_t>(s,"uint8",4000,6000);
+    }
+
+    void bench_labels(const settings &s)
+    {
+        // Many short strings, written as one char matrix or as a matrix each
+        mat::dim_t top = s.quick ? 10000 : 1000000;
+        for (mat::dim_t n = 100; n <= top; n *= 100)
+        {
+            std::vector<std::string> labels(n), names(n);
+            mat::dim_t bytes = 0;
+            for (mat::dim_t i = 0; i < n; ++i)
+            {
+                labels[i] = "sample_" + std::to_string(i*7919 % n) + (i % 3 ? "_left" : "_right");
+                names[i] = "s" + std::to_string(i);
+                bytes += labels[i].size();
+            }
+            std::string param = std::to_string(n);
+            time_file(s,"labels","a matrix each",mat::V6,param,bytes,n,
+                [&](mat::container &f) {
+                    for (mat::dim_t i = 0; i < n; ++i) f.add(names[i],labels[i]);
+                });
+            time_file(s,"labels","char matrix",mat::V6,param,bytes,n,
+                [&](mat::container &f) {
+                    f.add("labels",labels);
+                });
+        }
+    }
+
+    void bench_half(const settings &s)
+    {
+        // Half-precision tensors widened to singles up front (as callers had to before
+        // halfsource), or as they are written
+        mat::dim_t n = s.quick ? (1 << 20) : (64 << 20);
+        auto data = make_data<uint16_t>(n,SMOOTH);
+        std::string param = std::to_string(n);
+        time_file(s,"half","float copy",mat::V6,param,n*sizeof(float),1,
+            [&](mat::container &f) {
+                std::vector<float> tmp(n);
+                for (mat::dim_t i = 0; i < n; ++i)
+                {
+                    uint32_t bits = (uint32_t)data[i] << 16;
+                    std::memcpy(&tmp[i],&bits,sizeof(float));
+                }
+                f.add("x",tmp.data(),n);
+            });
+        time_file(s,"half","halfsource",mat::V6,param,n*sizeof(float),1,
+            [&](mat::container &f) {
+                f.add_half("x",mat::BFLOAT16,data.get(),n);
+            });
+    }
+
+    void bench_estimate(const settings &s)
+    {
+        // Predicting the size of a V7 file, against writing it; the predicted size is given as
+        // file_bytes. The prediction should take the same time at every size.
+        std::vector<mat::dim_t> sizes = {1ull << 20, 16ull << 20};
+        if (!s.quick) sizes.push_back(std::min<mat::dim_t>(s.max_size, 1ull << 30));
+        std::string path = s.dir + "/2mat_bench_estimate.mat";
+        for (auto bytes : sizes)
+        {
+            mat::dim_t n = bytes/sizeof(double);
+            for (auto e : {ZEROS, SMOOTH, RANDOM})
+            {
+                auto data = make_data<double>(n,e);
+                std::string param = std::string(entropy_name(e)) + " " + std::to_string(bytes);
+                result r;
+                r.suite = "estimate";
+                r.name = "estimate";
+                r.version = version_name(mat::V7);
+                r.param = param;
+                r.bytes = bytes;
+                r.ops = 1;
+                {
+                    mat::file<mat::V7> f(path);
+                    f.add("x",data.get(),n);
+                    r.seconds = best_of(s.repeat, [&] { r.file_bytes = f.estimate().bytes; });
+                }
+                std::remove(path.c_str());
+                report(r);
+                time_file(s,"estimate","write",mat::V7,param,bytes,1,
+                    [&](mat::container &f) { f.add("x",data.get(),n); });
+            }
+        }
+    }
+
+    //--------------------------------------- output ---------------------------------------//
+
+    double mbps(const result &r)
+    {
+        return r.seconds > 0 ? r.bytes/r.seconds/1e6 : 0;
+    }
+
+    double ns_per_op(const result &r)
+    {
+        return r.ops ? r.seconds*1e9/r.ops : 0;
+    }
+
+    std::string json_string(const std::string &str)
+    {
+        std::string out = "\"";
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    void write_results(const settings &s, std::ostream &out)
+    {
+        out.precision(6);
+        if (s.format == "json")
+        {
+            out << "[\n";
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                auto &r = results[i];
+                out << "  {\"suite\": " << json_string(r.suite)
+                    << ", \"name\": " << json_string(r.name)
+                    << ", \"version\": " << json_string(r.version)
+                    << ", \"param\": " << json_string(r.param)
+                    << ", \"bytes\": " << r.bytes
+                    << ", \"file_bytes\": " << r.file_bytes
+                    << ", \"ops\": " << r.ops
+                    << ", \"wall_s\": " << r.seconds
+                    << ", \"mb_per_s\": " << mbps(r)
+                    << ", \"ns_per_op\": " << ns_per_op(r)
+                    << ", \"allocs_per_op\": " << r.allocs << "}"
+                    << (i+1 < results.size() ? ",\n" : "\n");
+            }
+            out << "]\n";
+            return;
+        }
+        out << "suite,name,version,param,bytes,file_bytes,ops,wall_s,mb_per_s,ns_per_op,allocs_per_op\n";
+        for (auto &r : results)
+        {
+            out << r.suite << ",\"" << r.name << "\"," << r.version << "," << r.param << ","
+                << r.bytes << "," << r.file_bytes << "," << r.ops << "," << r.seconds << ","
+                << mbps(r) << "," << ns_per_op(r) << "," << r.allocs << "\n";
+        }
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: 2mat_bench [--suite a,b,...] [--format csv|json] [--out path] "
+            "[--dir path] [--repeat n] [--max-size bytes] [--quick]\n"
+            "suites: count, size, depth, type, level, entropy, datenum, fwriter, contention, scalars, "
+            "rowmajor, labels, half, estimate\n";
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    settings s;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i+1 < argc;
+        if (arg == "--quick")
+        {
+            s.quick = true;
+            s.repeat = 1;
+        } else if (arg == "--suite" && has_value) {
+            std::stringstream ss(argv[++i]);
+            std::string name;
+            while (std::getline(ss,name,',')) s.suites.push_back(name);
+        } else if (arg == "--format" && has_value) {
+            s.format = argv[++i];
+        } else if (arg == "--out" && has_value) {
+            s.out = argv[++i];
+        } else if (arg == "--dir" && has_value) {
+            s.dir = argv[++i];
+        } else if (arg == "--repeat" && has_value) {
+            s.repeat = (unsigned int)std::strtoul(argv[++i],nullptr,10);
+        } else if (arg == "--max-size" && has_value) {
+            s.max_size = std::strtoull(argv[++i],nullptr,10);
+        } else {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (s.format != "csv" && s.format != "json")
+    {
+        usage();
+        return 1;
+    }
+
+    try
+    {
+        if (s.run("count")) bench_count(s);
+        if (s.run("size")) bench_size(s);
+        if (s.run("depth")) bench_depth(s);
+        if (s.run("type")) bench_types(s);
+        if (s.run("level")) bench_level(s);
+        if (s.run("entropy")) bench_entropy(s);
+        if (s.run("datenum")) bench_datenum(s);
+        if (s.run("fwriter")) bench_fwriter(s);
+        if (s.run("contention")) bench_contention(s);
+        if (s.run("scalars")) bench_scalars(s);
+        if (s.run("rowmajor")) bench_rowmajor(s);
+        if (s.run("labels")) bench_labels(s);
+        if (s.run("half")) bench_half(s);
+        if (s.run("estimate")) bench_estimate(s);
+    } catch (std::exception &e) {
+        std::cerr << "2mat_bench: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (s.out.empty())
+    {
+        write_results(s,std::cout);
+    } else {
+        std::ofstream out(s.out);
+        write_results(s,out);
+    }
+    return 0;
+}
@@ -10,7 +10,11 @@
 #include "datenum.hpp"
 #include "element.hpp"
 #include "file.hpp"
+#include "generator.hpp"
+#include "half.hpp"
 #include "matrix.hpp"
 #include "mstruct.hpp"
+#include "rolling.hpp"
+#include "view.hpp"
 
 #endif //INC_2MAT_2MAT_HPP
@@ -0,0 +1,148 @@
+/*
+ * 2mat/append_list.hpp -- lock-free list supporting concurrent appends
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_APPEND_LIST_H
+#define TOO_MAT_APPEND_LIST_H
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace mat
+{
+
+    /*
+     *  mat::append_list
+     * 
+     * A list that any number of threads can append to at once without locking. Each append
+     * claims the next index with a single atomic increment, so items keep the order in which
+     * their appends started, and stores the item in a segment of storage that is never moved.
+     * Segments double in size, so a list of n items has O(log n) segments.
+     * 
+     * Only push_back() is thread-safe. Reading, copying or clearing the list must not overlap
+     * with appends -- for instance, producer threads must have been joined before the list is
+     * iterated.
+     * 
+     * TEMPLATE
+     *  T   The type of the items, which must be default-constructible and move-assignable
+     * 
+     */
+    template <typename T>
+    class append_list
+    {
+        static const unsigned int FIRST = 6;                   // the first segment holds 2^6 items
+        static const unsigned int SEGMENTS = 64 - FIRST;
+
+        std::atomic<T *> _segments[SEGMENTS] = {};
+        std::atomic<dim_t> _size{0};
+
+        // The segment holding item i, and the index of item i within it
+        static unsigned int segment(dim_t i, dim_t &offset)
+        {
+            dim_t k = i + (1ull << FIRST);
+            unsigned int s = 63 - __builtin_clzll(k);
+            offset = k - (1ull << s);
+            return s - FIRST;
+        }
+
+        T *storage(unsigned int s)
+        {
+            T *seg = _segments[s].load(std::memory_order_acquire);
+            if (seg) return seg;
+            // Whichever thread gets there first installs its segment; the others throw theirs away
+            T *fresh = new T[1ull << (s + FIRST)];
+            if (_segments[s].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel))
+                return fresh;
+            delete[] fresh;
+            return seg;
+        }
+
+    public:
+        class iterator
+        {
+            const append_list *_list;
+            dim_t _i;
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef T *pointer;
+            typedef T &reference;
+
+            iterator(const append_list *list, dim_t i) : _list(list), _i(i) {}
+            T &operator*() const { return (*_list)[_i]; }
+            T *operator->() const { return &(*_list)[_i]; }
+            iterator &operator++() { ++_i; return *this; }
+            iterator operator++(int) { iterator it = *this; ++_i; return it; }
+            bool operator==(const iterator &o) const { return _i == o._i; }
+            bool operator!=(const iterator &o) const { return _i != o._i; }
+        };
+
+        append_list() = default;
+        append_list(const append_list &other) : append_list() { for (auto &x : other) push_back(x); }
+        append_list &operator=(const append_list &other)
+        {
+            if (this == &other) return *this;
+            clear();
+            for (auto &x : other) push_back(x);
+            return *this;
+        }
+        ~append_list() { clear(); }
+
+        /*
+         * void mat::append_list::push_back(T)
+         * 
+         * Appends an item to the list. Safe to call from any number of threads at once.
+         * 
+         * INPUT:
+         *  item (T) the item to append
+         */
+        void push_back(T item)
+        {
+            dim_t offset;
+            unsigned int s = segment(_size.fetch_add(1, std::memory_order_relaxed), offset);
+            storage(s)[offset] = std::move(item);
+        }
+
+        T &operator[](dim_t i) const
+        {
+            dim_t offset;
+            unsigned int s = segment(i, offset);
+            return _segments[s].load(std::memory_order_acquire)[offset];
+        }
+
+        [[nodiscard]] dim_t size() const { return _size.load(std::memory_order_acquire); }
+        [[nodiscard]] bool empty() const { return size() == 0; }
+
+        void clear()
+        {
+            for (auto &seg : _segments) delete[] seg.exchange(nullptr);
+            _size = 0;
+        }
+
+        iterator begin() const { return iterator(this, 0); }
+        iterator end() const { return iterator(this, size()); }
+    };
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * 2mat/arena.hpp -- monotonic memory arena for element trees
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_ARENA_H
+#define TOO_MAT_ARENA_H
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+
+// The size of the first block an arena allocates; later blocks grow geometrically
+#ifndef MAT_ARENA_BLOCK
+#define MAT_ARENA_BLOCK (1 << 20)
+#endif
+
+namespace mat
+{
+
+    /*
+     *  mat::arena
+     *
+     * A memory resource that hands out memory from large blocks, one after the other, and only
+     * frees it when the arena itself is destroyed. A container given an arena (see
+     * container::memory()) constructs its children in it, along with their dimensions and any
+     * data too large to store inline, so that the nodes of a tree lie next to each other in the
+     * order they were added and the writer walks through memory in order. Deallocation does
+     * nothing; the blocks are all released together once the last element using them is gone.
+     *
+     * Elements hold a reference to the arena they were allocated from, so an arena can safely be
+     * dropped by its owner while elements from it are still in use. Allocation is thread-safe,
+     * and only takes a lock when a new block is needed.
+     *
+     */
+    class arena : public std::pmr::memory_resource, public std::enable_shared_from_this<arena>
+    {
+        struct block
+        {
+            block *prev;
+            dim_t capacity;
+            std::atomic<dim_t> used{0};
+
+            [[nodiscard]] unsigned char *data() { return reinterpret_cast<unsigned char *>(this+1); }
+        };
+
+        std::atomic<block *> _head{nullptr};
+        std::mutex _grow;
+        dim_t _next;
+
+        // Adds a block of at least min bytes, unless another thread has replaced full already
+        void grow(block *full, dim_t min);
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *, std::size_t, std::size_t) override {}
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    public:
+        /*
+         * mat::arena::arena(dim_t)
+         *
+         * Constructs an empty arena. No memory is allocated until it is first used.
+         *
+         * INPUT:
+         *  block (dim_t) the size of the first block to allocate, in bytes
+         */
+        explicit arena(dim_t block = MAT_ARENA_BLOCK);
+        ~arena() override;
+        arena(const arena &) = delete;
+        arena &operator=(const arena &) = delete;
+
+        /*
+         * dim_t mat::arena::allocated()
+         *
+         * Returns the number of bytes of its blocks the arena has handed out so far, including
+         * any padding for alignment.
+         */
+        [[nodiscard]] dim_t allocated();
+
+        /*
+         * mat::arena *mat::arena::current()
+         *
+         * Returns the arena elements are currently being constructed in on this thread, or NULL
+         * if they are being allocated normally. This is set by a mat::arena::scope.
+         */
+        [[nodiscard]] static arena *current();
+
+        /*
+         * std::pmr::memory_resource *mat::arena::resource()
+         *
+         * Returns the current arena as a memory resource, or the default resource if there is no
+         * current arena.
+         */
+        [[nodiscard]] static std::pmr::memory_resource *resource();
+
+        /*
+         *  mat::arena::scope
+         *
+         * Makes an arena the current arena of this thread for as long as the scope exists. Scopes
+         * may be nested, and passing NULL allocates normally within the scope. The arena must be
+         * owned by a shared_ptr, as what is allocated from it holds a reference to it; the scope
+         * holds one too.
+         */
+        class scope
+        {
+            std::shared_ptr<arena> _arena;
+            arena *_prev;
+
+        public:
+            explicit scope(std::shared_ptr<arena> a);
+            ~scope();
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+        };
+    };
+
+    /*
+     *  mat::arena_allocator
+     *
+     * An allocator drawing from an arena, for use with std::allocate_shared. It holds a reference
+     * to the arena, so that the arena outlives everything allocated from it.
+     *
+     */
+    template <typename T>
+    struct arena_allocator
+    {
+        typedef T value_type;
+
+        std::shared_ptr<arena> mem;
+
+        explicit arena_allocator(std::shared_ptr<arena> a) : mem(std::move(a)) {}
+
+        template <typename U>
+        arena_allocator(const arena_allocator<U> &other) : mem(other.mem) {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T *>(mem->allocate(n*sizeof(T),alignof(T)));
+        }
+
+        void deallocate(T *p, std::size_t n)
+        {
+            mem->deallocate(p,n*sizeof(T),alignof(T));
+        }
+
+        template <typename U>
+        bool operator==(const arena_allocator<U> &other) const { return mem == other.mem; }
+
+        template <typename U>
+        bool operator!=(const arena_allocator<U> &other) const { return mem != other.mem; }
+    };
+
+}
+
+#endif
@@ -20,8 +20,12 @@
 #ifndef TOO_MAT_CONTAINER_H
 #define TOO_MAT_CONTAINER_H
 
+#include "append_list.hpp"
+#include "arena.hpp"
 #include "element.hpp"
+#include "half.hpp"
 #include "matrix.hpp"
+#include "date/timesource.hpp"
 
 #include <vector>
 #include <string>
@@ -34,7 +38,41 @@ namespace mat
     class container : public element
     {
     protected:
-        std::vector<std::shared_ptr<element>> _children;
+        // Children may be added from several threads at once (see mat::append_list), but not
+        // while the container is being written
+        append_list<std::shared_ptr<element>> _children;
+        // If set, new children are constructed in this arena rather than on the heap
+        std::shared_ptr<arena> _arena;
+
+        /*
+         * void mat::container::append(std::shared_ptr<element>)
+         * 
+         * Stores a newly constructed child element. Every add() method ends here, so derived
+         * classes can override this to change what happens to new children. This is called by
+         * add() after the element has been constructed, and must be safe to call from several
+         * threads at once.
+         * 
+         * INPUT:
+         *  child (std::shared_ptr<element>) the element to add
+         */
+        virtual void append(std::shared_ptr<element> child);
+
+        /*
+         * mat::container::emplace(Args &&...)
+         * 
+         * Constructs a new child of type T in place from the passed arguments and appends it. The
+         * element and its reference count share a single allocation, and no temporary copy is
+         * made, so the add() helpers that build a matrix use this rather than add(const T &). If
+         * this container has an arena, the element and its dimensions and data are allocated
+         * from it.
+         * 
+         * TEMPLATE:
+         *  T   the type of the element to construct
+         * INPUT:
+         *  args (Args &&...) the arguments to pass to the constructor of T
+         */
+        template <typename T, typename... Args>
+        container &emplace(Args &&...args);
     public:
         /*
          * mat::container::container(const std::string &)
@@ -49,10 +87,34 @@ namespace mat
         explicit container(const std::string &name);
         ~container() override = 0;
 
+        /*
+         * mat::container::memory(std::shared_ptr<arena>)
+         * 
+         * Constructs the elements added to this container from now on in the given arena (or on
+         * the heap, if NULL). Giving a file and the structs built for it the same arena puts the
+         * whole tree in a few large blocks, laid out in the order it was built, which are freed
+         * together once the file and its elements are gone. This must not be called while
+         * elements are being added.
+         * 
+         * INPUT:
+         *  mem (std::shared_ptr<arena>) the arena to allocate from
+         */
+        container &memory(std::shared_ptr<arena> mem);
+
+        /*
+         * std::shared_ptr<arena> mat::container::memory() const
+         * 
+         * Returns the arena new elements are constructed in, or NULL if they are allocated on
+         * the heap.
+         */
+        [[nodiscard]] std::shared_ptr<arena> memory() const;
+
         /*
          * mat::container::add(const T &)
          * 
          * Adds the passed object (which must be a derived type of element) to this container.
+         * Like every add() method, this may be called from several threads at once; the new
+         * element is copied on the calling thread, and only then appended (without locking).
          * 
          * TEMPLATE:
          *  T   the type of the object to add, which must be a derived type of element
@@ -77,10 +139,12 @@ namespace mat
          *  start (NT) the pointer to the start of the range to add
          *  end (NT) the pointer to the end of the range to add
          *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         *  order (array_order) the layout of the data; row-major data is reordered as it is
+         *      written (see mat::matrix)
          */
         template <typename NT, typename dimtype=dim_t>
 		container &add(const std::string &name, NT start, NT end,
-            const std::vector<dimtype> &dims = {});
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
 
         /*
          * mat::container::add(const std::string &, T *, dim_t, const std::vector<dim_t>)
@@ -95,14 +159,30 @@ namespace mat
          *  data (NT) the pointer to the start of the data to add
          *  numel (NT) the number of elements to add from the pass array
          *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         *  order (array_order) the layout of the data, as above
          */
         template <typename T, typename dimtype=dim_t>
 		container &add(const std::string &name, T *data, dim_t numel, 
-            const std::vector<dimtype> &dims = {});
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
 
         template <typename T, typename dimtype=dim_t>
 		container &add(const std::string &name, std::initializer_list<T> data,
-            const std::vector<dimtype> &dims = {});
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
+
+        /*
+         * mat::container::add(const std::string &, const view<T> &)
+         * 
+         * Creates a matrix with the specified name from a view of an array (for instance, one
+         * converted from a std::mdspan) and adds it to this container. Nothing is copied: the
+         * values are gathered from the array as the matrix is written, so the array must outlive
+         * the container.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  v (const view<T> &) the view of the data
+         */
+        template <typename T>
+        container &add(const std::string &name, const view<T> &v);
 
         /*
          * mat::container::add(const std::string &, T *, dim_t, const std::vector<dim_t>)
@@ -140,6 +220,129 @@ namespace mat
          */
         virtual container &add(const std::string &name, const std::u32string &str);
 
+        /*
+         * mat::container::add(const std::string &, const std::vector<std::string> &)
+         * 
+         * Creates a char matrix with the specified name, with a row for each of the passed
+         * strings (see mat::matrix), and adds it to this container.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  strs (const std::vector<std::string> &) the rows of the matrix
+         */
+        virtual container &add(const std::string &name, const std::vector<std::string> &strs);
+
+        /*
+         * mat::container::add(const std::string &, const std::vector<bool> &, const std::vector<dim_t> &)
+         * 
+         * Creates a logical matrix with the specified name from the passed vector and adds it to
+         * this container. If dims is not specified, the matrix will be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  mask (const std::vector<bool> &) the values of the matrix
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        virtual container &add(const std::string &name, const std::vector<bool> &mask,
+            const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::container::add(const std::string &, const bitmask &, const std::vector<dim_t> &)
+         * 
+         * Creates a logical matrix with the specified name from the passed bit-packed mask and
+         * adds it to this container. If dims is not specified, the matrix will be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  mask (const bitmask &) the packed values of the matrix
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        virtual container &add(const std::string &name, const bitmask &mask,
+            const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::container::add(const std::string &, std::shared_ptr<source>, const std::vector<dim_t> &)
+         * 
+         * Creates a matrix with the specified name whose data is produced by the passed source as
+         * it is written, and adds it to this container. If dims is not specified, the matrix will
+         * be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  src (std::shared_ptr<source>) the source of the data
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        virtual container &add(const std::string &name, std::shared_ptr<source> src,
+            const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::container::add(const std::string &, const std::vector<time_point> &, const std::vector<dim_t> &)
+         * 
+         * Creates a matrix of MATLAB datenums from the passed time points and adds it to this
+         * container. The time points are converted as the matrix is written, and are NOT copied,
+         * so the vector must outlive the write. If dims is not specified, the matrix will be a 1D
+         * row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  t (const std::vector<std::chrono::system_clock::time_point> &) the time points
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        virtual container &add(const std::string &name,
+            const std::vector<std::chrono::system_clock::time_point> &t,
+            const std::vector<dim_t> &dims = {});
+        container &add(const std::string &name,
+            std::vector<std::chrono::system_clock::time_point> &&t,
+            const std::vector<dim_t> &dims = {}) = delete;
+
+        /*
+         * mat::container::add_time(const std::string &, time_epoch, const double *, dim_t, const std::vector<dim_t> &)
+         * 
+         * Creates a matrix of MATLAB datenums from the passed timestamps and adds it to this
+         * container. The timestamps are converted as the matrix is written, and are NOT copied,
+         * so they must outlive the write. If dims is not specified, the matrix will be a 1D row
+         * vector. The epoch comes before the data, so that an empty dims ({}) can't be taken for
+         * it.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  epoch (time_epoch) the kind of timestamp (UNIX seconds, J1900, J2000 or MJD days)
+         *  t (const double *) the timestamps
+         *  numel (dim_t) the number of timestamps
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        virtual container &add_time(const std::string &name, time_epoch epoch, const double *t,
+            dim_t numel, const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::container::add_time(const std::string &, time_epoch, const long long *, dim_t, const std::vector<dim_t> &)
+         * 
+         * As above, for integer timestamps (UNIX or TT2000 nanoseconds). Both long long and long
+         * are taken, so that int64_t data can be passed whichever of them it is defined as.
+         */
+        virtual container &add_time(const std::string &name, time_epoch epoch,
+            const long long *t, dim_t numel, const std::vector<dim_t> &dims = {});
+        virtual container &add_time(const std::string &name, time_epoch epoch, const long *t,
+            dim_t numel, const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::container::add_half(const std::string &, half_format, const uint16_t *, dim_t, const std::vector<dim_t> &)
+         * 
+         * Creates a single precision matrix from the passed 16-bit floating point values (see
+         * mat::halfsource) and adds it to this container. The values are widened as the matrix is
+         * written, and are NOT copied, so they must outlive the write. If dims is not specified,
+         * the matrix will be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new matrix
+         *  format (half_format) the format of the values (FLOAT16 or BFLOAT16)
+         *  data (const uint16_t *) the bits of the values
+         *  numel (dim_t) the number of values
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        virtual container &add_half(const std::string &name, half_format format,
+            const uint16_t *data, dim_t numel, const std::vector<dim_t> &dims = {});
+
         [[nodiscard]] dim_t size(bool with_name) const override = 0;
 
         void write(fwriter& fw, file_version v, bool write_name) override = 0;
@@ -147,35 +350,57 @@ namespace mat
 
     inline container::~container() = default;
 
+    template <typename T, typename... Args>
+    container &container::emplace(Args &&...args)
+    {
+        std::shared_ptr<element> child;
+        if (_arena)
+        {
+            arena::scope scope(_arena);
+            child = std::allocate_shared<T>(arena_allocator<T>(_arena),std::forward<Args>(args)...);
+        } else {
+            child = std::make_shared<T>(std::forward<Args>(args)...);
+        }
+        append(std::move(child));
+        return *this;
+    }
+
     template <typename T>
     container &container::add(const T &child)
     {
-        _children.push_back(std::shared_ptr<element>(new T(child)));
-        return *this;
+        MAT_TRACE_SPAN("container::add");
+        return emplace<T>(child);
     }
 
     template <typename NT, typename dimtype>
     container &container::add(const std::string &name, NT start, NT end, 
-            const std::vector<dimtype> &dims)
+            const std::vector<dimtype> &dims, array_order order)
     {
-        add(matrix(name,start,end,dims));
-        return *this;
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,start,end,dims,order);
     }
 
     template <typename T, typename dimtype>
     container &container::add(const std::string &name, T *data, dim_t numel, 
-            const std::vector<dimtype> &dims)
+            const std::vector<dimtype> &dims, array_order order)
     {
-        add(matrix(name,data,numel,dims));
-        return *this;
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,data,numel,dims,order);
     }
 
     template <typename T, typename dimtype>
     container &container::add(const std::string &name, std::initializer_list<T> data, 
-        const std::vector<dimtype> &dims)
+        const std::vector<dimtype> &dims, array_order order)
     {
-        add(matrix(name,data,dims));
-        return *this;
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,data,dims,order);
+    }
+
+    template <typename T>
+    container &container::add(const std::string &name, const view<T> &v)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,v);
     }
 
 }
@@ -1,5 +1,5 @@
 /*
- * 2mat/date/leap.hpp -- list of leap seconds, for converting from tt2000 to MATLAB datenum
+ * 2mat/date/leap.hpp -- table of leap seconds, for converting from tt2000 to MATLAB datenum
  * 
  * Version: 1.0
  * Date created: 2021 March 17
@@ -17,9 +17,140 @@
  * If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifndef TOO_MAT_DATE_LEAP_H
+#define TOO_MAT_DATE_LEAP_H
+
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace mat
 {
 
-    extern const double LEAP_JD[27];
+    /*
+     * mat::leap_interval
+     * 
+     * A period of constant TAI-UTC. start is the first CDF TT2000 timestamp (in nanoseconds) of the
+     * period, and offset is TT-UTC during it (TAI-UTC plus 32.184 s), also in nanoseconds. The
+     * period ends at the start of the next interval in the table.
+     */
+    struct leap_interval
+    {
+        long long start;
+        long long offset;
+    };
+
+    /*
+     * mat::leap_table
+     * 
+     * A table of leap seconds, stored as the intervals between them and keyed on TT2000 time, so
+     * that the UTC offset of a timestamp can be found with a binary search.
+     */
+    class leap_table
+    {
+        std::vector<leap_interval> _intervals;
+    public:
+        /*
+         * mat::leap_table::leap_table(std::vector<std::pair<long long,int>>)
+         * 
+         * Constructs a leap second table from a list of changes to TAI-UTC.
+         * 
+         * INPUT:
+         *  changes (std::vector<std::pair<long long,int>>) the modified julian day on which each
+         *      new value of TAI-UTC takes effect (at 00:00 UTC), and that value, in seconds
+         */
+        explicit leap_table(std::vector<std::pair<long long,int>> changes);
+
+        /*
+         * size_t mat::leap_table::find(long long tt) const
+         * 
+         * Returns the index of the interval containing the passed TT2000 timestamp. Timestamps
+         * before the first entry in the table belong to the first interval.
+         */
+        [[nodiscard]] size_t find(long long tt) const;
+
+        [[nodiscard]] const leap_interval &operator[](size_t i) const { return _intervals[i]; }
+        [[nodiscard]] size_t size() const { return _intervals.size(); }
+
+        /*
+         * long long mat::leap_table::end(size_t i) const
+         * 
+         * Returns the first TT2000 timestamp after the end of the i-th interval.
+         */
+        [[nodiscard]] long long end(size_t i) const;
+    };
+
+    /*
+     * mat::leap_cursor
+     * 
+     * Looks up UTC offsets in a leap second table, remembering the interval of the last lookup.
+     * For sorted (or nearly sorted) timestamps, almost every lookup is answered by that interval,
+     * without searching the table. A cursor is not thread-safe -- each thread needs its own.
+     */
+    class leap_cursor
+    {
+        const leap_table &_table;
+        size_t _i = 0;
+        long long _start = 0, _end = 0;
+    public:
+        explicit leap_cursor(const leap_table &table);
+
+        /*
+         * const leap_interval &mat::leap_cursor::operator()(long long tt)
+         * 
+         * Returns the interval containing the passed TT2000 timestamp.
+         */
+        const leap_interval &operator()(long long tt)
+        {
+            if (tt < _start || tt >= _end)
+            {
+                _i = _table.find(tt);
+                _start = _i ? _table[_i].start : std::numeric_limits<long long>::min();
+                _end = _table.end(_i);
+            }
+            return _table[_i];
+        }
+
+        // The bounds of the current interval, so that runs of timestamps can be checked in bulk
+        [[nodiscard]] long long start() const { return _start; }
+        [[nodiscard]] long long end() const { return _end; }
+    };
+
+    /*
+     * const leap_table &mat::leap_seconds()
+     * 
+     * Returns the leap second table currently used for TT2000 conversions. This is the table
+     * built into the library, unless it has been replaced by one of the functions below. Tables
+     * that are replaced are never freed, so the returned reference remains valid.
+     */
+    const leap_table &leap_seconds();
+
+    /*
+     * void mat::leap_seconds(std::vector<std::pair<long long,int>> changes)
+     * 
+     * Replaces the leap second table used for TT2000 conversions. This is safe to call while
+     * other threads are converting, but conversions already in progress may use the old table.
+     * 
+     * INPUT:
+     *  changes (std::vector<std::pair<long long,int>>) the modified julian day on which each
+     *      new value of TAI-UTC takes effect, and that value, in seconds
+     */
+    void leap_seconds(std::vector<std::pair<long long,int>> changes);
+
+    /*
+     * void mat::load_leap_seconds(const std::string &path)
+     * 
+     * Replaces the leap second table used for TT2000 conversions with the contents of a leap
+     * second file. The IERS Leap_Second.dat, CDF CDFLeapSeconds.txt and IETF leap-seconds.list
+     * formats are understood. Entries before 1972 (when TAI-UTC was not a whole number of
+     * seconds) are ignored.
+     * 
+     * INPUT:
+     *  path (const std::string &) the path of the file to load
+     */
+    void load_leap_seconds(const std::string &path);
+
+}
 
-}
\ No newline at end of file
+#endif
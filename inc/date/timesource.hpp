@@ -0,0 +1,110 @@
+/*
+ * 2mat/date/timesource.hpp -- source converting arrays of timestamps to MATLAB datenums
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_DATE_TIMESOURCE_H
+#define TOO_MAT_DATE_TIMESOURCE_H
+
+#include "../source.hpp"
+
+#include <chrono>
+
+namespace mat
+{
+
+    /*
+     * mat::time_epoch
+     * 
+     * enumerated list of the kinds of timestamp that can be converted to MATLAB datenums
+     * 
+     */
+    enum time_epoch
+    {
+        UNIX,       // seconds (double) or nanoseconds (integer) since 1970-01-01 00:00:00 UTC
+        J1900,      // julian days (double) in the J1900 epoch
+        J2000,      // julian days (double) in the J2000 epoch
+        MJD,        // modified julian days (double)
+        TT2000      // CDF TT2000 nanoseconds (integer)
+    };
+
+    /*
+     *  mat::timesource
+     * 
+     * A source that converts an array of timestamps to MATLAB datenums as the matrix holding it
+     * is written, so that the array of datenums never exists in full. The timestamps are NOT
+     * copied: they must remain valid (and unchanged) until the matrix has been written.
+     * 
+     */
+    class timesource : public source
+    {
+        enum input { DOUBLE, INT64, LONG, CLOCK };
+
+        const void *_data;
+        dim_t _numel;
+        time_epoch _epoch;
+        input _input;
+    public:
+        /*
+         * mat::timesource::timesource(const double *, dim_t, time_epoch)
+         * 
+         * Constructs a source from an array of fractional timestamps. The epoch may be UNIX
+         * (seconds), J1900, J2000 or MJD (days).
+         * 
+         * INPUT:
+         *  t (const double *) the timestamps to convert
+         *  numel (dim_t) the number of timestamps
+         *  epoch (time_epoch) the kind of the timestamps
+         */
+        timesource(const double *t, dim_t numel, time_epoch epoch);
+
+        /*
+         * mat::timesource::timesource(const long long *, dim_t, time_epoch)
+         * 
+         * Constructs a source from an array of integer timestamps. The epoch may be UNIX or
+         * TT2000 (both in nanoseconds).
+         * 
+         * INPUT:
+         *  t (const long long *) the timestamps to convert
+         *  numel (dim_t) the number of timestamps
+         *  epoch (time_epoch) the kind of the timestamps
+         */
+        timesource(const long long *t, dim_t numel, time_epoch epoch);
+        // As above, for arrays of long, which is how int64_t is defined on LP64 platforms
+        timesource(const long *t, dim_t numel, time_epoch epoch);
+
+        /*
+         * mat::timesource::timesource(const std::chrono::system_clock::time_point *, dim_t)
+         * 
+         * Constructs a source from an array of system clock time points.
+         * 
+         * INPUT:
+         *  t (const std::chrono::system_clock::time_point *) the time points to convert
+         *  numel (dim_t) the number of time points
+         */
+        timesource(const std::chrono::system_clock::time_point *t, dim_t numel);
+        ~timesource() override = default;
+
+        [[nodiscard]] datatype type() const override;
+        [[nodiscard]] array_class mclass() const override;
+        [[nodiscard]] dim_t numel() const override;
+        void read(dim_t first, dim_t n, void *buf) override;
+    };
+
+}
+
+#endif
@@ -20,6 +20,8 @@
 #ifndef TOO_MAT_DATENUM_H
 #define TOO_MAT_DATENUM_H
 
+#include "types.hpp"
+
 namespace mat
 {
 
@@ -141,7 +143,8 @@ namespace mat
      * 
      * Calculates the MATLAB datenum of the CDF TT2000 timestamp. Due to the limited precision of 
      * the MATLAB datenum, this results is significant loss of accuracy compared to the TT2000 
-     * timestamp.
+     * timestamp. Leap seconds are taken from the table returned by mat::leap_seconds() (see
+     * date/leap.hpp), which can be updated at runtime.
      * 
      * INPUT:
      *  s (double) the CDF TT2000 timestamp to calculate the datenum for
@@ -149,6 +152,75 @@ namespace mat
      *  the MATLAB datenum
      */
     double tt20002dn(long long tt);
+
+    //---------------- batch conversions of arrays of timestamps to MATLAB datenums ----------------//
+    //
+    // Each of these gives bit-for-bit the same results as calling the scalar function on each
+    // element of the input. The conversions are vectorised where possible, and arrays large
+    // enough to benefit are split across the available hardware threads. The input and output
+    // arrays may be the same array.
+
+    /*
+     * void mat::unix2dn(const double *s, double *dn, dim_t n)
+     * 
+     * Calculates the MATLAB datenums of an array of fractional unix timestamps.
+     * 
+     * INPUT:
+     *  s (const double *) the unix timestamps to convert (n values)
+     *  dn (double *) the array to store the datenums in (n values)
+     *  n (dim_t) the number of timestamps to convert
+     */
+    void unix2dn(const double *s, double *dn, dim_t n);
+
+    /*
+     * void mat::j19002dn(const double *j, double *dn, dim_t n)
+     * 
+     * Converts an array of julian day numbers in the J1900 epoch to MATLAB datenums.
+     * 
+     * INPUT:
+     *  j (const double *) the J1900 day numbers to convert (n values)
+     *  dn (double *) the array to store the datenums in (n values)
+     *  n (dim_t) the number of day numbers to convert
+     */
+    void j19002dn(const double *j, double *dn, dim_t n);
+
+    /*
+     * void mat::j20002dn(const double *j, double *dn, dim_t n)
+     * 
+     * Converts an array of julian day numbers in the J2000 epoch to MATLAB datenums.
+     * 
+     * INPUT:
+     *  j (const double *) the J2000 day numbers to convert (n values)
+     *  dn (double *) the array to store the datenums in (n values)
+     *  n (dim_t) the number of day numbers to convert
+     */
+    void j20002dn(const double *j, double *dn, dim_t n);
+
+    /*
+     * void mat::mjd2dn(const double *j, double *dn, dim_t n)
+     * 
+     * Converts an array of modified julian day numbers to MATLAB datenums.
+     * 
+     * INPUT:
+     *  j (const double *) the MJD day numbers to convert (n values)
+     *  dn (double *) the array to store the datenums in (n values)
+     *  n (dim_t) the number of day numbers to convert
+     */
+    void mjd2dn(const double *j, double *dn, dim_t n);
+
+    /*
+     * void mat::tt20002dn(const long long *tt, double *dn, dim_t n)
+     * 
+     * Calculates the MATLAB datenums of an array of CDF TT2000 timestamps. The leap second
+     * interval of the previous value is reused while it still applies, so sorted input costs a
+     * couple of comparisons per value, with no table search.
+     * 
+     * INPUT:
+     *  tt (const long long *) the CDF TT2000 timestamps to convert (n values)
+     *  dn (double *) the array to store the datenums in (n values)
+     *  n (dim_t) the number of timestamps to convert
+     */
+    void tt20002dn(const long long *tt, double *dn, dim_t n);
 }
 
 #endif
\ No newline at end of file
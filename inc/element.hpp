@@ -20,9 +20,12 @@
 #ifndef TOO_MAT_ELEMENT_H
 #define TOO_MAT_ELEMENT_H
 
+#include "small_buffer.hpp"
 #include "types.hpp"
+#include "trace.hpp"
 
 #include <cstring>
+#include <iterator>
 #include <utility>
 #include <vector>
 #include <string>
@@ -39,7 +42,7 @@ namespace mat
     protected:
         datatype _type = miUNKNOWN;
         std::string _name;
-        std::shared_ptr<std::vector<unsigned char>> _data;
+        small_buffer _data;
 
         template <typename T=unsigned char>
         T *ptr();
@@ -171,7 +174,7 @@ namespace mat
     template <typename T>
     T *element::ptr()
     {
-        return !_data ? NULL : (T *)&_data->at(0);
+        return _data.empty() ? NULL : (T *)_data.data();
     }
 
     template <typename NT>
@@ -180,9 +183,23 @@ namespace mat
         _type(get_datatype(*start)),
         _name(std::move(name))
     {
-        dim_t n = (end-start)*sizeof(*start);
-        _data = std::make_shared<std::vector<unsigned char>>(n);
-        std::memcpy(ptr(),&(*start),n);
+        MAT_TRACE_SPAN("element::copy");
+        using T = typename std::iterator_traits<NT>::value_type;
+        dim_t n = std::distance(start,end)*sizeof(T);
+        _data = small_buffer(n);
+        if (!n) return;
+        if constexpr (is_contiguous<NT>::value)
+            std::memcpy(ptr(),&(*start),n);
+        else
+        {
+            // The values may be anywhere (e.g., in a std::deque), so copy them one at a time
+            auto out = ptr();
+            for (; start != end; ++start, out += sizeof(T))
+            {
+                T value = *start;
+                std::memcpy(out,&value,sizeof(T));
+            }
+        }
     }
 
     template <typename T>
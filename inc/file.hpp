@@ -23,23 +23,67 @@
 
 #include "types.hpp"
 #include "container.hpp"
+#include "io/async.hpp"
+#include "io/estimate.hpp"
+#include "io/uring.hpp"
+#include "io/zcache.hpp"
 
 #include <string>
 #include <utility>
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
 #include <initializer_list>
+#include <map>
+#include <mutex>
 #include <type_traits>
+#include <unordered_map>
 #include <stdexcept>
 
 namespace mat
 {
 
+    template <file_version V>
+    class rolling;
+
     template <file_version V=V7>
     class file : public container
     {
+        // mat::rolling appends to its current shard directly
+        friend class rolling<V>;
+
         bool open;
         std::string head;
+        // Whether the creation time is written into the header
+        bool _stamp = true;
+        std::unique_ptr<async_writer> _async;
+        std::shared_future<void> _closed;
+        compress_options _zopts;
+        std::map<std::string, compress_options> _zvars;
+        // The settings in place when each variable not yet written was added (V7 only)
+        std::unordered_map<const element *, compress_options> _zadded;
+        mutable std::mutex _zlock;
+        std::unique_ptr<file_stats> _stats;
+        std::function<void(const file_stats &)> _on_stats;
+        // Where to write the file, if not to the path it is named after
+        std::shared_ptr<sink> _sink;
+        std::unique_ptr<large_file_options> _large;
+        std::unique_ptr<uring_options> _uring;
+
+        // Opens the destination of the file, when it is time to write it, given its expected
+        // size if known
+        std::shared_ptr<sink> open_sink(dim_t expected = 0);
+
+        // Write the file header, and a single top-level element, in the format of this version
+        static void write_header(fwriter &fw, const std::string &head, bool stamp);
+        static void write_child(fwriter &fw, element &child, const compress_options &opts);
+
+        // The settings the variable was added with
+        compress_options added(const element &child) const;
+
+        void append(std::shared_ptr<element> child) override;
 
         inline void write(fwriter&, file_version, bool) override
         {
@@ -53,6 +97,20 @@ namespace mat
 
     public:
 		explicit file(std::string fname, std::string head="Created using 2mat");
+
+        /*
+         * mat::file::file(std::shared_ptr<sink>, std::string)
+         *
+         * Constructs a file that is written to the passed sink rather than to disk -- for
+         * instance, a memory_sink to keep the file in memory, or a stream_sink to send it down a
+         * pipe. If the sink cannot seek, each compressed element of a V7 file is compressed in
+         * memory first, so that its size can be written ahead of it.
+         *
+         * INPUT:
+         *  out (std::shared_ptr<sink>) where to write the file
+         *  head (std::string) the header text of the file
+         */
+        explicit file(std::shared_ptr<sink> out, std::string head="Created using 2mat");
 		~file() override;
 
         /*
@@ -78,21 +136,178 @@ namespace mat
 		[[nodiscard]] const std::string &header() const;
 
         /*
-         * void mat::file::close() const
+         * void mat::file::timestamp(bool)
+         *
+         * Sets whether the time the file was written is included in its header (it is by
+         * default). Without it, writing the same variables with the same settings gives the same
+         * bytes every time, so identical files can be told apart by their contents alone. This
+         * must be called before close() or async().
+         *
+         * INPUT:
+         *  stamp (bool) whether to write the creation time
+         */
+        void timestamp(bool stamp);
+
+        /*
+         * void mat::file::compression(const compress_options &)
+         *
+         * Sets how the variables of this file are compressed, unless they have settings of their
+         * own. This has no effect on files that are not compressed (V6 and lower). Each variable
+         * is compressed with the settings in place when it is added, so changes only apply to
+         * variables added afterwards. Throws an mfile_error if the settings are not valid (see
+         * mat::check_compression).
+         *
+         * INPUT:
+         *  opts (const compress_options &) the compression settings
+         */
+        void compression(const compress_options &opts);
+
+        /*
+         * void mat::file::compression(const std::string &, const compress_options &)
+         *
+         * As above, for the top-level variable with the specified name only.
+         *
+         * INPUT:
+         *  name (const std::string &) the name of the variable
+         *  opts (const compress_options &) the compression settings
+         */
+        void compression(const std::string &name, const compress_options &opts);
+
+        /*
+         * compress_options mat::file::compression(const std::string &) const
+         *
+         * Returns a copy of the compression settings that a variable with the specified name
+         * would be added with now.
+         *
+         * INPUT:
+         *  name (const std::string &) the name of the variable
+         * RETURNS:
+         *  The compression settings of the variable
+         */
+        [[nodiscard]] compress_options compression(const std::string &name) const;
+
+        /*
+         * void mat::file::record_stats(std::function<void(const file_stats &)>)
+         *
+         * Starts recording what it takes to write this file and each of its variables: bytes
+         * before and after compression, padding, calls to fwrite, peak buffered memory, and time
+         * spent serialising, compressing and in fwrite. This must be called before close() or
+         * async(); files not recording stats pay only a null check per write.
+         *
+         * INPUT:
+         *  done (std::function<void(const file_stats &)>) if set, called with the stats once the
+         *      file has been written and closed, on the thread that wrote it
+         */
+        void record_stats(std::function<void(const file_stats &)> done = {});
+
+        /*
+         * const file_stats &mat::file::stats() const
+         *
+         * Returns the stats recorded while writing this file. These are complete once close()
+         * has returned (or, in asynchronous mode, once its future is ready).
+         *
+         * RETURNS:
+         *  The stats of this file
+         */
+        [[nodiscard]] const file_stats &stats() const;
+
+        /*
+         * size_estimate mat::file::estimate()
+         *
+         * Predicts the size of this file, and the memory needed to write it, without writing
+         * anything. The size of a V6 file is exact. For V7 files, each variable is compressed
+         * with its own settings, except that arrays larger than the sample size of the settings
+         * are sampled rather than compressed in full (see mat::estimator), giving bounds on the
+         * size as well; the time taken depends on the number of arrays, not on their size.
+         * Variables to be tuned are predicted at the level and strategy they are given. This
+         * must be called before close() or async(), and is not supported for V7.3 files.
+         *
+         * RETURNS:
+         *  The predicted size of the file, and of each of its top-level variables
+         */
+        [[nodiscard]] size_estimate estimate() const;
+
+        /*
+         * void mat::file::large_file(const large_file_options &)
+         *
+         * Writes the file with a mat::large_file_sink, for files large enough that writing them
+         * through the page cache would push everything else out of it. Unless opts gives the
+         * expected size, the space for the file is reserved from the size of its elements when
+         * it is closed: this is exact for V6 files, and an upper bound for most V7 files. In
+         * asynchronous mode the size isn't known in advance, so nothing is reserved unless it is
+         * given. This must be called before close() or async(), and has no effect on files
+         * written to a sink. It replaces any earlier call to uring().
+         *
+         * INPUT:
+         *  opts (const large_file_options &) the settings of the sink
+         */
+        void large_file(const large_file_options &opts = {});
+
+        /*
+         * void mat::file::uring(const uring_options &)
+         *
+         * Writes the file with a mat::uring_sink, so that compressing (or serialising) each block
+         * of the file overlaps with writing the blocks before it. If io_uring isn't available, the
+         * file is written as usual. This must be called before close() or async(), and has no
+         * effect on files written to a sink. It replaces any earlier call to large_file().
+         *
+         * INPUT:
+         *  opts (const uring_options &) the settings of the sink
+         */
+        void uring(const uring_options &opts = {});
+
+        /*
+         * void mat::file::async(const async_options &)
+         *
+         * Switches the file to asynchronous mode: the file is opened and its header written
+         * straight away, and from then on each element passed to add() is written by background
+         * threads instead of being held until close(). Memory is bounded by the byte budget in
+         * opts -- once elements waiting to be written exceed it, add() either blocks or throws
+         * (and the element is not added). Elements already added are queued first, whatever the
+         * budget, as they are already in memory. The header cannot be changed after this.
+         * 
+         * As the file is created straight away, closing it without adding anything leaves a
+         * valid file with no variables; a file closed with nothing added, and never switched to
+         * async mode, is not created at all.
+         *
+         * INPUT:
+         *  opts (const async_options &) the settings of the background writer
+         */
+        void async(const async_options &opts = {});
+
+        /*
+         * std::shared_future<void> mat::file::close()
          *
          * Write all data to disk and close the file. After this, the file cannot be written to
-         * anymore.
+         * anymore. In asynchronous mode this returns immediately, and the returned future becomes
+         * ready once the background writer has finished (holding any error that occurred);
+         * otherwise the data is written before returning.
          *
          * RETURNS:
-         *  The header of this file
+         *  A future that is ready once the file has been written and closed
          */
-        void close();
+        std::shared_future<void> close();
     };
 
+    template <>
+    void file<V6>::write_header(fwriter &fw, const std::string &head, bool stamp);
+    template <>
+    void file<V6>::write_child(fwriter &fw, element &child, const compress_options &opts);
+    template <>
+    void file<V7>::write_header(fwriter &fw, const std::string &head, bool stamp);
+    template <>
+    void file<V7>::write_child(fwriter &fw, element &child, const compress_options &opts);
+    template <>
+    std::shared_future<void> file<V7_3>::close();
+
     template <file_version V>
     file<V>::~file()
     {
-        close();
+        // Errors can't be thrown from here; call close() and check the future to see them
+        try
+        {
+            close().wait();
+        } catch (...) {}
     }
 
     template <file_version V>
@@ -103,6 +318,28 @@ namespace mat
         head(std::move(head))
     {}
 
+    template <file_version V>
+    file<V>::file(std::shared_ptr<sink> out, std::string head)
+    :
+        container(out ? out->name() : ""),
+        open(true),
+        head(std::move(head)),
+        _sink(std::move(out))
+    {
+        if (!_sink) throw mfile_error("Cannot write to a null sink");
+    }
+
+    template <file_version V>
+    std::shared_ptr<sink> file<V>::open_sink(dim_t expected)
+    {
+        if (_sink) return _sink;
+        if (_uring) return uring_sink::open(_name,*_uring);
+        if (!_large) return std::make_shared<file_sink>(_name);
+        auto opts = *_large;
+        if (!opts.expected) opts.expected = expected;
+        return std::make_shared<large_file_sink>(_name,opts);
+    }
+
     template <file_version V>
     void file<V>::header(const std::string &header)
     {
@@ -115,6 +352,226 @@ namespace mat
         return head;
     }
 
+    template <file_version V>
+    void file<V>::timestamp(bool stamp)
+    {
+        if (!open || _async) throw mfile_error("Cannot change the header of a written file");
+        _stamp = stamp;
+    }
+
+    template <file_version V>
+    void file<V>::compression(const compress_options &opts)
+    {
+        check_compression(opts);
+        std::lock_guard<std::mutex> lock(_zlock);
+        _zopts = opts;
+    }
+
+    template <file_version V>
+    void file<V>::compression(const std::string &name, const compress_options &opts)
+    {
+        check_compression(opts);
+        std::lock_guard<std::mutex> lock(_zlock);
+        _zvars[name] = opts;
+    }
+
+    template <file_version V>
+    compress_options file<V>::compression(const std::string &name) const
+    {
+        std::lock_guard<std::mutex> lock(_zlock);
+        auto it = _zvars.find(name);
+        return it == _zvars.end() ? _zopts : it->second;
+    }
+
+    template <file_version V>
+    compress_options file<V>::added(const element &child) const
+    {
+        std::lock_guard<std::mutex> lock(_zlock);
+        auto it = _zadded.find(&child);
+        if (it != _zadded.end()) return it->second;
+        auto var = _zvars.find(child.name());
+        return var == _zvars.end() ? _zopts : var->second;
+    }
+
+    template <file_version V>
+    void file<V>::record_stats(std::function<void(const file_stats &)> done)
+    {
+        if (!open || _async) throw mfile_error("Cannot record stats for a file already written");
+        _stats.reset(new file_stats());
+        _on_stats = std::move(done);
+    }
+
+    template <file_version V>
+    const file_stats &file<V>::stats() const
+    {
+        if (!_stats) throw mfile_error("Stats are not being recorded for this file");
+        return *_stats;
+    }
+
+    template <file_version V>
+    size_estimate file<V>::estimate() const
+    {
+        if (!open || _async)
+            throw mfile_error("Cannot estimate the size of a file already written");
+        if (V == V7_3) throw mfile_error("Cannot estimate the size of a V7.3 file");
+        MAT_TRACE_SPAN("file::estimate");
+
+        // The buffers of the sink, which hold the whole file if it is kept in memory
+        size_estimate est;
+        dim_t buffers = 0, compressor = 0, variable = 0;
+        if (_uring) buffers = _uring->depth*_uring->block;
+        else if (_large) buffers = _large->block;
+        bool seekable = !_sink || _sink->seekable();
+
+        est.raw = est.bytes = est.low = est.high = 128;
+        estimator z;
+        for (auto const &child : _children)
+        {
+            variable_estimate var;
+            compress_options opts;
+            if (V == V6)
+            {
+                var.name = child->name();
+                var.raw = var.bytes = var.low = var.high = 8 + child->size(true);
+            } else {
+                opts = added(*child);
+                var = z.compressed(*child, opts);
+                // Two buffers of a chunk, and the deflate state (see zlib's zconf.h)
+                compressor = std::max(compressor, 2*opts.chunk + (1 << 18) + 6144);
+            }
+            est.raw += var.raw;
+            est.bytes += var.bytes;
+            est.low += var.low;
+            est.high += var.high;
+            est.exact = est.exact && var.exact;
+
+            // Elements compressed into memory before they are written, and (to find them in the
+            // cache) the element uncompressed
+            dim_t staged = var.staging;
+            if (V != V6 && (opts.cache || !seekable)) staged += var.bytes - 8;
+            if (V != V6 && opts.cache) staged += var.raw;
+            variable = std::max(variable, staged);
+            est.variables.push_back(std::move(var));
+        }
+
+        est.sampled = z.sampled();
+        if (std::dynamic_pointer_cast<memory_sink>(_sink)) buffers = est.bytes;
+        est.memory = buffers + compressor + variable;
+        return est;
+    }
+
+    template <file_version V>
+    void file<V>::large_file(const large_file_options &opts)
+    {
+        if (!open || _async) throw mfile_error("Cannot change how a file already written is written");
+        _large.reset(new large_file_options(opts));
+        _uring.reset();
+    }
+
+    template <file_version V>
+    void file<V>::uring(const uring_options &opts)
+    {
+        if (!open || _async) throw mfile_error("Cannot change how a file already written is written");
+        _uring.reset(new uring_options(opts));
+        _large.reset();
+    }
+
+    template <file_version V>
+    void file<V>::append(std::shared_ptr<element> child)
+    {
+        if (!open) throw mfile_error("Cannot add to a closed file");
+        if (_async)
+        {
+            auto opts = compression(child->name());
+            _async->push(std::move(child),opts);
+            return;
+        }
+        if (V == V7)
+        {
+            auto opts = compression(child->name());
+            std::lock_guard<std::mutex> lock(_zlock);
+            _zadded[child.get()] = std::move(opts);
+        }
+        container::append(std::move(child));
+    }
+
+    template <file_version V>
+    void file<V>::async(const async_options &opts)
+    {
+        if (!open) throw mfile_error("Cannot write to a closed file");
+        if (_async) return;
+        _async.reset(new async_writer(open_sink(), opts,
+            [h = head, s = _stamp](fwriter &fw) { write_header(fw,h,s); },
+            [](fwriter &fw, element &child, const compress_options &opts) {
+                write_child(fw,child,opts);
+            }, _stats.get(), _on_stats));
+        for (auto &child : _children) _async->push(child, added(*child), false);
+        _children.clear();
+        _zadded.clear();
+    }
+
+    template <file_version V>
+    std::shared_future<void> file<V>::close()
+    {
+        if (!open) return _closed;
+        open = false;
+        if (_async)
+        {
+            _closed = _async->close();
+            return _closed;
+        }
+
+        std::promise<void> done;
+        _closed = done.get_future().share();
+        try
+        {
+            if (!_children.empty())
+            {
+                auto start = stats_clock::now();
+                // The header, then each element with its tag
+                dim_t expected = 128;
+                if (_large)
+                    for (auto const &child : _children) expected += 8 + child->size(true);
+                auto out = open_sink(expected);
+                fwriter fw(out);
+                if (_stats)
+                {
+                    _stats->total.name = out->name();
+                    fw.stats(&_stats->total);
+                }
+                write_header(fw,head,_stamp);
+                for (auto const &child : _children)
+                {
+                    auto opts = added(*child);
+                    if (!_stats)
+                    {
+                        write_child(fw,*child,opts);
+                        continue;
+                    }
+                    write_stats var;
+                    var.name = child->name();
+                    fw.stats(&var);
+                    auto t = stats_clock::now();
+                    write_child(fw,*child,opts);
+                    var.serialise = seconds_since(t) - var.deflate - var.io;
+                    fw.stats(&_stats->total);
+                    _stats->add(var);
+                }
+                fw.close();
+                if (_stats)
+                {
+                    _stats->wall = seconds_since(start);
+                    if (_on_stats) _on_stats(*_stats);
+                }
+            }
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+            throw;
+        }
+        return _closed;
+    }
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+ * 2mat/generator.hpp -- source that produces matrix data from a user callback
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_GENERATOR_H
+#define TOO_MAT_GENERATOR_H
+
+#include "source.hpp"
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mat
+{
+
+    /*
+     *  mat::generator
+     * 
+     * A source whose data is computed by a user callback as the matrix is written. The callback
+     * is called with the index of the first element wanted, the number of elements wanted, and a
+     * buffer to fill with them. Calls are made in order, so the callback may simply produce the
+     * next chunk each time, but the matrix is read from the first element again each time it is
+     * written.
+     * 
+     * TEMPLATE
+     *  T   The type of the elements produced by the callback, which must be a real numeric type
+     *      (sources have no imaginary part, and no logical or char flags)
+     * 
+     */
+    template <typename T>
+    class generator : public source
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T,bool>::value &&
+            matlab_type<T>::supported && matlab_type<T>::mclass != mxCHAR_CLASS,
+            "Generators must produce real numeric values");
+    public:
+        typedef std::function<void(dim_t first, dim_t n, T *buf)> callback;
+    private:
+        dim_t _numel;
+        callback _fill;
+    public:
+        /*
+         * mat::generator::generator(dim_t, callback)
+         * 
+         * Constructs a generator that produces numel elements by calling fill.
+         * 
+         * INPUT:
+         *  numel (dim_t) the number of elements to produce
+         *  fill (callback) the function to produce the elements
+         */
+        generator(dim_t numel, callback fill)
+        :
+            _numel(numel),
+            _fill(std::move(fill))
+        {}
+        ~generator() override = default;
+
+        [[nodiscard]] datatype type() const override { return get_datatype(T()); }
+        [[nodiscard]] array_class mclass() const override { return get_class(T()); }
+        [[nodiscard]] dim_t numel() const override { return _numel; }
+
+        void read(dim_t first, dim_t n, void *buf) override
+        {
+            _fill(first,n,(T *)buf);
+        }
+    };
+
+    /*
+     * std::shared_ptr<source> mat::generate<T>(dim_t, F &&)
+     * 
+     * Creates a generator producing numel elements of type T from the passed callback, which can
+     * then be added to a container. For example, to add a 1000x1000 matrix of doubles computed on
+     * the fly:
+     * 
+     * file.add("x", mat::generate<double>(1000000, [](dim_t first, dim_t n, double *buf) {
+     *     for (dim_t i = 0; i < n; ++i) buf[i] = model(first+i);
+     * }), {1000,1000});
+     * 
+     * TEMPLATE
+     *  T   The type of the elements produced by the callback
+     *  F   The type of the callback, which must be callable as void(dim_t, dim_t, T*)
+     * INPUT:
+     *  numel (dim_t) the number of elements to produce
+     *  fill (F &&) the function to produce the elements
+     * RETURNS:
+     *  the new generator
+     */
+    template <typename T, typename F>
+    std::shared_ptr<source> generate(dim_t numel, F &&fill)
+    {
+        return std::make_shared<generator<T>>(numel,
+            typename generator<T>::callback(std::forward<F>(fill)));
+    }
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * 2mat/half.hpp -- a source widening half-precision floating point data to single precision
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_HALF_H
+#define TOO_MAT_HALF_H
+
+#include "source.hpp"
+
+#include <cstdint>
+
+namespace mat
+{
+
+    /*
+     * mat::half_format
+     *
+     * enumerated list of the 16-bit floating point formats that can be widened to single
+     * precision
+     *
+     */
+    enum half_format
+    {
+        FLOAT16,    // IEEE 754 binary16: 5 exponent bits, 10 mantissa bits
+        BFLOAT16    // the top half of a single: 8 exponent bits, 7 mantissa bits
+    };
+
+    /*
+     *  mat::halfsource
+     *
+     * A source that widens an array of 16-bit floating point values to single precision as the
+     * matrix holding it is written (MATLAB has no half-precision class), so that the array of
+     * singles never exists in full. The conversion is exact. The values are NOT copied: they must
+     * remain valid (and unchanged) until the matrix has been written.
+     *
+     */
+    class halfsource : public source
+    {
+        const uint16_t *_data;
+        dim_t _numel;
+        half_format _format;
+    public:
+        /*
+         * mat::halfsource::halfsource(const uint16_t *, dim_t, half_format)
+         *
+         * Constructs a source from an array of 16-bit floating point values, given by their bits
+         * (so any half type, such as _Float16 or __bf16, can be passed by casting its pointer).
+         *
+         * INPUT:
+         *  data (const uint16_t *) the values to widen
+         *  numel (dim_t) the number of values
+         *  format (half_format) the format of the values
+         */
+        halfsource(const uint16_t *data, dim_t numel, half_format format);
+        ~halfsource() override = default;
+
+        [[nodiscard]] datatype type() const override;
+        [[nodiscard]] array_class mclass() const override;
+        [[nodiscard]] dim_t numel() const override;
+        void read(dim_t first, dim_t n, void *buf) override;
+    };
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * 2mat/io/async.hpp -- background writer for writing elements to file as they are added
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_ASYNC_H
+#define TOO_MAT_IO_ASYNC_H
+
+#include "../element.hpp"
+#include "fwriter.hpp"
+#include "stats.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mat
+{
+
+    /*
+     * mat::async_options
+     * 
+     * Settings for writing a file in the background (see mat::file::async).
+     * 
+     *  budget  the maximum number of bytes (as measured by element::size) of elements waiting to
+     *          be written. An element larger than the budget is accepted once nothing else is
+     *          waiting.
+     *  block   whether add() waits for space when the budget is exhausted (true), or throws an
+     *          mfile_error immediately (false)
+     *  workers the number of threads serialising (and for V7, compressing) elements in parallel.
+     *          With no workers, the writer thread does this itself.
+     */
+    struct async_options
+    {
+        dim_t budget = 256ull << 20;
+        bool block = true;
+        unsigned int workers = 0;
+    };
+
+    /*
+     *  mat::async_writer
+     * 
+     * Writes elements to a file on a background thread, in the order they are pushed. Memory is
+     * bounded by the byte budget: once it is used up, push() blocks or throws until the writer
+     * catches up. Used by mat::file in async mode; the file supplies functions to write the file
+     * header and each element, which are called on the background threads. Each element is
+     * written with the compression settings it was pushed with.
+     * 
+     */
+    class async_writer
+    {
+    public:
+        typedef std::function<void(fwriter &)> header_fn;
+        typedef std::function<void(fwriter &, element &, const compress_options &)> element_fn;
+    private:
+        struct job
+        {
+            std::shared_ptr<element> elem;
+            compress_options zopts;
+            dim_t bytes;
+            bool claimed = false, done = false;
+            std::vector<unsigned char> blob;
+            write_stats stats;
+        };
+
+        async_options _opts;
+        element_fn _write;
+        std::unique_ptr<fwriter> _fw;
+
+        // Stats are only gathered if _stats is set; only the writer thread touches them
+        file_stats *_stats;
+        std::function<void(const file_stats &)> _done;
+        stats_clock::time_point _start;
+        dim_t _peak = 0;
+
+        std::mutex _mutex;
+        std::condition_variable _space, _work, _ready;
+        // Every job not yet written, in order, and (with workers) the jobs not yet started
+        std::deque<std::shared_ptr<job>> _queue, _pending;
+        dim_t _queued = 0;
+        bool _closing = false;
+        std::exception_ptr _error;
+
+        std::promise<void> _finished;
+        std::shared_future<void> _future;
+        std::thread _writer;
+        std::vector<std::thread> _workers;
+
+        void run_writer();
+        void run_worker();
+        void fail(std::exception_ptr e);
+        // Writes a job straight to the file, on the writer thread
+        void write_job(job &j);
+    public:
+        /*
+         * mat::async_writer::async_writer(std::shared_ptr<sink>, const async_options &, header_fn, element_fn, file_stats *, std::function<void(const file_stats &)>)
+         * 
+         * Starts the background threads writing to the sink. The header is written immediately.
+         * If stats is not null, what it takes to write the file is recorded there, and passed to
+         * done (if set) on the writer thread once the file is closed.
+         * 
+         * INPUT:
+         *  out (std::shared_ptr<sink>) where to write the file
+         *  opts (const async_options &) the settings of the writer
+         *  header (header_fn) writes the file header
+         *  write (element_fn) writes a single top-level element
+         *  stats (file_stats *) where to record stats, or null
+         *  done (std::function<void(const file_stats &)>) called with the stats once finished
+         */
+        async_writer(std::shared_ptr<sink> out, const async_options &opts, header_fn header,
+            element_fn write, file_stats *stats = nullptr,
+            std::function<void(const file_stats &)> done = {});
+        ~async_writer();
+
+        /*
+         * void mat::async_writer::push(std::shared_ptr<element>, const compress_options &, bool)
+         * 
+         * Queues an element to be written with the specified compression settings. Blocks, or throws an mfile_error, if the byte budget
+         * is exhausted (unless bounded is false); also throws if an earlier element failed to be
+         * written. If it throws, the element has not been queued.
+         * 
+         * INPUT:
+         *  elem (std::shared_ptr<element>) the element to write
+         *  opts (const compress_options &) how to compress the element, if at all
+         *  bounded (bool) whether the element counts against the budget before it is queued.
+         *      Elements already held in memory, such as those added to a file before it was
+         *      switched to async mode, are queued regardless, so none of them can be lost.
+         */
+        void push(std::shared_ptr<element> elem, const compress_options &opts, bool bounded = true);
+
+        /*
+         * std::shared_future<void> mat::async_writer::close()
+         * 
+         * Stops accepting elements. The returned future is ready once every queued element has
+         * been written and the file closed, and holds any error that occurred while writing.
+         */
+        std::shared_future<void> close();
+    };
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * 2mat/io/estimate.hpp -- predicting the size of a file, and the memory needed to write it
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_ESTIMATE_H
+#define TOO_MAT_IO_ESTIMATE_H
+
+#include "../types.hpp"
+#include "fwriter.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Fraction of the predicted size of each sampled array allowed below it in the lower bound
+#ifndef MAT_ZMARGIN
+#define MAT_ZMARGIN 0.1
+#endif
+
+namespace mat
+{
+
+    class element;
+
+    /*
+     * mat::variable_estimate
+     *
+     * The predicted size of a single top-level variable in a file (see mat::file::estimate).
+     *
+     *  name        the name of the variable
+     *  raw         the size of the variable uncompressed, with its tag (its size in a V6 file)
+     *  bytes       the predicted size of the variable in the file, with its tag
+     *  low, high   bounds on the size, at about 95% confidence: twice the standard error of the
+     *              compression ratio of the samples either side, and MAT_ZMARGIN more below it.
+     *              Both are bytes if it is exact.
+     *  staging     the most bytes the variable holds in buffers of its own as it is written
+     *  exact       whether bytes is the size the variable will have
+     */
+    struct variable_estimate
+    {
+        std::string name;
+        dim_t raw = 0, bytes = 0, low = 0, high = 0;
+        dim_t staging = 0;
+        bool exact = true;
+    };
+
+    /*
+     * mat::size_estimate
+     *
+     * The predicted cost of writing a file (see mat::file::estimate), made without writing it.
+     *
+     *  raw         the size of the file uncompressed (its size as a V6 file)
+     *  bytes       the predicted size of the file
+     *  low, high   bounds on the size of the file: the sums of the bounds of the variables
+     *  memory      the predicted peak number of bytes held in the buffers of the library (the
+     *              sink, the compressor, and the staging buffers of each variable) while the file
+     *              is written, not counting the variables themselves
+     *  sampled     the number of bytes of data compressed to make the prediction
+     *  exact       whether bytes is the size the file will have, which is always true for V6
+     *              files, and true for V7 files with no large arrays (see mat::estimator)
+     *  variables   the predictions for each top-level variable
+     */
+    struct size_estimate
+    {
+        dim_t raw = 0, bytes = 0, low = 0, high = 0, memory = 0, sampled = 0;
+        bool exact = true;
+        std::vector<variable_estimate> variables;
+    };
+
+    /*
+     *  mat::estimator
+     *
+     * Predicts the compressed size of elements without compressing all of their data, by writing
+     * each element through a compressor into a sink that only counts what it is given. Matrices
+     * pass their data to the estimator rather than writing it (see fwriter::estimate). Arrays of
+     * up to limit() bytes (the sample size of the compression settings) are written as usual, so
+     * elements made of them are compressed exactly as they would be in the file. Larger arrays
+     * are sampled instead: MAT_ZWINDOWS evenly spaced windows, limit() bytes in all, are
+     * compressed as one stream, and their compression ratio is taken as that of the whole array.
+     * So the time taken depends on the number of arrays, not on their size.
+     *
+     */
+    class estimator
+    {
+        z_stream strm{};
+        bool init = false;
+        int level = 0, strategy = 0;
+        dim_t _limit = 0, _sampled = 0, _staging = 0;
+        // The predicted compressed size of the arrays sampled in this element, its variance, and
+        // the margin allowed below it
+        double _bytes = 0, _variance = 0, _margin = 0;
+        bool _partial = false;
+        std::vector<unsigned char> in, out;
+
+        // Compresses bytes of data into the current stream, returning the size of the output
+        dim_t compress(const unsigned char *data, dim_t bytes, int flush);
+    public:
+        typedef std::function<void(dim_t first, dim_t n, unsigned char *buf)> reader;
+
+        estimator() = default;
+        ~estimator();
+        estimator(const estimator &) = delete;
+        estimator &operator=(const estimator &) = delete;
+
+        /*
+         * variable_estimate mat::estimator::compressed(element &, const compress_options &)
+         *
+         * Predicts the size of an element in a V7 file, when compressed with opts. The level and
+         * strategy are used as given: elements to be tuned are predicted without tuning, and
+         * are never exact.
+         *
+         * INPUT:
+         *  elem (element &) the element
+         *  opts (const compress_options &) the compression settings of the element
+         * RETURNS:
+         *  The predicted size of the element
+         */
+        variable_estimate compressed(element &elem, const compress_options &opts);
+
+        // The size of the largest array that is compressed in full
+        [[nodiscard]] dim_t limit() const { return _limit; }
+        // The number of bytes of data compressed so far
+        [[nodiscard]] dim_t sampled() const { return _sampled; }
+
+        /*
+         * void mat::estimator::sample(dim_t, unsigned int, const reader &)
+         *
+         * Samples an array of values, of bytes bytes in all, taking its place in the element.
+         * read(first, n, buf) must produce the n values from value first, as they would be
+         * written. Windows start at a multiple of 64 values.
+         *
+         * INPUT:
+         *  bytes (dim_t) the size of the array
+         *  width (unsigned int) the size of each value
+         *  read (const reader &) the source of the values
+         */
+        void sample(dim_t bytes, unsigned int width, const reader &read);
+
+        // Records a staging buffer of the passed size, used while writing the current element
+        void staging(dim_t bytes) { _staging = std::max(_staging, bytes); }
+    };
+
+}
+
+#endif
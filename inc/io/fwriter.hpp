@@ -22,12 +22,16 @@
 
 #include "../types.hpp"
 #include "../util.hpp"
+#include "sink.hpp"
+#include "stats.hpp"
 
 #include <cstdio>
 #include <string>
 #include <zlib.h>
 #include <type_traits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #ifndef MAT_ZCHUNK
 #define MAT_ZCHUNK 1048576
@@ -37,29 +41,48 @@
 #define MAT_ZLEVEL 8
 #endif
 
+// Number of bytes sampled from each element when choosing compression settings automatically
+#ifndef MAT_ZSAMPLE
+#define MAT_ZSAMPLE 262144
+#endif
+
+// Number of places the sample of each element is taken from
+#ifndef MAT_ZWINDOWS
+#define MAT_ZWINDOWS 8
+#endif
+
+// Number of idle compressors kept for reuse by later elements and files
+#ifndef MAT_ZPOOL
+#define MAT_ZPOOL 8
+#endif
+
 #ifndef MAT_FBUF
 #define MAT_FBUF 4096
 #endif
 
+// Size of the staging buffer used when data has to be converted as it is written
+#ifndef MAT_SCHUNK
+#define MAT_SCHUNK 65536
+#endif
+
 namespace mat
 {
 
-    namespace ios
-    {  
-        enum filepos
-        {
-            beg=SEEK_SET,
-            cur=SEEK_CUR,
-            end=SEEK_END
-        };
-    }
+    class estimator;
+    class zcache;
 
     class filter
     {
+        friend class fwriter;
     protected:
-        FILE *fptr;
+        sink *out;
+        // Where to record what is written, if anywhere (see fwriter::stats)
+        write_stats *stats = nullptr;
+
+        // Writes to the sink, recording the call if stats are being gathered
+        dim_t put(const unsigned char *data, dim_t bytes);
     public:
-        explicit filter(FILE *file);
+        explicit filter(sink *out);
         virtual ~filter() = default;
 
         virtual dim_t write(const unsigned char *data, dim_t bytes) = 0;
@@ -69,44 +92,134 @@ namespace mat
     class nofilter : public filter
     {
     public:
-        explicit nofilter(FILE *file);
+        explicit nofilter(sink *out);
         ~nofilter() override = default;
 
         dim_t write(const unsigned char *data, dim_t bytes) override;
         void flush() override;
     };
 
+    /*
+     * mat::compress_options
+     * 
+     * Settings for compressing the elements of V7 files (see mat::file::compression).
+     * 
+     *  level       the zlib compression level, from 0 (none) to 9 (smallest), or -1 for zlib's
+     *              default
+     *  strategy    the zlib strategy: Z_DEFAULT_STRATEGY, Z_FILTERED, Z_RLE, Z_HUFFMAN_ONLY or
+     *              Z_FIXED
+     *  chunk       the number of bytes compressed at a time
+     *  tune        whether to choose the level and strategy for each element automatically, by
+     *              compressing a sample of it (of up to sample bytes) with a few settings, and
+     *              picking the fastest that reaches both targets below. If none does, the
+     *              smallest of those reaching the speed target is used, or failing that the
+     *              fastest.
+     *  ratio       the target compression ratio (uncompressed/compressed size) when tuning, or 0
+     *  speed       the target compression speed, in MB/s of uncompressed data, when tuning, or 0
+     *  sample      the number of bytes to sample from each element when tuning
+     *  cache       where to look up the compressed form of each top-level element before
+     *              compressing it, and to keep it afterwards, or null (see mat::zcache)
+     */
+    struct compress_options
+    {
+        int level = MAT_ZLEVEL;
+        int strategy = Z_DEFAULT_STRATEGY;
+        dim_t chunk = MAT_ZCHUNK;
+        bool tune = false;
+        double ratio = 0;
+        double speed = 0;
+        dim_t sample = MAT_ZSAMPLE;
+        std::shared_ptr<zcache> cache;
+    };
+
+    /*
+     * void mat::check_compression(const compress_options &)
+     * 
+     * Throws an mfile_error if the level, strategy or chunk size of the settings is not one zlib
+     * accepts, so that bad settings are caught when they are chosen rather than once a file is
+     * being written.
+     * 
+     * INPUT:
+     *  opts (const compress_options &) the settings to check
+     */
+    void check_compression(const compress_options &opts);
+
     class zfilter : public filter
     {
         unsigned char *bptr, *bend;
-        unsigned char buffer[MAT_ZCHUNK]{};
-        unsigned char zbuffer[MAT_ZCHUNK]{};
+        std::vector<unsigned char> buffer, zbuffer;
 
         z_stream strm{};
+        int level, strategy;
+        bool finished = false;
 
         void compress(bool finish);
     public:
-        explicit zfilter(FILE *file, unsigned int level = MAT_ZLEVEL);
+        explicit zfilter(sink *out, const compress_options &opts = {});
         ~zfilter() override;
 
+        // Starts a new compressed stream into out, keeping the buffers and zlib state
+        void reset(sink *out, const compress_options &opts = {});
+
         dim_t write(const unsigned char *data, dim_t bytes) override;
         void flush() override;
     };
 
     class fwriter
     {
-        FILE *fptr;
+        std::shared_ptr<sink> out;
         filter *filt;
+        write_stats *stat = nullptr;
+        estimator *est = nullptr;
+
+        // Deletes the current filter, or keeps it for reuse if it is a compressor
+        void release();
     public:
+        // Creates (or truncates) the file at path
         explicit fwriter(const std::string &path);
+        // Takes ownership of an already open stream, which is closed along with the writer
+        explicit fwriter(FILE *file);
+        // Writes to the passed sink, which is closed along with the writer
+        explicit fwriter(std::shared_ptr<sink> out);
         ~fwriter();
 
-        template <typename T>
-        void addfilter();
+        template <typename T, typename... Args>
+        void addfilter(Args&&... args);
+        // Compresses everything written until rmfilter() is called, using the passed settings
+        void addfilter(const compress_options &opts);
         void rmfilter();
 
+        /*
+         * void mat::fwriter::stats(write_stats *)
+         * 
+         * Starts recording what is written to the passed stats (which are added to, not
+         * cleared), or stops recording if it is null. While nothing is being recorded, the only
+         * cost is a null check per write. Only the counts, and the time spent compressing and in
+         * fwrite, are recorded here; the time spent serialising is up to the caller.
+         * 
+         * INPUT:
+         *  stats (write_stats *) where to record what is written, or null
+         */
+        void stats(write_stats *stats);
+        [[nodiscard]] write_stats *stats() const;
+
+        /*
+         * void mat::fwriter::estimate(estimator *)
+         * 
+         * Makes this writer a dry run for the passed estimator (or a normal writer again, if it
+         * is null): matrices with large arrays hand them to the estimator to be sampled, instead
+         * of writing them (see mat::estimator).
+         * 
+         * INPUT:
+         *  est (estimator *) the estimator to sample large arrays, or null
+         */
+        void estimate(estimator *est);
+        [[nodiscard]] estimator *estimate() const;
+
         [[nodiscard]] dim_t tellp() const;
         dim_t seekp(dim_t pos, ios::filepos = ios::beg);
+        // Whether seekp() is supported by the sink being written to
+        [[nodiscard]] bool seekable() const;
 
         template <typename T, typename U=T>
         dim_t write(T val);
@@ -115,22 +228,31 @@ namespace mat
         template <typename T, typename U=T>
         dim_t write(const T *ptr, dim_t n);
         dim_t write(const std::string &str);
+        // Writes n zero bytes of padding
+        dim_t pad(dim_t n);
 
         void close();
 
     };
 
-    template <typename T>
-    void fwriter::addfilter()
+    template <typename T, typename... Args>
+    void fwriter::addfilter(Args&&... args)
+    {
+        release();
+        filt = new T(out.get(), std::forward<Args>(args)...);
+        filt->stats = stat;
+    }
+
+    template <>
+    inline void fwriter::addfilter<zfilter>()
     {
-        delete filt;
-        filt = new T(fptr);
+        addfilter(compress_options());
     }
 
     template <typename T, typename U>
     dim_t fwriter::write(T val)
     {
-        if (!fptr) throw mfile_error("Cannot write to closed file");
+        if (!out) throw mfile_error("Cannot write to closed file");
         if (std::is_same<T,U>::value)
         {
             filt->write((unsigned char *)&val,sizeof(T));
@@ -144,7 +266,7 @@ namespace mat
     template <typename T, typename U>
     dim_t fwriter::write_n(T val, dim_t n)
     {
-        if (!fptr) throw mfile_error("Cannot write to closed file");
+        if (!out) throw mfile_error("Cannot write to closed file");
         if (std::is_same<T,U>::value)
         {
             for (unsigned int i = 0; i < n; ++i)
@@ -160,7 +282,7 @@ namespace mat
     template <typename T, typename U>
     dim_t fwriter::write(const T *ptr, dim_t n)
     {
-        if (!fptr) throw mfile_error("Cannot write to closed file");
+        if (!out) throw mfile_error("Cannot write to closed file");
         if (std::is_same<T,U>::value)
         {
             return filt->write((unsigned    char *)ptr,n*sizeof(T));
@@ -0,0 +1,239 @@
+/*
+ * 2mat/io/sink.hpp -- destinations for the bytes written by fwriter
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_SINK_H
+#define TOO_MAT_IO_SINK_H
+
+#include "../types.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Size of the blocks written by a large_file_sink; rounded up to a multiple of 4096
+#ifndef MAT_LBLOCK
+#define MAT_LBLOCK (8 << 20)
+#endif
+
+namespace mat
+{
+
+    namespace ios
+    {
+        enum filepos
+        {
+            beg=SEEK_SET,
+            cur=SEEK_CUR,
+            end=SEEK_END
+        };
+    }
+
+    /*
+     *  mat::sink
+     *
+     * Where an fwriter sends the bytes it writes. A sink is written sequentially, and may also
+     * support seeking back over what has already been written -- V7 files use this to fill in the
+     * size of each compressed element once it is known. Files written to a sink that cannot seek
+     * compress each element into memory first instead.
+     *
+     */
+    class sink
+    {
+    public:
+        virtual ~sink() = default;
+
+        /*
+         * dim_t mat::sink::write(const unsigned char *, dim_t)
+         *
+         * Writes bytes at the current position, returning the number written.
+         */
+        virtual dim_t write(const unsigned char *data, dim_t bytes) = 0;
+
+        // The current position, in bytes from the start
+        [[nodiscard]] virtual dim_t tell() const = 0;
+
+        // Whether seek() is supported
+        [[nodiscard]] virtual bool seekable() const = 0;
+
+        /*
+         * void mat::sink::seek(dim_t, ios::filepos)
+         *
+         * Moves the current position, as fseek does. Throws an mfile_error if the sink is not
+         * seekable.
+         */
+        virtual void seek(dim_t pos, ios::filepos whence = ios::beg) = 0;
+
+        // Flushes anything buffered and releases the destination. Nothing is written after this.
+        virtual void close() = 0;
+
+        // A description of the destination, such as the path of a file
+        [[nodiscard]] virtual std::string name() const = 0;
+    };
+
+    /*
+     *  mat::file_sink
+     *
+     * Writes to a file on disk, through a stdio stream.
+     *
+     */
+    class file_sink : public sink
+    {
+        FILE *fptr;
+        std::string _name;
+    public:
+        // Creates (or truncates) the file at path
+        explicit file_sink(const std::string &path);
+        // Takes ownership of an already open, seekable stream, which is closed with the sink
+        explicit file_sink(FILE *file, std::string name = "");
+        ~file_sink() override;
+
+        dim_t write(const unsigned char *data, dim_t bytes) override;
+        [[nodiscard]] dim_t tell() const override;
+        [[nodiscard]] bool seekable() const override { return true; }
+        void seek(dim_t pos, ios::filepos whence) override;
+        void close() override;
+        [[nodiscard]] std::string name() const override { return _name; }
+    };
+
+    /*
+     *  mat::memory_sink
+     *
+     * Writes to a buffer in memory, which grows as needed. The contents are kept after the sink
+     * is closed, so a file can be written into one and then taken out with data() or take().
+     *
+     */
+    class memory_sink : public sink
+    {
+        std::vector<unsigned char> _buf;
+        dim_t _pos = 0;
+    public:
+        // Starts with room for reserve bytes
+        explicit memory_sink(dim_t reserve = 0);
+
+        dim_t write(const unsigned char *data, dim_t bytes) override;
+        [[nodiscard]] dim_t tell() const override { return _pos; }
+        [[nodiscard]] bool seekable() const override { return true; }
+        void seek(dim_t pos, ios::filepos whence) override;
+        void close() override {}
+        [[nodiscard]] std::string name() const override { return "<memory>"; }
+
+        // The bytes written so far
+        [[nodiscard]] const std::vector<unsigned char> &data() const { return _buf; }
+
+        // Moves the bytes written out of the sink, leaving it empty
+        std::vector<unsigned char> take();
+    };
+
+    /*
+     *  mat::stream_sink
+     *
+     * Writes to a stream that cannot seek, such as a pipe, a socket or stdout. Positions are
+     * counted from when the sink was created.
+     *
+     */
+    class stream_sink : public sink
+    {
+        FILE *fptr;
+        bool owned;
+        dim_t _pos = 0;
+        std::string _name;
+    public:
+        /*
+         * mat::stream_sink::stream_sink(FILE *, bool, std::string)
+         *
+         * INPUT:
+         *  file (FILE *) the stream to write to, such as stdout or one opened with popen
+         *  owned (bool) whether to fclose the stream when the sink is closed; otherwise it is only
+         *      flushed
+         *  name (std::string) a description of the stream
+         */
+        explicit stream_sink(FILE *file, bool owned = false, std::string name = "<stream>");
+        ~stream_sink() override;
+
+        dim_t write(const unsigned char *data, dim_t bytes) override;
+        [[nodiscard]] dim_t tell() const override { return _pos; }
+        [[nodiscard]] bool seekable() const override { return false; }
+        void seek(dim_t pos, ios::filepos whence) override;
+        void close() override;
+        [[nodiscard]] std::string name() const override { return _name; }
+    };
+
+    /*
+     * mat::large_file_options
+     *
+     * Settings for writing very large files without disturbing the rest of the system (see
+     * mat::large_file_sink and mat::file::large_file).
+     *
+     *  expected    the expected size of the file in bytes, which is reserved on disk before
+     *              writing so the file doesn't grow one extent at a time, or 0. Space reserved
+     *              but not used is released when the file is closed.
+     *  block       the size of the blocks written, in bytes
+     *  direct      whether to bypass the page cache entirely with O_DIRECT. If the filesystem
+     *              doesn't support it, the file is written through the cache as usual.
+     *  drop_cache  whether to write back and drop the pages behind the write cursor, so the file
+     *              doesn't fill the page cache (and evict everything else)
+     */
+    struct large_file_options
+    {
+        dim_t expected = 0;
+        dim_t block = MAT_LBLOCK;
+        bool direct = false;
+        bool drop_cache = true;
+    };
+
+    /*
+     *  mat::large_file_sink
+     *
+     * Writes to a file on disk in large aligned blocks, straight to the file descriptor. With
+     * drop_cache set, each block is handed to the disk as soon as it is written, and the block
+     * before it is waited for and dropped from the page cache, so no more than a couple of blocks
+     * of the file are ever held in memory. Seeking back into blocks already written (to patch the
+     * size of a compressed element) writes the bytes in place.
+     *
+     */
+    class large_file_sink : public sink
+    {
+        int fd;
+        std::string _name;
+        large_file_options opts;
+        unsigned char *buf;
+        // The file offset of the start of buf, how much of buf is filled, and the position
+        dim_t base = 0, fill = 0, pos = 0;
+
+        // Writes data at off with pwrite, throwing on failure
+        void put(const unsigned char *data, dim_t bytes, dim_t off);
+        // Overwrites bytes already written to the file, before the buffered block
+        void patch(const unsigned char *data, dim_t bytes, dim_t off);
+        // Writes out the (full) buffered block, and starts on the next
+        void flush_block();
+    public:
+        explicit large_file_sink(const std::string &path, const large_file_options &opts = {});
+        ~large_file_sink() override;
+
+        dim_t write(const unsigned char *data, dim_t bytes) override;
+        [[nodiscard]] dim_t tell() const override { return pos; }
+        [[nodiscard]] bool seekable() const override { return true; }
+        void seek(dim_t pos, ios::filepos whence) override;
+        void close() override;
+        [[nodiscard]] std::string name() const override { return _name; }
+    };
+
+}
+
+#endif
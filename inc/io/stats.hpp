@@ -0,0 +1,107 @@
+/*
+ * 2mat/io/stats.hpp -- statistics gathered while writing files
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_STATS_H
+#define TOO_MAT_IO_STATS_H
+
+#include "../types.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace mat
+{
+
+    /*
+     * mat::write_stats
+     * 
+     * What it took to write a single variable, or a whole file (see mat::file::stats and
+     * mat::fwriter::stats).
+     * 
+     *  name        the name of the variable, or the path of the file
+     *  bytes       the number of bytes written, before compression
+     *  written     the number of bytes written, after compression. The size of a compressed
+     *              element, filled in once it is known, overwrites bytes already counted, and is
+     *              counted as a seek and a write only
+     *  padding     the number of those bytes that are padding
+     *  writes      the number of calls made to fwrite
+     *  seeks       the number of seeks (each of which also flushes the compressor)
+     *  cached      the number of variables whose compressed form was taken from a mat::zcache
+     *  peak        the most bytes held in buffers (waiting to be compressed, or, for files written
+     *              in the background, waiting to be written) at any one time
+     *  serialise   seconds spent producing the bytes of the variable
+     *  deflate     seconds spent compressing
+     *  io          seconds spent in fwrite
+     */
+    struct write_stats
+    {
+        std::string name;
+        dim_t bytes = 0, written = 0, padding = 0, writes = 0, seeks = 0, cached = 0, peak = 0;
+        double serialise = 0, deflate = 0, io = 0;
+
+        // Adds the counts and times of other to these; the peak is the larger of the two
+        write_stats &operator+=(const write_stats &other)
+        {
+            bytes += other.bytes;
+            written += other.written;
+            padding += other.padding;
+            writes += other.writes;
+            seeks += other.seeks;
+            cached += other.cached;
+            peak = std::max(peak, other.peak);
+            serialise += other.serialise;
+            deflate += other.deflate;
+            io += other.io;
+            return *this;
+        }
+    };
+
+    /*
+     * mat::file_stats
+     * 
+     * What it took to write a file: the totals for the whole file (including the header), the
+     * wall time from starting to write it to closing it, and the stats of each top-level variable
+     * in the order they were written.
+     */
+    struct file_stats
+    {
+        write_stats total;
+        double wall = 0;
+        std::vector<write_stats> variables;
+
+        void add(const write_stats &var)
+        {
+            total += var;
+            variables.push_back(var);
+        }
+    };
+
+    // The clock used for all timings, and the seconds elapsed since a point on it
+    typedef std::chrono::steady_clock stats_clock;
+
+    inline double seconds_since(stats_clock::time_point start)
+    {
+        return std::chrono::duration<double>(stats_clock::now()-start).count();
+    }
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * 2mat/io/tune.hpp -- chooses compression settings for an element by trial compression
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_TUNE_H
+#define TOO_MAT_IO_TUNE_H
+
+#include "../element.hpp"
+#include "fwriter.hpp"
+
+namespace mat
+{
+
+    /*
+     * compress_options mat::tune(element &, const compress_options &)
+     * 
+     * Chooses the compression level and strategy for an element, as described for
+     * compress_options::tune. The sample is taken from several places spread evenly through the
+     * element as it would be written; writing stops once the sample is complete, but data from
+     * a source is still produced up to that point.
+     * 
+     * INPUT:
+     *  elem (element &) the element to be compressed
+     *  opts (const compress_options &) the targets to meet, and the chunk size to use
+     * RETURNS:
+     *  opts, with the chosen level and strategy, and tune unset
+     */
+    compress_options tune(element &elem, const compress_options &opts);
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * 2mat/io/uring.hpp -- file sink writing through io_uring
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_URING_H
+#define TOO_MAT_IO_URING_H
+
+#include "sink.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Number of buffers a uring_sink keeps in flight at once
+#ifndef MAT_URING_DEPTH
+#define MAT_URING_DEPTH 4
+#endif
+
+// Size of each of those buffers; rounded up to a multiple of 4096
+#ifndef MAT_URING_BLOCK
+#define MAT_URING_BLOCK (1 << 20)
+#endif
+
+namespace mat
+{
+
+    /*
+     * mat::uring_options
+     *
+     * Settings for writing a file through io_uring (see mat::uring_sink and mat::file::uring).
+     *
+     *  depth   the number of buffers; while one is being filled, the others can be written
+     *  block   the size of each buffer, in bytes
+     */
+    struct uring_options
+    {
+        unsigned int depth = MAT_URING_DEPTH;
+        dim_t block = MAT_URING_BLOCK;
+    };
+
+    /*
+     *  mat::uring_sink
+     *
+     * Writes to a file on disk through io_uring, so that the thread producing the data (and, for
+     * V7 files, compressing it) carries on while earlier blocks are written. Data is gathered in
+     * one of depth registered buffers; once it is full, the buffer is submitted for writing and
+     * the next one is filled, waiting only if it is still being written. The ring is driven with
+     * raw system calls, so liburing isn't needed.
+     *
+     * Bytes patched behind the write cursor (the sizes of V7 compressed elements) are changed in
+     * the buffer if it hasn't been submitted yet. Otherwise, once the block they land in has been
+     * written, they are submitted as a write of their own.
+     *
+     * io_uring is only available on Linux, and may be disabled; use open() to fall back to a
+     * mat::file_sink when it isn't.
+     *
+     */
+    class uring_sink : public sink
+    {
+        struct ring;
+        struct buffer
+        {
+            unsigned char *data = nullptr;
+            dim_t offset = 0, size = 0;
+            bool busy = false;
+        };
+
+        std::unique_ptr<ring> _ring;
+        int fd = -1;
+        std::string _name;
+        uring_options opts;
+        std::vector<buffer> bufs;
+        // Small writes submitted from outside the buffers, which must live until they complete
+        std::vector<std::unique_ptr<unsigned char[]>> patches;
+        unsigned int current = 0, inflight = 0;
+        dim_t pos = 0;
+
+        // Submits the current buffer, and moves on to the next (free) one
+        void submit();
+        // Waits for at least one write to complete
+        void reap();
+        // Changes bytes before the current buffer, which have already been submitted
+        void patch(const unsigned char *data, dim_t bytes, dim_t off);
+        void release();
+    public:
+        explicit uring_sink(const std::string &path, const uring_options &opts = {});
+        ~uring_sink() override;
+
+        /*
+         * bool mat::uring_sink::supported()
+         *
+         * Returns whether io_uring can be used by this process. The answer is worked out once,
+         * by setting up a small ring and probing it for IORING_OP_WRITE, which some kernels that
+         * have io_uring lack.
+         */
+        [[nodiscard]] static bool supported();
+
+        /*
+         * std::shared_ptr<sink> mat::uring_sink::open(const std::string &, const uring_options &)
+         *
+         * Opens the file at path with a uring_sink if io_uring is supported, or with a file_sink
+         * if not.
+         */
+        static std::shared_ptr<sink> open(const std::string &path, const uring_options &opts = {});
+
+        dim_t write(const unsigned char *data, dim_t bytes) override;
+        [[nodiscard]] dim_t tell() const override { return pos; }
+        [[nodiscard]] bool seekable() const override { return true; }
+        void seek(dim_t pos, ios::filepos whence) override;
+        void close() override;
+        [[nodiscard]] std::string name() const override { return _name; }
+    };
+
+}
+
+#endif
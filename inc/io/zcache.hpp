@@ -0,0 +1,139 @@
+/*
+ * 2mat/io/zcache.hpp -- cache of compressed elements, keyed on their contents
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_IO_ZCACHE_H
+#define TOO_MAT_IO_ZCACHE_H
+
+#include "../types.hpp"
+#include "fwriter.hpp"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Number of bytes of compressed data kept by the shared cache
+#ifndef MAT_ZCACHE
+#define MAT_ZCACHE (64 << 20)
+#endif
+
+namespace mat
+{
+
+    /*
+     *  mat::zcache
+     *
+     * Keeps the compressed form of recently written top-level elements of V7 files, so that an
+     * element written again -- later in the same file, or to another file -- is copied out
+     * rather than compressed again. Elements are looked up by a 128-bit hash of their
+     * uncompressed bytes (name included) and the compression settings, so only identical
+     * variables match. Once the compressed data held passes the capacity, the least recently
+     * used elements are dropped.
+     *
+     * A cache is used by setting compress_options::cache, for a whole file or for some of its
+     * variables; it may be shared by any number of files, and by the threads writing them. Each
+     * element is serialised into memory before it is looked up, so files using a cache need as
+     * much memory again as their largest variable. Identical elements compressed at the same
+     * time by different threads are both compressed.
+     *
+     */
+    class zcache
+    {
+    public:
+        typedef std::shared_ptr<const std::vector<unsigned char>> blob;
+
+        // What an element is looked up by: the hash of its bytes, and how many there are
+        struct key
+        {
+            uint64_t hash[2];
+            dim_t size;
+
+            bool operator==(const key &other) const
+            {
+                return hash[0] == other.hash[0] && hash[1] == other.hash[1] && size == other.size;
+            }
+        };
+
+    private:
+        struct hasher
+        {
+            size_t operator()(const key &k) const { return (size_t)k.hash[0]; }
+        };
+        struct entry
+        {
+            key k;
+            blob data;
+        };
+
+        mutable std::mutex lock;
+        // Most recently used first
+        std::list<entry> lru;
+        std::unordered_map<key, std::list<entry>::iterator, hasher> index;
+        dim_t _capacity, _size = 0, _hits = 0, _misses = 0;
+
+    public:
+        // Creates a cache holding up to capacity bytes of compressed data
+        explicit zcache(dim_t capacity = MAT_ZCACHE);
+
+        /*
+         * std::shared_ptr<zcache> mat::zcache::shared()
+         *
+         * Returns the cache shared by the whole process, of MAT_ZCACHE bytes, creating it the
+         * first time it is asked for.
+         */
+        static std::shared_ptr<zcache> shared();
+
+        /*
+         * key mat::zcache::digest(const unsigned char *, dim_t, const compress_options &)
+         *
+         * Works out the key of an element from its serialised bytes (tag included) and the
+         * settings it is to be compressed with.
+         *
+         * INPUT:
+         *  data (const unsigned char *) the bytes of the element
+         *  bytes (dim_t) the number of bytes
+         *  opts (const compress_options &) the compression settings
+         * RETURNS:
+         *  The key of the element
+         */
+        static key digest(const unsigned char *data, dim_t bytes, const compress_options &opts);
+
+        // Returns the compressed element with the passed key, or null if it isn't held
+        blob find(const key &k);
+
+        // Keeps a compressed element, unless it is larger than the whole cache
+        void insert(const key &k, blob data);
+
+        // Drops everything held, and resets the counts
+        void clear();
+
+        // The bytes of compressed data held, and the most that can be
+        [[nodiscard]] dim_t size() const;
+        [[nodiscard]] dim_t capacity() const { return _capacity; }
+
+        // The number of lookups that found an element, and that didn't
+        [[nodiscard]] dim_t hits() const;
+        [[nodiscard]] dim_t misses() const;
+    };
+
+}
+
+#endif
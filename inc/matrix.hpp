@@ -20,17 +20,39 @@
 #ifndef TOO_MAT_MATRIX_H
 #define TOO_MAT_MATRIX_H
 
+#include "arena.hpp"
 #include "element.hpp"
+#include "source.hpp"
 #include "util.hpp"
+#include "view.hpp"
 
+#include <memory_resource>
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <initializer_list>
 
+// Size of the buffer used to reorder the data of row-major matrices as they are written
+#ifndef MAT_TBUF
+#define MAT_TBUF (4 << 20)
+#endif
+
 namespace mat
 {
 
+    /*
+     * mat::bitmask
+     * 
+     * A view of a bit-packed boolean mask, used to construct logical matrices. Element i of the
+     * mask is bit (i % 64) of words[i / 64], counting from the least significant bit.
+     * 
+     */
+    struct bitmask
+    {
+        const uint64_t *words;
+        dim_t numel;
+    };
+
     /*
      *  mat::matrix
      * 
@@ -43,12 +65,45 @@ namespace mat
     {
     private:
         array_class _class = mxUNKNOWN_CLASS;
-        std::vector<dim_t> _dims;
+        std::pmr::vector<dim_t> _dims;
         bool _logical = false;
         bool _complex = false;
+        // Whether _data holds a bit-packed logical mask, rather than one byte per element
+        bool _packed = false;
+        // If set, the data is produced by this source as the matrix is written, and _data is empty
+        std::shared_ptr<source> _source;
+        // The layout of _data; row-major data is reordered as it is written
+        array_order _order = column_major;
+
+        /*
+         * std::pmr::vector<dim_t> mat::matrix::make_dims(const std::vector<dimtype> &, dim_t)
+         * 
+         * Returns the dimensions to store for a matrix of numel elements: dims, or a row vector if
+         * dims is empty. They are allocated from the current arena, if there is one.
+         */
+        template <typename dimtype>
+        static std::pmr::vector<dim_t> make_dims(const std::vector<dimtype> &dims, dim_t numel);
 
         template <file_version V>
         void write(fwriter& fw, bool write_name);
+
+        // The number of bytes in each of the real and (for complex matrices) imaginary parts
+        [[nodiscard]] dim_t plane_bytes() const;
+
+        // Writes the real (plane 0) or imaginary (plane 1) part of the data, converting it from
+        // the stored layout to the one MATLAB expects
+        void write_data(fwriter &fw, unsigned int plane);
+
+        // Sets the layout of _data, which only needs reordering if more than one dimension is
+        // larger than 1
+        void order(array_order order);
+
+        // As write_data, for data stored row-major
+        void write_row_major(fwriter &fw, unsigned int plane);
+
+        // Reads n values of a part of the data into buf, from value first in the order MATLAB
+        // expects, for the estimator to sample (see mat::estimator)
+        void read_data(unsigned int plane, dim_t first, dim_t n, unsigned char *buf);
     public:        
         /*
          * mat::matrix::matrix(const std::string &)
@@ -71,6 +126,15 @@ namespace mat
          * the elements of the dims vector must be commensurate with the number of elements in the
          * matrix. If dims is not specified, the matrix will be a 1D row vector.
          * 
+         * If the data is std::complex<float> or std::complex<double>, the matrix is complex. The
+         * data is stored interleaved, as passed, and split into the separate real and imaginary
+         * parts required by MATLAB as it is written. If the data is bool, the matrix is logical.
+         * 
+         * If order is row_major, the data is taken to be laid out as a C array of the given
+         * dimensions (the last index varying fastest), and the matrix has the same dimensions in
+         * MATLAB. The data is stored as passed, and reordered a block at a time as it is written,
+         * so no transposed copy is ever made.
+         * 
          * TEMPLATE
          *  T   The type of the value obtained when dereferencing an argument of type NT
          *  NT  A pointer-like value (e.g., a pointer or iterator)
@@ -78,9 +142,12 @@ namespace mat
          *  name (const str::string &) the name of the new element
          *  start (NT) a pointer to the start of the data to copy
          *  end (NT) a pointer to the end of the data to copy
+         *  dims (const std::vector<dimtype> &) the dimensions of the matrix
+         *  order (array_order) the layout of the data
          */
         template <typename NT, typename dimtype=dim_t>
-		matrix(const std::string &name, NT start, NT end, const std::vector<dimtype> &dims = {});
+		matrix(const std::string &name, NT start, NT end, const std::vector<dimtype> &dims = {},
+            array_order order = column_major);
 
         /*
          * mat::matrix::matrix(const std::string &, T *, dim_t)
@@ -96,12 +163,16 @@ namespace mat
          *  name (const str::string &) the name of the new element
          *  data (T *) a pointer to the start of the data to copy
          *  numel (dim_t) the number of elements to copy
+         *  dims (const std::vector<dimtype> &) the dimensions of the matrix
+         *  order (array_order) the layout of the data, as above
          */
         template <typename T, typename dimtype=dim_t>
-		matrix(const std::string &name, T *data, dim_t numel, const std::vector<dimtype> &dims = {});
+		matrix(const std::string &name, T *data, dim_t numel, const std::vector<dimtype> &dims = {},
+            array_order order = column_major);
 
         template <typename T, typename dimtype=dim_t>
-		matrix(const std::string &name, std::initializer_list<T> data, const std::vector<dimtype> &dims = {});
+		matrix(const std::string &name, std::initializer_list<T> data,
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
 
         /*
          * mat::matrix::matrix(const std::string &, const std::string &)
@@ -136,6 +207,82 @@ namespace mat
          *  start (const std::u32string &) the string to construct the element from
          */
         matrix(const std::string &name, const std::u32string &str);
+
+        /*
+         * mat::matrix::matrix(const std::string &, const std::vector<std::string> &)
+         * 
+         * Constructs a char matrix with a row for each of the passed UTF-8 strings, padded with
+         * spaces to the length of the longest (as MATLAB's char() does). The strings are
+         * validated and transcoded straight into the matrix, so this is much cheaper than adding
+         * them one at a time. If every string is ASCII, the matrix is stored as UTF-8, taking a
+         * byte per character rather than two.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new element
+         *  strs (const std::vector<std::string> &) the rows of the matrix
+         */
+        matrix(const std::string &name, const std::vector<std::string> &strs);
+
+        /*
+         * mat::matrix::matrix(const std::string &, const std::vector<bool> &, const std::vector<dim_t> &)
+         * 
+         * Constructs a logical matrix from the passed vector. The values are stored bit-packed, and
+         * expanded to the one byte per element MATLAB expects as the matrix is written. If dims is
+         * not specified, the matrix will be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new element
+         *  mask (const std::vector<bool> &) the values of the matrix
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        matrix(const std::string &name, const std::vector<bool> &mask,
+            const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::matrix::matrix(const std::string &, const bitmask &, const std::vector<dim_t> &)
+         * 
+         * Constructs a logical matrix from a bit-packed mask. The packed words are deep-copied (so
+         * only one bit is stored per element) and expanded as the matrix is written. If dims is
+         * not specified, the matrix will be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new element
+         *  mask (const bitmask &) the packed values of the matrix
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        matrix(const std::string &name, const bitmask &mask, const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::matrix::matrix(const std::string &, std::shared_ptr<source>, const std::vector<dim_t> &)
+         * 
+         * Constructs a matrix whose data is produced by the passed source as the matrix is
+         * written, rather than being copied up front. The datatype and class of the matrix are
+         * those of the source. If dims is not specified, the matrix will be a 1D row vector.
+         * 
+         * INPUT:
+         *  name (const str::string &) the name of the new element
+         *  src (std::shared_ptr<source>) the source of the data
+         *  dims (const std::vector<dim_t> &) the dimensions of the matrix
+         */
+        matrix(const std::string &name, std::shared_ptr<source> src,
+            const std::vector<dim_t> &dims = {});
+
+        /*
+         * mat::matrix::matrix(const std::string &, const view<T> &)
+         * 
+         * Constructs a matrix from a view of an array, with the extents of the view as its
+         * dimensions. The array is not copied; its values are gathered into the order MATLAB
+         * expects as the matrix is written (straight from the array, if it is already contiguous
+         * and column-major), so it must outlive the matrix.
+         * 
+         * TEMPLATE
+         *  T   The type of the values in the array
+         * INPUT:
+         *  name (const str::string &) the name of the new element
+         *  v (const view<T> &) the view of the data
+         */
+        template <typename T>
+        matrix(const std::string &name, const view<T> &v);
         ~matrix() override = default;
 
         /*
@@ -161,34 +308,50 @@ namespace mat
 
     };
 
+    template <typename dimtype>
+    std::pmr::vector<dim_t> matrix::make_dims(const std::vector<dimtype> &dims, dim_t numel)
+    {
+        std::pmr::vector<dim_t> out(arena::resource());
+        if (dims.empty()) out = {1ull,numel};
+        else out.assign(dims.begin(),dims.end());
+        return out;
+    }
+
     template <typename NT, typename dimtype>
-    matrix::matrix(const std::string &name, NT start, NT end, const std::vector<dimtype> &dims)
+    matrix::matrix(const std::string &name, NT start, NT end, const std::vector<dimtype> &dims,
+        array_order order)
     :
         element(name,start,end),
         _class(get_class(*start)),
-        _dims(dims.empty() 
-            ? std::vector<dim_t>{1ull,(dim_t)(end-start)}
-            : std::vector<dim_t>(dims.begin(),dims.end())),
-        _logical(false),
-        _complex(false)
+        _dims(make_dims(dims,(dim_t)std::distance(start,end))),
+        _logical(std::is_same<typename std::decay<decltype(*start)>::type,bool>::value),
+        _complex(is_complex<typename std::decay<decltype(*start)>::type>::value)
     {
-        dimtype prod = 1;
+        dim_t prod = 1;
         for (auto d : _dims) prod *= d;
-        if (prod != end-start)
+        if (prod != (dim_t)std::distance(start,end))
             throw mfile_error("Matrix dimensions must be commensurate with number of elements.");
+        this->order(order);
     }
 
     template <typename T, typename dimtype>
-    matrix::matrix(const std::string &name, T *data, dim_t numel, const std::vector<dimtype> &dims)
+    matrix::matrix(const std::string &name, T *data, dim_t numel, const std::vector<dimtype> &dims,
+        array_order order)
     :
-        matrix(name,data,data+numel,dims)
+        matrix(name,data,data+numel,dims,order)
     {}
 
     template <typename T, typename dimtype>
     matrix::matrix(const std::string &name, std::initializer_list<T> data,
-        const std::vector<dimtype> &dims)
+        const std::vector<dimtype> &dims, array_order order)
+    :
+        matrix(name,data.begin(),data.end(),dims,order)
+    {}
+
+    template <typename T>
+    matrix::matrix(const std::string &name, const view<T> &v)
     :
-        matrix(name,data.begin(),data.end(),dims)
+        matrix(name,std::make_shared<view_source>(v),v.dims())
     {}
 
 }
@@ -41,19 +41,43 @@ namespace mat
 
         template <typename NT, typename dimtype=dim_t>
 		mstruct &add(const std::string &name, NT start, NT end,
-            const std::vector<dimtype> &dims = {});
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
 
         template <typename T, typename dimtype=dim_t>
 		mstruct &add(const std::string &name, T *data, dim_t numel,
-            const std::vector<dimtype> &dims = {});
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
 
         template <typename T, typename dimtype=dim_t>
 		mstruct &add(const std::string &name, std::initializer_list<T> data,
-            const std::vector<dimtype> &dims = {});
+            const std::vector<dimtype> &dims = {}, array_order order = column_major);
+
+        template <typename T>
+        mstruct &add(const std::string &name, const view<T> &v);
 
         mstruct &add(const std::string &name, const std::string &str) override;
         mstruct &add(const std::string &name, const std::u16string &str) override;
         mstruct &add(const std::string &name, const std::u32string &str) override;
+        mstruct &add(const std::string &name, const std::vector<std::string> &strs) override;
+        mstruct &add(const std::string &name, const std::vector<bool> &mask,
+            const std::vector<dim_t> &dims = {}) override;
+        mstruct &add(const std::string &name, const bitmask &mask,
+            const std::vector<dim_t> &dims = {}) override;
+        mstruct &add(const std::string &name, std::shared_ptr<source> src,
+            const std::vector<dim_t> &dims = {}) override;
+        mstruct &add(const std::string &name,
+            const std::vector<std::chrono::system_clock::time_point> &t,
+            const std::vector<dim_t> &dims = {}) override;
+        mstruct &add(const std::string &name,
+            std::vector<std::chrono::system_clock::time_point> &&t,
+            const std::vector<dim_t> &dims = {}) = delete;
+        mstruct &add_time(const std::string &name, time_epoch epoch, const double *t,
+            dim_t numel, const std::vector<dim_t> &dims = {}) override;
+        mstruct &add_time(const std::string &name, time_epoch epoch, const long long *t,
+            dim_t numel, const std::vector<dim_t> &dims = {}) override;
+        mstruct &add_time(const std::string &name, time_epoch epoch, const long *t,
+            dim_t numel, const std::vector<dim_t> &dims = {}) override;
+        mstruct &add_half(const std::string &name, half_format format, const uint16_t *data,
+            dim_t numel, const std::vector<dim_t> &dims = {}) override;
 
         /*
          * void mat::mstruct::write(std::ostream& out, file_version v)
@@ -75,20 +99,29 @@ namespace mat
     }
 
     template<typename NT, typename dimtype>
-    mstruct &mstruct::add(const std::string &name, NT start, NT end, const std::vector<dimtype> &dims) {
-        container::add<NT,dimtype>(name,start,end,dims);
+    mstruct &mstruct::add(const std::string &name, NT start, NT end, const std::vector<dimtype> &dims,
+        array_order order) {
+        container::add<NT,dimtype>(name,start,end,dims,order);
         return *this;
     }
 
     template<typename T, typename dimtype>
-    mstruct &mstruct::add(const std::string &name, T *data, dim_t numel, const std::vector<dimtype> &dims) {
-        container::add<T,dimtype>(name,data,numel,dims);
+    mstruct &mstruct::add(const std::string &name, T *data, dim_t numel, const std::vector<dimtype> &dims,
+        array_order order) {
+        container::add<T,dimtype>(name,data,numel,dims,order);
         return *this;
     }
 
     template<typename T, typename dimtype>
-    mstruct &mstruct::add(const std::string &name, std::initializer_list<T> data, const std::vector<dimtype> &dims) {
-        container::add<T,dimtype>(name,data,dims);
+    mstruct &mstruct::add(const std::string &name, std::initializer_list<T> data, const std::vector<dimtype> &dims,
+        array_order order) {
+        container::add<T,dimtype>(name,data,dims,order);
+        return *this;
+    }
+
+    template<typename T>
+    mstruct &mstruct::add(const std::string &name, const view<T> &v) {
+        container::add<T>(name,v);
         return *this;
     }
 
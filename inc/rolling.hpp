@@ -0,0 +1,406 @@
+/*
+ * 2mat/rolling.hpp -- mat::rolling class definition for splitting output across several .mat files
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_ROLLING_H
+#define TOO_MAT_ROLLING_H
+
+#include "file.hpp"
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mat
+{
+
+    /*
+     * mat::rolling_options
+     * 
+     * Settings for splitting output across several files (see mat::rolling).
+     * 
+     *  max_bytes   the most bytes (as measured by element::size) a file may hold before the next
+     *              element starts a new one, or 0 for no limit. A single element larger than this
+     *              still gets a file to itself.
+     *  max_time    how long after its first element a file may keep accepting new ones, or 0 for
+     *              no limit. This is checked as elements are added, so a file is not closed while
+     *              nothing is being added to it.
+     *  digits      the number of digits the file number is padded to
+     *  first       the number of the first file
+     *  async       whether each file is written in the background as elements are added (see
+     *              mat::file::async), rather than being held in memory until the file is closed
+     *  writer      the settings of the background writer, if async is set
+     *  on_close    called with the path of each file once it has been written and closed, on the
+     *              thread that closed it
+     */
+    struct rolling_options
+    {
+        dim_t max_bytes = 0;
+        std::chrono::steady_clock::duration max_time{0};
+        unsigned int digits = 4;
+        unsigned int first = 1;
+        bool async = false;
+        async_options writer;
+        std::function<void(const std::string &)> on_close;
+    };
+
+    /*
+     *  mat::rolling
+     * 
+     * Writes a sequence of .mat files (base_0001.mat, base_0002.mat, ...), starting a new one
+     * whenever the current file reaches the size or time limit in its options. Elements are added
+     * exactly as for a mat::file; each goes into the current file. Files are closed (and, unless
+     * async is set, written) on background threads, so adding can carry on while the previous
+     * file is being finished.
+     * 
+     * Several threads may add at once: the lock that picks the current file is released before
+     * the element is handed to it, so a thread held up by a file's background writer does not
+     * stop the others from choosing a file.
+     * 
+     * Variables marked with carry() are written into every file: the latest value of each is
+     * added to the start of each new file, as well as to the file that is current when it is
+     * added, unless that file holds it already (a file can't hold two variables of the same
+     * name), in which case the new value is used from the next file on. Carried elements are
+     * shared between files, and may be written by two files at once.
+     * 
+     * TEMPLATE
+     *  V   the version of the files to write
+     * 
+     */
+    template <file_version V=V7>
+    class rolling : public container
+    {
+        rolling_options _opts;
+        std::string _head;
+
+        std::mutex _mutex;
+        bool _open = true;
+        unsigned int _index;
+        // A file being written, and a lock shared by every add still handing an element to it, so
+        // that the file is only closed once they have finished
+        struct shard
+        {
+            file<V> out;
+            std::shared_mutex busy;
+
+            shard(const std::string &path, const std::string &head) : out(path,head) {}
+        };
+
+        std::shared_ptr<shard> _shard;
+        dim_t _bytes = 0;
+        bool _empty = true;
+        std::chrono::steady_clock::time_point _started;
+
+        compress_options _zopts;
+        std::map<std::string, compress_options> _zvars;
+
+        std::set<std::string> _carry;
+        std::map<std::string, std::shared_ptr<element>> _carried;
+        // The carried variables the current file already holds
+        std::set<std::string> _held;
+
+        // Files still being closed, and the first error from any file that has finished
+        std::vector<std::shared_future<void>> _closing;
+        std::exception_ptr _error;
+        std::shared_future<void> _closed;
+
+        void append(std::shared_ptr<element> child) override;
+
+        // Opens the next file and adds the carried variables to it
+        void open_shard();
+        // Hands the current file to a background thread to be closed
+        void close_shard();
+
+        inline void write(fwriter&, file_version, bool) override
+        {
+            throw mfile_error("Cannot write rolling file object");
+        };
+
+        [[nodiscard]] inline dim_t size(bool) const override
+        {
+            throw mfile_error("Cannot get size of rolling file object");
+        };
+
+    public:
+        /*
+         * mat::rolling::rolling(std::string, const rolling_options &, std::string)
+         * 
+         * Creates a rolling writer whose files are named after base. No file is created until the
+         * first element is added.
+         * 
+         * INPUT:
+         *  base (std::string) the path of the files, without the number or extension
+         *  opts (const rolling_options &) when to start new files, and how to write them
+         *  head (std::string) the header written to each file
+         */
+        explicit rolling(std::string base, const rolling_options &opts = {},
+            std::string head = "Created using 2mat");
+        ~rolling() override;
+
+        /*
+         * void mat::rolling::carry(const std::string &)
+         * 
+         * Marks the named variable as metadata to be written into every file. This must be called
+         * before the variable is added; if it is added again later, the new value is used from
+         * then on.
+         * 
+         * INPUT:
+         *  name (const std::string &) the name of the variable to carry
+         */
+        void carry(const std::string &name);
+
+        /*
+         * void mat::rolling::compression(const compress_options &)
+         * void mat::rolling::compression(const std::string &, const compress_options &)
+         * 
+         * Sets how variables are compressed in every file, as for mat::file::compression: the
+         * settings apply to the variables added from then on, in the current file and the files
+         * after it.
+         * 
+         * INPUT:
+         *  name (const std::string &) the name of the variable
+         *  opts (const compress_options &) the compression settings
+         */
+        void compression(const compress_options &opts);
+        void compression(const std::string &name, const compress_options &opts);
+
+        /*
+         * std::string mat::rolling::path(unsigned int) const
+         * 
+         * Returns the path of the file with the specified number.
+         * 
+         * INPUT:
+         *  index (unsigned int) the number of the file
+         * RETURNS:
+         *  The path of the file
+         */
+        [[nodiscard]] std::string path(unsigned int index) const;
+
+        /*
+         * void mat::rolling::rotate()
+         * 
+         * Closes the current file now, regardless of the limits; the next element added starts a
+         * new file.
+         */
+        void rotate();
+
+        /*
+         * std::shared_future<void> mat::rolling::close()
+         * 
+         * Closes the current file. After this, nothing more can be added. The returned future
+         * becomes ready once every file has been written and closed, and holds the first error
+         * that occurred while writing any of them.
+         * 
+         * RETURNS:
+         *  A future that is ready once every file has been written and closed
+         */
+        std::shared_future<void> close();
+    };
+
+    template <file_version V>
+    rolling<V>::rolling(std::string base, const rolling_options &opts, std::string head)
+    :
+        container(base),
+        _opts(opts),
+        _head(std::move(head)),
+        _index(opts.first)
+    {}
+
+    template <file_version V>
+    rolling<V>::~rolling()
+    {
+        // As for mat::file, call close() and check the future to see errors
+        try
+        {
+            close().wait();
+        } catch (...) {}
+    }
+
+    template <file_version V>
+    std::string rolling<V>::path(unsigned int index) const
+    {
+        std::string num = std::to_string(index);
+        if (num.size() < _opts.digits) num.insert(0, _opts.digits - num.size(), '0');
+        return _name + "_" + num + ".mat";
+    }
+
+    template <file_version V>
+    void rolling<V>::carry(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _carry.insert(name);
+    }
+
+    template <file_version V>
+    void rolling<V>::compression(const compress_options &opts)
+    {
+        check_compression(opts);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _zopts = opts;
+        if (_shard) _shard->out.compression(opts);
+    }
+
+    template <file_version V>
+    void rolling<V>::compression(const std::string &name, const compress_options &opts)
+    {
+        check_compression(opts);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _zvars[name] = opts;
+        if (_shard) _shard->out.compression(name,opts);
+    }
+
+    template <file_version V>
+    void rolling<V>::open_shard()
+    {
+        _shard = std::make_shared<shard>(path(_index++),_head);
+        _shard->out.compression(_zopts);
+        for (auto &z : _zvars) _shard->out.compression(z.first,z.second);
+        if (_opts.async) _shard->out.async(_opts.writer);
+        _bytes = 0;
+        _empty = true;
+        _started = std::chrono::steady_clock::now();
+        _held.clear();
+        for (auto &c : _carried)
+        {
+            _bytes += c.second->size(true);
+            _shard->out.append(c.second);
+            _held.insert(c.first);
+        }
+    }
+
+    template <file_version V>
+    void rolling<V>::close_shard()
+    {
+        if (!_shard) return;
+        std::shared_ptr<shard> last(std::move(_shard));
+        auto done = _opts.on_close;
+        _closing.push_back(std::async(std::launch::async, [last, done] {
+            {
+                // Waits for the adds still handing elements to the file
+                std::unique_lock<std::shared_mutex> wait(last->busy);
+            }
+            last->out.close().get();
+            if (done) done(last->out.name());
+        }).share());
+
+        // Forget the files that have finished, keeping the first error
+        auto ready = [](const std::shared_future<void> &f) {
+            return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        };
+        for (auto it = _closing.begin(); it != _closing.end();)
+        {
+            if (!ready(*it))
+            {
+                ++it;
+                continue;
+            }
+            try
+            {
+                it->get();
+            } catch (...) {
+                if (!_error) _error = std::current_exception();
+            }
+            it = _closing.erase(it);
+        }
+    }
+
+    template <file_version V>
+    void rolling<V>::append(std::shared_ptr<element> child)
+    {
+        // Measured before taking the lock, as this may be slow for large structs
+        dim_t bytes = child->size(true);
+
+        std::shared_ptr<shard> target;
+        std::shared_lock<std::shared_mutex> adding;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_open) throw mfile_error("Cannot add to a closed file");
+
+            if (_shard && !_empty)
+            {
+                bool full = _opts.max_bytes && _bytes + bytes > _opts.max_bytes;
+                bool old = _opts.max_time.count() &&
+                    std::chrono::steady_clock::now() - _started >= _opts.max_time;
+                if (full || old) close_shard();
+            }
+            bool carried = _carry.count(child->name());
+            if (carried) _carried[child->name()] = child;
+            if (!_shard)
+            {
+                // A new file starts with the carried variables, which now include this one
+                open_shard();
+                if (carried) return;
+            }
+            // A carried variable the file already holds is only updated for the files to come
+            if (carried && !_held.insert(child->name()).second) return;
+
+            target = _shard;
+            adding = std::shared_lock<std::shared_mutex>(target->busy);
+            _bytes += bytes;
+            if (!carried) _empty = false;
+        }
+        // This may block until the file's background writer catches up, so it is done without the
+        // lock; the file is not closed until it returns
+        target->out.append(std::move(child));
+    }
+
+    template <file_version V>
+    void rolling<V>::rotate()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        close_shard();
+    }
+
+    template <file_version V>
+    std::shared_future<void> rolling<V>::close()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_open) return _closed;
+        _open = false;
+        close_shard();
+
+        auto closing = std::move(_closing);
+        auto error = _error;
+        _closed = std::async(std::launch::async, [closing, error] {
+            auto first = error;
+            for (auto &f : closing)
+            {
+                try
+                {
+                    f.get();
+                } catch (...) {
+                    if (!first) first = std::current_exception();
+                }
+            }
+            if (first) std::rethrow_exception(first);
+        }).share();
+        return _closed;
+    }
+
+}
+
+#endif
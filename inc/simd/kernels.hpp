@@ -0,0 +1,192 @@
+/*
+ * 2mat/simd/kernels.hpp -- vectorised conversion kernels used while writing data
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_SIMD_KERNELS_H
+#define TOO_MAT_SIMD_KERNELS_H
+
+#include "../types.hpp"
+
+#include <cstddef>
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        /*
+         * void mat::simd::extract_plane(const float *, float *, dim_t, unsigned int)
+         * 
+         * Copies one component of each value in an array of interleaved complex numbers (i.e.,
+         * the layout of std::complex<float>) into a contiguous array. Lane 0 selects the real
+         * parts, lane 1 the imaginary parts.
+         * 
+         * INPUT:
+         *  src (const float *) the interleaved complex data (2*n floats)
+         *  dst (float *) the output array (n floats)
+         *  n (dim_t) the number of complex values to read
+         *  lane (unsigned int) 0 for the real plane, 1 for the imaginary plane
+         */
+        void extract_plane(const float *src, float *dst, dim_t n, unsigned int lane);
+
+        /*
+         * void mat::simd::extract_plane(const double *, double *, dim_t, unsigned int)
+         * 
+         * As above, for the layout of std::complex<double>.
+         */
+        void extract_plane(const double *src, double *dst, dim_t n, unsigned int lane);
+
+        /*
+         * void mat::simd::expand_bits(const uint64_t *, unsigned char *, dim_t)
+         * 
+         * Expands a bit-packed mask (least significant bit first) to one byte per bit, each of
+         * which is 0 or 1.
+         * 
+         * INPUT:
+         *  words (const uint64_t *) the packed mask
+         *  dst (unsigned char *) the output array (n bytes)
+         *  n (dim_t) the number of bits to expand
+         */
+        void expand_bits(const uint64_t *words, unsigned char *dst, dim_t n);
+
+        /*
+         * void mat::simd::divide_add(const double *, double *, dim_t, double, double)
+         * 
+         * Calculates dst[i] = a + src[i]/d. The operations are performed in the same order as the
+         * scalar expression, so the results are bit-for-bit identical to it. src and dst may be
+         * the same array.
+         * 
+         * INPUT:
+         *  src (const double *) the input array (n values)
+         *  dst (double *) the output array (n values)
+         *  n (dim_t) the number of values to convert
+         *  d (double) the divisor
+         *  a (double) the value to add to each quotient
+         */
+        void divide_add(const double *src, double *dst, dim_t n, double d, double a);
+
+        /*
+         * void mat::simd::add_subtract(const double *, double *, dim_t, double, double)
+         * 
+         * Calculates dst[i] = (src[i] + a) - b, bit-for-bit identical to the scalar expression.
+         * src and dst may be the same array.
+         * 
+         * INPUT:
+         *  src (const double *) the input array (n values)
+         *  dst (double *) the output array (n values)
+         *  n (dim_t) the number of values to convert
+         *  a (double) the value to add
+         *  b (double) the value to subtract
+         */
+        void add_subtract(const double *src, double *dst, dim_t n, double a, double b);
+
+        /*
+         * void mat::simd::transpose(const unsigned char *, dim_t, unsigned char *, dim_t, dim_t,
+         *     dim_t, unsigned int)
+         * 
+         * Transposes a block of rows x cols values, each of width bytes: value (i,j) of src
+         * becomes value (j,i) of dst. The block is copied a tile at a time, with SIMD kernels for
+         * values of 1, 2, 4 and 8 bytes, so both the rows read and the rows written stay in
+         * cache.
+         * 
+         * INPUT:
+         *  src (const unsigned char *) the first value of the block
+         *  sstride (dim_t) the number of values from one row of src to the next
+         *  dst (unsigned char *) where to write the first value of the transposed block
+         *  dstride (dim_t) the number of values from one row of dst to the next
+         *  rows (dim_t) the number of rows of src
+         *  cols (dim_t) the number of columns of src
+         *  width (unsigned int) the size of each value: 1, 2, 4, 8 or 16 bytes
+         */
+        void transpose(const unsigned char *src, dim_t sstride, unsigned char *dst, dim_t dstride,
+            dim_t rows, dim_t cols, unsigned int width);
+
+        /*
+         * void mat::simd::gather(const unsigned char *, std::ptrdiff_t, unsigned char *, dim_t,
+         *     unsigned int)
+         * 
+         * Copies n values of width bytes, spaced stride values apart, into a contiguous array:
+         * value i of dst is the value at src + i*stride*width. stride may be negative. Values of
+         * 4 and 8 bytes are gathered with AVX2 where available.
+         * 
+         * INPUT:
+         *  src (const unsigned char *) the first value to copy
+         *  stride (std::ptrdiff_t) the number of values from one value to copy to the next
+         *  dst (unsigned char *) the output array (n values)
+         *  n (dim_t) the number of values to copy
+         *  width (unsigned int) the size of each value: 1, 2, 4, 8 or 16 bytes
+         */
+        void gather(const unsigned char *src, std::ptrdiff_t stride, unsigned char *dst, dim_t n,
+            unsigned int width);
+
+        /*
+         * dim_t mat::simd::utf16_length(const char *, dim_t)
+         * 
+         * Validates a UTF-8 string, skipping runs of ASCII 16 bytes at a time, and counts the
+         * UTF-16 code units needed to hold it (two for each character beyond U+FFFF). Throws
+         * mfile_error if the string is not valid UTF-8.
+         * 
+         * INPUT:
+         *  src (const char *) the string
+         *  n (dim_t) the length of the string, in bytes
+         * RETURNS:
+         *  the length of the string in UTF-16, which is n only if the string is ASCII
+         */
+        dim_t utf16_length(const char *src, dim_t n);
+
+        /*
+         * dim_t mat::simd::utf8_to_utf16(const char *, dim_t, char16_t *)
+         * 
+         * Transcodes a UTF-8 string to UTF-16, widening runs of ASCII 16 bytes at a time. The
+         * string is validated as it is read, as for utf16_length.
+         * 
+         * INPUT:
+         *  src (const char *) the string
+         *  n (dim_t) the length of the string, in bytes
+         *  dst (char16_t *) the output array, with space for utf16_length(src, n) code units
+         * RETURNS:
+         *  the number of code units written
+         */
+        dim_t utf8_to_utf16(const char *src, dim_t n, char16_t *dst);
+
+        /*
+         * void mat::simd::widen_half(const uint16_t *, float *, dim_t)
+         * 
+         * Converts IEEE binary16 values (given by their bits) to single precision, exactly, with
+         * F16C or AVX-512 where available.
+         * 
+         * INPUT:
+         *  src (const uint16_t *) the input array (n values)
+         *  dst (float *) the output array (n values)
+         *  n (dim_t) the number of values to convert
+         */
+        void widen_half(const uint16_t *src, float *dst, dim_t n);
+
+        /*
+         * void mat::simd::widen_bfloat16(const uint16_t *, float *, dim_t)
+         * 
+         * As above, for bfloat16 values.
+         */
+        void widen_bfloat16(const uint16_t *src, float *dst, dim_t n);
+
+    }
+
+}
+
+#endif
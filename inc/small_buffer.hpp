@@ -0,0 +1,98 @@
+/*
+ * 2mat/small_buffer.hpp -- byte buffer that stores small amounts of data inline
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_SMALL_BUFFER_H
+#define TOO_MAT_SMALL_BUFFER_H
+
+#include "arena.hpp"
+#include "types.hpp"
+
+#include <cstring>
+#include <memory>
+
+// Buffers of up to this many bytes are stored inline, without allocating. This covers scalars of
+// every type (including complex doubles) and short vectors and strings.
+#ifndef MAT_INLINE
+#define MAT_INLINE 32
+#endif
+
+namespace mat
+{
+
+    /*
+     *  mat::small_buffer
+     *
+     * A zero-initialised, fixed-size byte buffer holding the data of an element. Buffers of up to
+     * MAT_INLINE bytes are stored inside the object itself; larger buffers are allocated from the
+     * current arena (see mat::arena), or on the heap if there is none, and are shared between
+     * copies, as elements are copied into their container when added.
+     *
+     */
+    class small_buffer
+    {
+        dim_t _size = 0;
+        std::shared_ptr<unsigned char> _heap;
+        alignas(8) unsigned char _inline[MAT_INLINE] = {};
+
+    public:
+        small_buffer() = default;
+
+        /*
+         * mat::small_buffer::small_buffer(dim_t)
+         *
+         * Constructs a zero-filled buffer of n bytes.
+         *
+         * INPUT:
+         *  n (dim_t) the size of the buffer, in bytes
+         */
+        explicit small_buffer(dim_t n)
+        :
+            _size(n)
+        {
+            if (n <= MAT_INLINE) return;
+            if (arena *a = arena::current())
+            {
+                // The arena frees the buffer itself; the control block keeps the arena alive
+                auto p = static_cast<unsigned char *>(a->allocate(n,alignof(dim_t)));
+                std::memset(p,0,n);
+                _heap = std::shared_ptr<unsigned char>(p,[](unsigned char *) {},
+                    arena_allocator<unsigned char>(a->shared_from_this()));
+            } else {
+                _heap = std::shared_ptr<unsigned char>(new unsigned char[n](),
+                    std::default_delete<unsigned char[]>());
+            }
+        }
+
+        [[nodiscard]] unsigned char *data()
+        {
+            return _heap ? _heap.get() : _inline;
+        }
+
+        [[nodiscard]] const unsigned char *data() const
+        {
+            return _heap ? _heap.get() : _inline;
+        }
+
+        [[nodiscard]] dim_t size() const { return _size; }
+        [[nodiscard]] bool empty() const { return !_size; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * 2mat/source.hpp -- interface for producing matrix data while it is being written
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_SOURCE_H
+#define TOO_MAT_SOURCE_H
+
+#include "types.hpp"
+
+namespace mat
+{
+
+    /*
+     *  mat::source
+     * 
+     * A producer of the data of a matrix. Normally a matrix holds a copy of its data; a matrix
+     * constructed from a source instead asks the source for its data a chunk at a time as it is
+     * written, so the full array never needs to exist in memory. The type and number of elements
+     * must be known up front, so that the size of the matrix can be calculated before writing.
+     * 
+     * Each time the matrix is written, the data is read in order from the first element to the
+     * last, in chunks of at most MAT_SCHUNK bytes.
+     * 
+     */
+    class source
+    {
+    public:
+        virtual ~source() = default;
+
+        /*
+         * datatype mat::source::type() const
+         * 
+         * Returns the MATLAB datatype of the data produced by this source
+         */
+        [[nodiscard]] virtual datatype type() const = 0;
+
+        /*
+         * array_class mat::source::mclass() const
+         * 
+         * Returns the MATLAB class of a matrix holding the data produced by this source
+         */
+        [[nodiscard]] virtual array_class mclass() const = 0;
+
+        /*
+         * dim_t mat::source::numel() const
+         * 
+         * Returns the number of elements produced by this source
+         */
+        [[nodiscard]] virtual dim_t numel() const = 0;
+
+        /*
+         * void mat::source::read(dim_t, dim_t, void *)
+         * 
+         * Produces n elements of data, starting from element first, into the passed buffer.
+         * 
+         * INPUT:
+         *  first (dim_t) the index of the first element to produce
+         *  n (dim_t) the number of elements to produce
+         *  buf (void *) the buffer to produce the elements into, with space for n elements
+         */
+        virtual void read(dim_t first, dim_t n, void *buf) = 0;
+
+        /*
+         * const void *mat::source::contiguous() const
+         * 
+         * Returns a pointer to all of the data, already in the order it is written, if the source
+         * has it in memory; the matrix is then written straight from it, without calling read.
+         * Returns NULL otherwise (the default).
+         */
+        [[nodiscard]] virtual const void *contiguous() const { return nullptr; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * 2mat/trace.hpp -- span tracing of the write path, exported as Chrome trace events
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_TRACE_H
+#define TOO_MAT_TRACE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Spans are only recorded when the library is built with MAT_TRACE defined (the MAT_TRACE CMake
+// option); otherwise MAT_TRACE_SPAN expands to nothing, and dump() writes an empty trace
+#ifdef MAT_TRACE
+#define MAT_TRACE_JOIN2(a,b) a##b
+#define MAT_TRACE_JOIN(a,b) MAT_TRACE_JOIN2(a,b)
+#define MAT_TRACE_SPAN(name) mat::trace::span MAT_TRACE_JOIN(_mat_trace_,__LINE__)(name)
+#else
+#define MAT_TRACE_SPAN(name) ((void)0)
+#endif
+
+// Number of spans in each block of a thread's buffer, and the most blocks a thread may fill;
+// spans recorded after that are dropped, unless clear() has been called since, in which case the
+// room taken by the spans before it is used again
+#ifndef MAT_TRACE_CHUNK
+#define MAT_TRACE_CHUNK 4096
+#endif
+
+#ifndef MAT_TRACE_CHUNKS
+#define MAT_TRACE_CHUNKS 256
+#endif
+
+namespace mat
+{
+
+    namespace trace
+    {
+
+        /*
+         * uint64_t mat::trace::now()
+         * 
+         * Returns the time, in nanoseconds since tracing started, used to time spans
+         */
+        uint64_t now();
+
+        /*
+         * void mat::trace::record(const char *, uint64_t, uint64_t)
+         * 
+         * Records a span in the calling thread's buffer. Each thread has its own buffer, so only
+         * a thread's first span takes a lock; the name must be a string literal (or otherwise
+         * outlive the trace).
+         * 
+         * INPUT:
+         *  name (const char *) the name of the span
+         *  start (uint64_t) when the span started (see now())
+         *  end (uint64_t) when the span ended
+         */
+        void record(const char *name, uint64_t start, uint64_t end);
+
+        /*
+         * void mat::trace::dump(std::ostream &)
+         * bool mat::trace::dump(const std::string &)
+         * 
+         * Writes every span recorded so far (since the last clear()) as Chrome trace-event JSON,
+         * which can be opened in Perfetto or chrome://tracing. Spans still being recorded on
+         * other threads are included once they have finished.
+         * 
+         * INPUT:
+         *  out (std::ostream &) the stream to write to
+         *  path (const std::string &) the file to write to
+         * RETURNS:
+         *  whether the file could be written
+         */
+        void dump(std::ostream &out);
+        bool dump(const std::string &path);
+
+        /*
+         * void mat::trace::clear()
+         * 
+         * Leaves out of later dumps every span that started before now. The buffers of threads
+         * that have exited are released; a running thread reuses the room taken by the spans it
+         * recorded before now once its buffer is full.
+         */
+        void clear();
+
+        /*
+         *  mat::trace::span
+         * 
+         * Records a span from its construction to its destruction; use MAT_TRACE_SPAN so that
+         * spans compile out when tracing is disabled.
+         */
+        class span
+        {
+            const char *_name;
+            uint64_t _start;
+        public:
+            explicit span(const char *name)
+            :
+                _name(name),
+                _start(now())
+            {}
+
+            ~span()
+            {
+                record(_name,_start,now());
+            }
+
+            span(const span &) = delete;
+            span &operator=(const span &) = delete;
+        };
+
+    }
+
+}
+
+#endif
@@ -20,10 +20,12 @@
 #ifndef TOO_MAT_TYPES_H
 #define TOO_MAT_TYPES_H
 
+#include <complex>
 #include <cstdint>
+#include <iterator>
 #include <string>
-#include <typeindex>
-#include <unordered_map>
+#include <type_traits>
+#include <vector>
 
 namespace mat
 {
@@ -41,6 +43,21 @@ namespace mat
         V7_3 = 73
     };
 
+    /*
+     * mat::array_order
+     * 
+     * The order in which the elements of a multi-dimensional array are laid out in memory.
+     * MATLAB stores arrays column-major (the first index varies fastest), while C and C++ arrays,
+     * and most libraries (OpenCV, numpy by default), are row-major (the last index varies
+     * fastest).
+     * 
+     */
+    enum array_order
+    {
+        column_major,
+        row_major
+    };
+
     typedef unsigned long long dim_t;
 
 	/*
@@ -145,47 +162,77 @@ namespace mat
 		// TODO: Sort out FUNCTION and OPAQUE classes
 	};
 
-    // Map from type to datatype
-    static std::unordered_map<std::type_index,datatype> type2datatype
-    {
-        {std::type_index(typeid(int8_t)), miINT8},
-        {std::type_index(typeid(uint8_t)), miUINT8},
-        {std::type_index(typeid(int16_t)), miINT16},
-        {std::type_index(typeid(uint16_t)), miUINT16},
-        {std::type_index(typeid(int32_t)), miINT32},
-        {std::type_index(typeid(uint32_t)), miUINT32},
-        {std::type_index(typeid(float)), miSINGLE},
-        {std::type_index(typeid(double)), miDOUBLE},
-        {std::type_index(typeid(int64_t)), miINT64},
-        {std::type_index(typeid(uint64_t)), miUINT64},
-        {std::type_index(typeid(char)), miINT8},
-        {std::type_index(typeid(char16_t)), miUTF16},
-        {std::type_index(typeid(char32_t)), miUTF32},
-        {std::type_index(typeid(std::string)), miUINT8}
-    };
+	/*
+	 * mat::matlab_type<T>
+	 * 
+	 * Type trait giving the MATLAB datatype and class used to store values of type T, resolved at
+	 * compile time. Integers are mapped by their size and signedness, so every integer type of
+	 * 8 to 64 bits is supported (int64_t and long long alike). supported is false for types that
+	 * cannot be stored.
+	 */
+	template <typename T, typename = void>
+	struct matlab_type
+	{
+		static constexpr bool supported = false;
+		static constexpr datatype type = miUNKNOWN;
+		static constexpr array_class mclass = mxUNKNOWN_CLASS;
+	};
 
-    // Map from type to datatype
-    static std::unordered_map<std::type_index,array_class> type2class
-    {
-        {std::type_index(typeid(int8_t)), mxINT8_CLASS},
-        {std::type_index(typeid(uint8_t)), mxUINT8_CLASS},
-        {std::type_index(typeid(int16_t)), mxINT16_CLASS},
-        {std::type_index(typeid(uint16_t)), mxUINT16_CLASS},
-        {std::type_index(typeid(int32_t)), mxINT32_CLASS},
-        {std::type_index(typeid(uint32_t)), mxUINT32_CLASS},
-        {std::type_index(typeid(float)), mxSINGLE_CLASS},
-        {std::type_index(typeid(double)), mxDOUBLE_CLASS},
-        {std::type_index(typeid(int64_t)), mxINT64_CLASS},
-        {std::type_index(typeid(uint64_t)), mxUINT64_CLASS},
-        {std::type_index(typeid(char)), mxCHAR_CLASS},
-        {std::type_index(typeid(std::string)), mxCHAR_CLASS},
-        {std::type_index(typeid(std::wstring)), mxCHAR_CLASS}
-    };
+	template <datatype D, array_class C>
+	struct matlab_type_of
+	{
+		static constexpr bool supported = true;
+		static constexpr datatype type = D;
+		static constexpr array_class mclass = C;
+	};
+
+	template <typename T>
+	struct matlab_type<T, typename std::enable_if<std::is_integral<T>::value &&
+		!std::is_same<T,bool>::value && !std::is_same<T,char>::value &&
+		!std::is_same<T,wchar_t>::value && !std::is_same<T,char16_t>::value &&
+		!std::is_same<T,char32_t>::value>::type>
+	:
+		matlab_type_of<
+			sizeof(T) == 1 ? (std::is_signed<T>::value ? miINT8 : miUINT8) :
+			sizeof(T) == 2 ? (std::is_signed<T>::value ? miINT16 : miUINT16) :
+			sizeof(T) == 4 ? (std::is_signed<T>::value ? miINT32 : miUINT32) :
+			(std::is_signed<T>::value ? miINT64 : miUINT64),
+			sizeof(T) == 1 ? (std::is_signed<T>::value ? mxINT8_CLASS : mxUINT8_CLASS) :
+			sizeof(T) == 2 ? (std::is_signed<T>::value ? mxINT16_CLASS : mxUINT16_CLASS) :
+			sizeof(T) == 4 ? (std::is_signed<T>::value ? mxINT32_CLASS : mxUINT32_CLASS) :
+			(std::is_signed<T>::value ? mxINT64_CLASS : mxUINT64_CLASS)>
+	{
+		static_assert(sizeof(T) <= 8, "MATLAB integers are at most 64 bits");
+	};
+
+	// Logical matrices are stored as bytes, with the logical flag set on the matrix
+	template <>
+	struct matlab_type<bool> : matlab_type_of<miUINT8, mxUINT8_CLASS> {};
+	template <>
+	struct matlab_type<char> : matlab_type_of<miINT8, mxCHAR_CLASS> {};
+	template <>
+	struct matlab_type<char16_t> : matlab_type_of<miUTF16, mxCHAR_CLASS> {};
+	template <>
+	struct matlab_type<char32_t> : matlab_type_of<miUTF32, mxCHAR_CLASS> {};
+	template <>
+	struct matlab_type<float> : matlab_type_of<miSINGLE, mxSINGLE_CLASS> {};
+	template <>
+	struct matlab_type<double> : matlab_type_of<miDOUBLE, mxDOUBLE_CLASS> {};
+	template <>
+	struct matlab_type<std::string> : matlab_type_of<miUINT8, mxCHAR_CLASS> {};
+
+	// Complex values are stored with the datatype and class of their components, with the
+	// complex flag set on the matrix
+	template <>
+	struct matlab_type<std::complex<float>> : matlab_type<float> {};
+	template <>
+	struct matlab_type<std::complex<double>> : matlab_type<double> {};
 
 	/*
 	 * mat::datatype mat::get_datatype<T>()
 	 * 
-	 * Template function to return the MATLAB datatype of a variable with the templated type
+	 * Template function to return the MATLAB datatype of a variable with the templated type.
+	 * Using a type that cannot be stored is a compile error.
 	 * 
 	 * TEMPLATE:
 	 * 	The type of the variable to get the datatype for
@@ -193,26 +240,61 @@ namespace mat
 	 * 	The datatype of the template type
 	 */
 	template <typename T>
-	datatype get_datatype(T)
-    {
-        return type2datatype[std::type_index(typeid(T))];
-    }
+	constexpr datatype get_datatype(const T &)
+	{
+		static_assert(matlab_type<T>::supported, "This type cannot be stored in a MATLAB file");
+		return matlab_type<T>::type;
+	}
 
 	/*
-	 * mat::datatype mat::get_datatype<T>()
+	 * mat::array_class mat::get_class<T>()
 	 * 
-	 * Template function to return the MATLAB datatype of a variable with the templated type
+	 * Template function to return the MATLAB class of a variable with the templated type. Using
+	 * a type that cannot be stored is a compile error.
 	 * 
 	 * TEMPLATE:
-	 * 	The type of the variable to get the datatype for
+	 * 	The type of the variable to get the class for
 	 * RETURNS:
-	 * 	The datatype of the template type
+	 * 	The class of the template type
 	 */
 	template <typename T>
-	array_class get_class(T)
-    {
-        return type2class[std::type_index(typeid(T))];
-    }
+	constexpr array_class get_class(const T &)
+	{
+		static_assert(matlab_type<T>::supported, "This type cannot be stored in a MATLAB file");
+		return matlab_type<T>::mclass;
+	}
+
+	/*
+	 * mat::is_complex<T>
+	 * 
+	 * Type trait which is true for the complex types that can be stored in a matrix. Complex
+	 * values are stored with the datatype and class of their components, with the complex flag
+	 * set on the matrix.
+	 */
+	template <typename T>
+	struct is_complex : std::false_type {};
+	template <>
+	struct is_complex<std::complex<float>> : std::true_type {};
+	template <>
+	struct is_complex<std::complex<double>> : std::true_type {};
+
+	/*
+	 * mat::is_contiguous<It>
+	 * 
+	 * Type trait which is true for iterators whose values are adjacent in memory, so that the
+	 * values between two of them can be copied as a block. Without C++20 concepts this is only
+	 * known for pointers and the iterators of std::vector.
+	 */
+#if __cplusplus >= 202002L
+	template <typename It>
+	struct is_contiguous : std::bool_constant<std::contiguous_iterator<It>> {};
+#else
+	template <typename It, typename V = typename std::iterator_traits<It>::value_type>
+	struct is_contiguous : std::bool_constant<std::is_pointer<It>::value ||
+		(!std::is_same<V,bool>::value && (std::is_same<It,typename std::vector<V>::iterator>::value ||
+		std::is_same<It,typename std::vector<V>::const_iterator>::value))> {};
+#endif
+
 }
 
 #endif
\ No newline at end of file
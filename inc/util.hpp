@@ -20,6 +20,9 @@
 #ifndef TOO_MAT_UTIL_H
 #define TOO_MAT_UTIL_H
 
+#include "types.hpp"
+
+#include <functional>
 #include <stdexcept>
 
 namespace mat
@@ -44,6 +47,24 @@ namespace mat
         return (n+7)&~7;
     }
 
+    /*
+     * void mat::parallel_for(dim_t, dim_t, const std::function<void(dim_t,dim_t)> &)
+     * 
+     * Splits the range [0,n) into contiguous blocks and calls fn(begin,end) for each block, in
+     * parallel across the available hardware threads. Ranges smaller than two grains are run on
+     * the calling thread, so the overhead of starting threads is only paid for large ranges. If
+     * fn throws for any block, every block is still waited for, and the first exception thrown
+     * is rethrown on the calling thread.
+     * 
+     * INPUT:
+     *  n (dim_t) the size of the range to split
+     *  grain (dim_t) the minimum number of items given to each thread
+     *  fn (const std::function<void(dim_t,dim_t)> &) the function to call for each block
+     *  threads (unsigned int) the most threads to use, or 0 for the number of hardware threads
+     */
+    void parallel_for(dim_t n, dim_t grain, const std::function<void(dim_t,dim_t)> &fn,
+        unsigned int threads = 0);
+
     /*
      * mat::mfile_error
      * 
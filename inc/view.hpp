@@ -0,0 +1,183 @@
+/*
+ * 2mat/view.hpp -- strided views of arrays, written as matrices without copying
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_VIEW_H
+#define TOO_MAT_VIEW_H
+
+#include "source.hpp"
+#include "types.hpp"
+#include "util.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mat
+{
+
+    /*
+     *  mat::view
+     *
+     * A view of an N-dimensional array of T that belongs to someone else: a pointer to its first
+     * value, the extent of each index, and the number of values (which may be negative) from one
+     * value of each index to the next. This describes the same arrays as std::mdspan with
+     * layout_left (column-major), layout_right (row-major) or layout_stride, and any of those can
+     * be converted to a view. For instance, one channel of an interleaved h x w RGB image is
+     *
+     *  mat::view<uint8_t>(pixels + channel, {h, w}, {3*w, 3})
+     *
+     * A matrix constructed from a view reads the values as it is written, gathering them into
+     * the order MATLAB expects; the array must outlive the matrix.
+     *
+     */
+    template <typename T>
+    struct view
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T,bool>::value &&
+            matlab_type<T>::supported && matlab_type<T>::mclass != mxCHAR_CLASS,
+            "Views must be of real numeric values");
+
+        const T *data;
+        std::vector<dim_t> extents;
+        std::vector<std::ptrdiff_t> strides;
+
+        /*
+         * mat::view::view(const T *, std::vector<dim_t>, array_order)
+         *
+         * Views a contiguous array, laid out in the given order.
+         */
+        view(const T *data, std::vector<dim_t> extents, array_order order = column_major)
+        :
+            data(data),
+            extents(std::move(extents)),
+            strides(this->extents.size())
+        {
+            std::ptrdiff_t step = 1;
+            for (dim_t i = 0; i < strides.size(); ++i)
+            {
+                dim_t r = order == column_major ? i : strides.size()-1-i;
+                strides[r] = step;
+                step *= (std::ptrdiff_t)this->extents[r];
+            }
+        }
+
+        /*
+         * mat::view::view(const T *, std::vector<dim_t>, std::vector<std::ptrdiff_t>)
+         *
+         * Views an array with the given distance between values of each index.
+         */
+        view(const T *data, std::vector<dim_t> extents, std::vector<std::ptrdiff_t> strides)
+        :
+            data(data),
+            extents(std::move(extents)),
+            strides(std::move(strides))
+        {
+            if (this->extents.size() != this->strides.size())
+                throw mfile_error("A view needs a stride for each extent.");
+        }
+
+        /*
+         * mat::view::view(const M &)
+         *
+         * Views the array of a std::mdspan (or anything else with the same data_handle(), rank(),
+         * extent() and stride() members, such as the reference implementation of mdspan).
+         */
+        template <typename M, typename = decltype(std::declval<const M &>().data_handle(),
+            std::declval<const M &>().stride(0), std::declval<const M &>().extent(0))>
+        view(const M &m)
+        :
+            data(m.data_handle()),
+            extents(m.rank()),
+            strides(m.rank())
+        {
+            for (dim_t r = 0; r < (dim_t)m.rank(); ++r)
+            {
+                extents[r] = m.extent(r);
+                strides[r] = m.stride(r);
+            }
+        }
+
+        [[nodiscard]] dim_t numel() const
+        {
+            dim_t n = 1;
+            for (auto e : extents) n *= e;
+            return n;
+        }
+
+        // The dimensions of a matrix of the view: its extents, 1 x n for a single index, or 1 x 1
+        // for none
+        [[nodiscard]] std::vector<dim_t> dims() const
+        {
+            std::vector<dim_t> out(extents);
+            while (out.size() < 2) out.insert(out.begin(), 1);
+            return out;
+        }
+    };
+
+    template <typename M>
+    view(const M &) -> view<typename std::remove_const<typename M::element_type>::type>;
+
+    /*
+     *  mat::view_source
+     *
+     * The source of a matrix constructed from a mat::view. The values are gathered a run (of
+     * the first index) at a time. A view that is already column-major and contiguous is written
+     * straight from the array.
+     *
+     */
+    class view_source : public source
+    {
+        const unsigned char *base;
+        unsigned int width;
+        datatype _type;
+        array_class _class;
+        std::vector<dim_t> _dims;
+        std::vector<std::ptrdiff_t> strides;
+        dim_t _numel;
+
+        void init();
+    public:
+        template <typename T>
+        explicit view_source(const view<T> &v);
+
+        [[nodiscard]] datatype type() const override { return _type; }
+        [[nodiscard]] array_class mclass() const override { return _class; }
+        [[nodiscard]] dim_t numel() const override { return _numel; }
+        void read(dim_t first, dim_t n, void *buf) override;
+        [[nodiscard]] const void *contiguous() const override;
+    };
+
+    template <typename T>
+    view_source::view_source(const view<T> &v)
+    :
+        base((const unsigned char *)v.data),
+        width(sizeof(T)),
+        _type(matlab_type<T>::type),
+        _class(matlab_type<T>::mclass),
+        _dims(v.dims()),
+        strides(v.strides),
+        _numel(v.numel())
+    {
+        init();
+    }
+
+}
+
+#endif
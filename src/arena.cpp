@@ -0,0 +1,116 @@
+/*
+ * 2mat/arena.cpp -- class implementation for arena.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace mat
+{
+
+    namespace
+    {
+        thread_local arena *current_arena = nullptr;
+    }
+
+    arena::arena(dim_t block)
+    :
+        _next(std::max<dim_t>(block,64))
+    {}
+
+    arena::~arena()
+    {
+        block *b = _head.load();
+        while (b)
+        {
+            block *prev = b->prev;
+            b->~block();
+            ::operator delete(b);
+            b = prev;
+        }
+    }
+
+    void arena::grow(block *full, dim_t min)
+    {
+        std::lock_guard<std::mutex> lock(_grow);
+        if (_head.load(std::memory_order_acquire) != full) return;
+        dim_t capacity = std::max(_next,min);
+        auto b = new (::operator new(sizeof(block)+capacity)) block;
+        b->prev = full;
+        b->capacity = capacity;
+        _head.store(b, std::memory_order_release);
+        _next = capacity*2;
+    }
+
+    void *arena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        for (;;)
+        {
+            block *b = _head.load(std::memory_order_acquire);
+            if (b)
+            {
+                auto base = reinterpret_cast<uintptr_t>(b->data());
+                dim_t used = b->used.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    dim_t start = ((base+used+alignment-1) & ~(uintptr_t)(alignment-1)) - base;
+                    if (start+bytes > b->capacity) break;
+                    if (b->used.compare_exchange_weak(used, start+bytes, std::memory_order_relaxed))
+                        return b->data() + start;
+                }
+            }
+            grow(b, bytes+alignment);
+        }
+    }
+
+    dim_t arena::allocated()
+    {
+        dim_t total = 0;
+        for (block *b = _head.load(std::memory_order_acquire); b; b = b->prev)
+            total += std::min(b->used.load(std::memory_order_relaxed), b->capacity);
+        return total;
+    }
+
+    arena *arena::current()
+    {
+        return current_arena;
+    }
+
+    std::pmr::memory_resource *arena::resource()
+    {
+        return current_arena ? current_arena : std::pmr::get_default_resource();
+    }
+
+    arena::scope::scope(std::shared_ptr<arena> a)
+    :
+        _arena(std::move(a)),
+        _prev(current_arena)
+    {
+        current_arena = _arena.get();
+    }
+
+    arena::scope::~scope()
+    {
+        current_arena = _prev;
+    }
+
+}
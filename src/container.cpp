@@ -18,6 +18,7 @@
  */
 
 #include "container.hpp"
+#include "trace.hpp"
 
 namespace mat
 {
@@ -27,22 +28,101 @@ namespace mat
         element(name)
     {}
 
-    container &container::add(const std::string &name, const std::string &str)
+    container &container::memory(std::shared_ptr<arena> mem)
     {
-        _children.push_back(std::unique_ptr<element>(new matrix(name,str)));
+        _arena = std::move(mem);
         return *this;
     }
 
+    std::shared_ptr<arena> container::memory() const
+    {
+        return _arena;
+    }
+
+    void container::append(std::shared_ptr<element> child)
+    {
+        _children.push_back(std::move(child));
+    }
+
+    container &container::add(const std::string &name, const std::string &str)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,str);
+    }
+
     container &container::add(const std::string &name, const std::u16string &str)
     {
-        _children.push_back(std::unique_ptr<element>(new matrix(name,str)));
-        return *this;
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,str);
     }
 
     container &container::add(const std::string &name, const std::u32string &str)
     {
-        _children.push_back(std::unique_ptr<element>(new matrix(name,str)));
-        return *this;
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,str);
+    }
+
+    container &container::add(const std::string &name, const std::vector<std::string> &strs)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,strs);
+    }
+
+    container &container::add(const std::string &name, const std::vector<bool> &mask,
+        const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,mask,dims);
+    }
+
+    container &container::add(const std::string &name, const bitmask &mask,
+        const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,mask,dims);
+    }
+
+    container &container::add(const std::string &name, std::shared_ptr<source> src,
+        const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,std::move(src),dims);
+    }
+
+    container &container::add(const std::string &name,
+        const std::vector<std::chrono::system_clock::time_point> &t,
+        const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add");
+        return emplace<matrix>(name,std::make_shared<timesource>(t.data(),t.size()),dims);
+    }
+
+    container &container::add_time(const std::string &name, time_epoch epoch, const double *t,
+        dim_t numel, const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add_time");
+        return emplace<matrix>(name,std::make_shared<timesource>(t,numel,epoch),dims);
+    }
+
+    container &container::add_time(const std::string &name, time_epoch epoch,
+        const long long *t, dim_t numel, const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add_time");
+        return emplace<matrix>(name,std::make_shared<timesource>(t,numel,epoch),dims);
+    }
+
+    container &container::add_time(const std::string &name, time_epoch epoch, const long *t,
+        dim_t numel, const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add_time");
+        return emplace<matrix>(name,std::make_shared<timesource>(t,numel,epoch),dims);
+    }
+
+    container &container::add_half(const std::string &name, half_format format,
+        const uint16_t *data, dim_t numel, const std::vector<dim_t> &dims)
+    {
+        MAT_TRACE_SPAN("container::add_half");
+        return emplace<matrix>(name,std::make_shared<halfsource>(data,numel,format),dims);
     }
 
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 /*
- * 2mat/date/leap.cpp -- implementation of leap seconds
+ * 2mat/date/leap.cpp -- implementation of the leap second table
  * 
  * Version: 1.0
  * Date created: 2021 August 20
@@ -18,37 +18,165 @@
  */
 
 #include "date/leap.hpp"
+#include "datenum.hpp"
+#include "util.hpp"
 
- namespace mat
- {
-     const double LEAP_JD[27] =
-    {
-        2457753.5,
-        2457203.5,
-        2456108.5,
-        2454831.5,
-        2453735.5,
-        2451178.5,
-        2450629.5,
-        2450082.5,
-        2449533.5,
-        2449168.5,
-        2448803.5,
-        2448256.5,
-        2447891.5,
-        2447160.5,
-        2446246.5,
-        2445515.5,
-        2445150.5,
-        2444785.5,
-        2444238.5,
-        2443873.5,
-        2443508.5,
-        2443143.5,
-        2442777.5,
-        2442412.5,
-        2442047.5,
-        2441682.5,
-        2441498.5
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace mat
+{
+
+    // The modified julian day on which each value of TAI-UTC took effect, from the IERS
+    // Leap_Second.dat file. The last leap second was at the end of 2016; later ones can be added
+    // at runtime with load_leap_seconds()
+    static const std::vector<std::pair<long long,int>> LEAP_MJD =
+    {
+        {41317,10},
+        {41499,11},
+        {41683,12},
+        {42048,13},
+        {42413,14},
+        {42778,15},
+        {43144,16},
+        {43509,17},
+        {43874,18},
+        {44239,19},
+        {44786,20},
+        {45151,21},
+        {45516,22},
+        {46247,23},
+        {47161,24},
+        {47892,25},
+        {48257,26},
+        {48804,27},
+        {49169,28},
+        {49534,29},
+        {50083,30},
+        {50630,31},
+        {51179,32},
+        {53736,33},
+        {54832,34},
+        {56109,35},
+        {57204,36},
+        {57754,37}
+    };
+
+    static const long long NS = 1000000000ll;
+    // TT-TAI, in nanoseconds
+    static const long long TT_TAI = 32184000000ll;
+
+    leap_table::leap_table(std::vector<std::pair<long long,int>> changes)
+    {
+        if (changes.empty()) throw mfile_error("Leap second table must not be empty");
+        std::sort(changes.begin(),changes.end());
+        _intervals.reserve(changes.size());
+        for (auto &c : changes)
+        {
+            // TT2000 counts from 2000-01-01 12:00:00 TT, which is MJD 51544.5 less TT-UTC
+            long long utc = ((c.first - 51544)*86400ll - 43200ll)*NS;
+            long long offset = c.second*NS + TT_TAI;
+            _intervals.push_back({utc + offset, offset});
+        }
+    }
+
+    size_t leap_table::find(long long tt) const
+    {
+        auto it = std::upper_bound(_intervals.begin(),_intervals.end(),tt,
+            [](long long t, const leap_interval &iv) { return t < iv.start; });
+        return it == _intervals.begin() ? 0 : (it - _intervals.begin()) - 1;
+    }
+
+    long long leap_table::end(size_t i) const
+    {
+        return i+1 < _intervals.size()
+            ? _intervals[i+1].start
+            : std::numeric_limits<long long>::max();
+    }
+
+    leap_cursor::leap_cursor(const leap_table &table)
+    :
+        _table(table)
+    {}
+
+    // Every table ever installed is kept here, so that references returned by leap_seconds()
+    // remain valid after the table is replaced
+    struct leap_state
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<const leap_table>> tables;
+        std::atomic<const leap_table *> current{nullptr};
+
+        leap_state()
+        {
+            tables.emplace_back(new leap_table(LEAP_MJD));
+            current = tables.back().get();
+        }
     };
-}
\ No newline at end of file
+
+    static leap_state &state()
+    {
+        static leap_state s;
+        return s;
+    }
+
+    const leap_table &leap_seconds()
+    {
+        return *state().current.load(std::memory_order_acquire);
+    }
+
+    void leap_seconds(std::vector<std::pair<long long,int>> changes)
+    {
+        auto &s = state();
+        std::unique_ptr<const leap_table> table(new leap_table(std::move(changes)));
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.current.store(table.get(), std::memory_order_release);
+        s.tables.push_back(std::move(table));
+    }
+
+    void load_leap_seconds(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in) throw mfile_error("Could not open leap second file");
+
+        std::vector<std::pair<long long,int>> changes;
+        std::string line;
+        while (std::getline(in,line))
+        {
+            // Comments start with '#' (IERS and IETF files) or ';' (CDF files)
+            line = line.substr(0,line.find_first_of("#;"));
+            std::istringstream ss(line);
+            std::vector<double> v;
+            double x;
+            while (ss >> x) v.push_back(x);
+            if (v.empty()) continue;
+
+            long long mjd;
+            double tai_utc;
+            if (v.size() == 2)
+            {
+                // IETF: NTP timestamp (seconds since 1900-01-01) and TAI-UTC
+                mjd = 15020 + (long long)v[0]/86400;
+                tai_utc = v[1];
+            } else if (v.size() >= 5 && v[0] > 9999) {
+                // IERS: MJD, day, month, year and TAI-UTC
+                mjd = (long long)v[0];
+                tai_utc = v[4];
+            } else if (v.size() >= 4) {
+                // CDF: year, month, day, TAI-UTC, and the drift terms used before 1972
+                mjd = (long long)(julian((int)v[0],(int)v[1],(int)v[2]) - 2400000.5);
+                tai_utc = v[3];
+            } else {
+                throw mfile_error("Could not parse leap second file");
+            }
+            if (mjd < LEAP_MJD[0].first) continue;
+            changes.emplace_back(mjd,(int)tai_utc);
+        }
+        leap_seconds(std::move(changes));
+    }
+
+}
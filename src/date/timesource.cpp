@@ -0,0 +1,144 @@
+/*
+ * 2mat/date/timesource.cpp -- class implementation for timesource.hpp
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "date/timesource.hpp"
+#include "datenum.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+
+namespace mat
+{
+
+    timesource::timesource(const double *t, dim_t numel, time_epoch epoch)
+    :
+        _data(t),
+        _numel(numel),
+        _epoch(epoch),
+        _input(DOUBLE)
+    {
+        if (epoch == TT2000)
+            throw mfile_error("TT2000 timestamps must be integer nanoseconds");
+    }
+
+    timesource::timesource(const long long *t, dim_t numel, time_epoch epoch)
+    :
+        _data(t),
+        _numel(numel),
+        _epoch(epoch),
+        _input(INT64)
+    {
+        if (epoch != UNIX && epoch != TT2000)
+            throw mfile_error("Integer timestamps must be UNIX or TT2000 nanoseconds");
+    }
+
+    timesource::timesource(const long *t, dim_t numel, time_epoch epoch)
+    :
+        _data(t),
+        _numel(numel),
+        _epoch(epoch),
+        _input(LONG)
+    {
+        if (epoch != UNIX && epoch != TT2000)
+            throw mfile_error("Integer timestamps must be UNIX or TT2000 nanoseconds");
+    }
+
+    timesource::timesource(const std::chrono::system_clock::time_point *t, dim_t numel)
+    :
+        _data(t),
+        _numel(numel),
+        _epoch(UNIX),
+        _input(CLOCK)
+    {}
+
+    datatype timesource::type() const
+    {
+        return miDOUBLE;
+    }
+
+    array_class timesource::mclass() const
+    {
+        return mxDOUBLE_CLASS;
+    }
+
+    dim_t timesource::numel() const
+    {
+        return _numel;
+    }
+
+    void timesource::read(dim_t first, dim_t n, void *buf)
+    {
+        auto dn = (double *)buf;
+        if (_input == CLOCK)
+        {
+            // The number of clock ticks in a day, which is 86400e9 for a nanosecond clock
+            typedef std::chrono::system_clock::period period;
+            const double per_day = 86400.0*period::den/period::num;
+            auto t = (const std::chrono::system_clock::time_point *)_data + first;
+            for (dim_t i = 0; i < n; ++i)
+                dn[i] = 719529.0 + (double)t[i].time_since_epoch().count()/per_day;
+            return;
+        }
+        if (_input == LONG)
+        {
+            // Widened to long long a piece at a time, as long and long long can't alias
+            auto t = (const long *)_data + first;
+            long long piece[512];
+            for (dim_t i = 0; i < n; i += 512)
+            {
+                dim_t m = std::min<dim_t>(512, n-i);
+                std::copy(t+i, t+i+m, piece);
+                timesource(piece, m, _epoch).read(0, m, dn+i);
+            }
+            return;
+        }
+        if (_input == INT64)
+        {
+            auto t = (const long long *)_data + first;
+            if (_epoch == TT2000)
+            {
+                tt20002dn(t,dn,n);
+                return;
+            }
+            for (dim_t i = 0; i < n; ++i)
+                dn[i] = 719529.0 + (double)t[i]/86400e9;
+            return;
+        }
+
+        auto t = (const double *)_data + first;
+        switch (_epoch)
+        {
+            case UNIX:
+                unix2dn(t,dn,n);
+                return;
+            case J1900:
+                j19002dn(t,dn,n);
+                return;
+            case J2000:
+                j20002dn(t,dn,n);
+                return;
+            case MJD:
+                mjd2dn(t,dn,n);
+                return;
+            case TT2000:
+                return;
+        }
+    }
+
+}
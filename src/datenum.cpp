@@ -19,6 +19,8 @@
 
 #include "datenum.hpp"
 #include "date/leap.hpp"
+#include "simd/kernels.hpp"
+#include "util.hpp"
 
 namespace mat
 {
@@ -129,18 +131,65 @@ namespace mat
         return j + 2400000.5 - 1721058.5;
     }
 
+    // The datenum of 2000-01-01 12:00:00 UTC, and the number of nanoseconds in a day
+    static const double J2000_DN = 730486.5;
+    static const double NS_DAY = 86400e9;
+
     double tt20002dn(long long tt)
     {
-        auto hms = (double)((tt%86400000000000ll)/1000000000ll); // NOLINT(bugprone-integer-division)
-        tt /= 86400000000000ll;
-        double jd = (double)tt + 2451545.0;
+        // Correct for leap seconds, so that tt - offset counts UTC (without leap seconds) from
+        // 2000-01-01 12:00:00
+        auto &leap = leap_seconds();
+        long long offset = leap[leap.find(tt)].offset;
+        return J2000_DN + (double)(tt - offset)/NS_DAY;
+    }
+
+    // Below this many values per thread, starting threads costs more than the conversion
+    static const dim_t DN_GRAIN = 1 << 18;
+
+    void unix2dn(const double *s, double *dn, dim_t n)
+    {
+        parallel_for(n, DN_GRAIN, [=](dim_t b, dim_t e) {
+            simd::divide_add(s+b, dn+b, e-b, 86400.0, 719529.0);
+        });
+    }
 
-        // Correct for leap seconds
-        int i = 0;
-        while (LEAP_JD[i] > jd) ++i;
-        hms -= (27 - i);
+    void j19002dn(const double *j, double *dn, dim_t n)
+    {
+        parallel_for(n, DN_GRAIN, [=](dim_t b, dim_t e) {
+            simd::add_subtract(j+b, dn+b, e-b, 2415020.0, 1721058.5);
+        });
+    }
 
-        return jd + (hms)/86400.0 - 1721058.5;
+    void j20002dn(const double *j, double *dn, dim_t n)
+    {
+        parallel_for(n, DN_GRAIN, [=](dim_t b, dim_t e) {
+            simd::add_subtract(j+b, dn+b, e-b, 2451545.0, 1721058.5);
+        });
+    }
+
+    void mjd2dn(const double *j, double *dn, dim_t n)
+    {
+        parallel_for(n, DN_GRAIN, [=](dim_t b, dim_t e) {
+            simd::add_subtract(j+b, dn+b, e-b, 2400000.5, 1721058.5);
+        });
+    }
+
+    void tt20002dn(const long long *tt, double *dn, dim_t n)
+    {
+        auto &leap = leap_seconds();
+        parallel_for(n, DN_GRAIN, [=,&leap](dim_t b, dim_t e) {
+            // CDF epochs are almost always sorted, so the cursor rarely has to search the table;
+            // each run of values between two leap seconds is converted in a tight loop
+            leap_cursor cursor(leap);
+            for (dim_t i = b; i < e;)
+            {
+                long long offset = cursor(tt[i]).offset;
+                long long start = cursor.start(), end = cursor.end();
+                for (; i < e && tt[i] >= start && tt[i] < end; ++i)
+                    dn[i] = J2000_DN + (double)(tt[i] - offset)/NS_DAY;
+            }
+        });
     }
 
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
  */
 
 #include "element.hpp"
+#include "simd/kernels.hpp"
 
 namespace mat
 {
@@ -44,8 +45,22 @@ namespace mat
         // In practise, it is simply easier to treat *all* strings as UTF-8. MATLAB has no trouble
         // reading these on any version newer than 2004, and it greatly simplifies this process.
         // I have made the decision to not support 17-year old version of MATLAB for my own sanity.
-        _data = std::make_shared<std::vector<unsigned char>>(str.size());
-        std::memcpy(ptr(),&str[0],str.size());
+
+        // The catch is that the dimensions of a char matrix count UTF-16 code units, which only
+        // match the characters of a UTF-8 string for the first 65536 code points. So ASCII strings
+        // (the vast majority) are stored as given, and anything else is validated and transcoded
+        // to UTF-16, which for most non-Latin text is smaller anyway.
+        MAT_TRACE_SPAN("element::copy");
+        dim_t units = simd::utf16_length(str.data(),str.size());
+        if (units == str.size())
+        {
+            _data = small_buffer(str.size());
+            std::memcpy(ptr(),str.data(),str.size());
+            return;
+        }
+        _type = miUTF16;
+        _data = small_buffer(units*2);
+        simd::utf8_to_utf16(str.data(),str.size(),ptr<char16_t>());
     }
 
     element::element(std::string name, const std::u16string &str)
@@ -53,10 +68,10 @@ namespace mat
         _type(miUTF16),
         _name(std::move(name))
     {
-        _data = std::make_shared<std::vector<unsigned char>>(str.size()*2);
+        _data = small_buffer(str.size()*2);
         // For explicitly UTF-16 strings, we can simply copy them as is -- the MATLAB UTF-16 type 
         // will deal with them properly.
-        std::memcpy(ptr(),&str[0],str.size());
+        std::memcpy(ptr(),str.data(),str.size()*2);
     }
     
 
@@ -65,10 +80,10 @@ namespace mat
         _type(miUTF32),
         _name(std::move(name))
     {
-        _data = std::make_shared<std::vector<unsigned char>>(str.size()*4);
+        _data = small_buffer(str.size()*4);
         // For explicitly UTF-32 strings, we can simply copy them as is -- the MATLAB UTF-32 type 
         // will deal with them properly.
-        std::memcpy(ptr(),&str[0],str.size());
+        std::memcpy(ptr(),str.data(),str.size()*4);
     }
 
     const std::string &element::name() const
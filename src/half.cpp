@@ -0,0 +1,56 @@
+/*
+ * 2mat/half.cpp -- class implementation for half.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "half.hpp"
+#include "simd/kernels.hpp"
+#include "trace.hpp"
+
+namespace mat
+{
+
+    halfsource::halfsource(const uint16_t *data, dim_t numel, half_format format)
+    :
+        _data(data),
+        _numel(numel),
+        _format(format)
+    {}
+
+    datatype halfsource::type() const
+    {
+        return miSINGLE;
+    }
+
+    array_class halfsource::mclass() const
+    {
+        return mxSINGLE_CLASS;
+    }
+
+    dim_t halfsource::numel() const
+    {
+        return _numel;
+    }
+
+    void halfsource::read(dim_t first, dim_t n, void *buf)
+    {
+        MAT_TRACE_SPAN("halfsource::read");
+        if (_format == BFLOAT16) simd::widen_bfloat16(_data + first, (float *)buf, n);
+        else simd::widen_half(_data + first, (float *)buf, n);
+    }
+
+}
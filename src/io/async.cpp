@@ -0,0 +1,235 @@
+/*
+ * 2mat/io/async.cpp -- class implementation for async.hpp
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/async.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+
+namespace mat
+{
+
+    async_writer::async_writer(std::shared_ptr<sink> out, const async_options &opts,
+        header_fn header, element_fn write, file_stats *stats,
+        std::function<void(const file_stats &)> done)
+    :
+        _opts(opts),
+        _write(std::move(write)),
+        _fw(new fwriter(out)),
+        _stats(stats),
+        _done(std::move(done)),
+        _start(stats_clock::now()),
+        _future(_finished.get_future().share())
+    {
+        if (_stats)
+        {
+            _stats->total.name = out->name();
+            _fw->stats(&_stats->total);
+        }
+        header(*_fw);
+        _fw->stats(nullptr);
+        _writer = std::thread(&async_writer::run_writer, this);
+        for (unsigned int i = 0; i < _opts.workers; ++i)
+            _workers.emplace_back(&async_writer::run_worker, this);
+    }
+
+    async_writer::~async_writer()
+    {
+        close();
+        _writer.join();
+        for (auto &t : _workers) t.join();
+    }
+
+    void async_writer::fail(std::exception_ptr e)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_error) _error = e;
+        }
+        _space.notify_all();
+        _work.notify_all();
+        _ready.notify_all();
+    }
+
+    void async_writer::push(std::shared_ptr<element> elem, const compress_options &opts,
+        bool bounded)
+    {
+        // Everything that doesn't need the lock is done before taking it
+        auto j = std::make_shared<job>();
+        j->bytes = elem->size(true);
+        if (_stats) j->stats.name = elem->name();
+        j->elem = std::move(elem);
+        j->zopts = opts;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            auto fits = [&]{
+                return _error || !bounded || _queue.empty() || _queued + j->bytes <= _opts.budget;
+            };
+            if (_closing) throw mfile_error("Cannot add to a closed file");
+            if (!fits())
+            {
+                if (!_opts.block) throw mfile_error("Write budget exhausted");
+                _space.wait(lock, fits);
+            }
+            if (_error) throw mfile_error("Could not write to file in the background");
+            _queue.push_back(j);
+            if (_opts.workers) _pending.push_back(j);
+            _queued += j->bytes;
+            _peak = std::max(_peak, _queued);
+        }
+        if (_opts.workers) _work.notify_one();
+        else _ready.notify_one();
+    }
+
+    std::shared_future<void> async_writer::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closing = true;
+        }
+        _work.notify_all();
+        _ready.notify_all();
+        return _future;
+    }
+
+    void async_writer::run_writer()
+    {
+        try
+        {
+            for (;;)
+            {
+                std::shared_ptr<job> j;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _ready.wait(lock, [&]{
+                        return _error || (_queue.empty() ? _closing
+                            : !_opts.workers || _queue.front()->done);
+                    });
+                    if (_error || _queue.empty()) break;
+                    j = _queue.front();
+                }
+
+                write_job(*j);
+                if (_stats) _stats->add(j->stats);
+
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _queue.pop_front();
+                    _queued -= j->bytes;
+                }
+                _space.notify_all();
+            }
+            _fw->close();
+            if (_stats)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stats->total.peak = std::max(_stats->total.peak, _peak);
+                _stats->wall = seconds_since(_start);
+            }
+            if (_stats && _done) _done(*_stats);
+        } catch (...) {
+            fail(std::current_exception());
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_error) _finished.set_exception(_error);
+        else _finished.set_value();
+    }
+
+    void async_writer::write_job(job &j)
+    {
+        MAT_TRACE_SPAN("async_writer::write");
+        if (!_opts.workers)
+        {
+            if (!_stats)
+            {
+                _write(*_fw, *j.elem, j.zopts);
+                return;
+            }
+            _fw->stats(&j.stats);
+            auto start = stats_clock::now();
+            _write(*_fw, *j.elem, j.zopts);
+            j.stats.serialise = seconds_since(start) - j.stats.deflate - j.stats.io;
+            _fw->stats(nullptr);
+            return;
+        }
+
+        // Serialised by a worker; only the copy into the file is left
+        auto start = stats_clock::now();
+        _fw->write(j.blob.data(), j.blob.size());
+        if (_stats)
+        {
+            j.stats.io += seconds_since(start);
+            j.stats.writes++;
+        }
+        j.blob = std::vector<unsigned char>();
+    }
+
+    void async_writer::run_worker()
+    {
+        for (;;)
+        {
+            std::shared_ptr<job> j;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _work.wait(lock, [&]{ return _error || _closing || !_pending.empty(); });
+                if (_error || _pending.empty()) return;
+                j = _pending.front();
+                _pending.pop_front();
+            }
+
+            // Serialise the element into memory; the writer thread copies it to the file once
+            // every element before it has been written
+            auto mem = std::make_shared<memory_sink>();
+            try
+            {
+                MAT_TRACE_SPAN("async_writer::serialise");
+                fwriter fw(mem);
+                write_stats stats;
+                if (_stats) fw.stats(&stats);
+                auto start = stats_clock::now();
+                _write(fw, *j->elem, j->zopts);
+                fw.close();
+                if (_stats)
+                {
+                    // Writes into memory count as serialising; the writer thread records the
+                    // write to the file
+                    stats.serialise = seconds_since(start) - stats.deflate;
+                    stats.io = 0;
+                    stats.writes = 0;
+                    stats.name = std::move(j->stats.name);
+                    j->stats = stats;
+                }
+            } catch (...) {
+                fail(std::current_exception());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                j->elem.reset();
+                j->blob = mem->take();
+                j->done = true;
+            }
+            _ready.notify_one();
+        }
+    }
+
+}
@@ -0,0 +1,171 @@
+/*
+ * 2mat/io/estimate.cpp -- class implementation for estimate.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/estimate.hpp"
+#include "element.hpp"
+#include "trace.hpp"
+
+#include <cmath>
+#include <memory>
+
+namespace mat
+{
+
+    namespace
+    {
+        // Counts the bytes written to it, and keeps none of them
+        class count_sink : public sink
+        {
+            dim_t _pos = 0;
+        public:
+            dim_t write(const unsigned char *, dim_t bytes) override
+            {
+                _pos += bytes;
+                return bytes;
+            }
+            [[nodiscard]] dim_t tell() const override { return _pos; }
+            [[nodiscard]] bool seekable() const override { return false; }
+            void seek(dim_t, ios::filepos) override
+            {
+                throw mfile_error("Cannot seek while estimating the size of a file");
+            }
+            void close() override {}
+            [[nodiscard]] std::string name() const override { return "<estimate>"; }
+        };
+    }
+
+    estimator::~estimator()
+    {
+        if (init) deflateEnd(&strm);
+    }
+
+    variable_estimate estimator::compressed(element &elem, const compress_options &opts)
+    {
+        MAT_TRACE_SPAN("estimator::compressed");
+        if (init && (opts.level != level || opts.strategy != strategy))
+        {
+            deflateEnd(&strm);
+            init = false;
+        }
+        level = opts.level;
+        strategy = opts.strategy;
+        _limit = std::max<dim_t>(opts.sample, MAT_ZWINDOWS*64);
+        _bytes = _variance = _margin = 0;
+        _staging = 0;
+        _partial = false;
+
+        variable_estimate v;
+        v.name = elem.name();
+        v.raw = 8 + elem.size(true);
+        auto counted = std::make_shared<count_sink>();
+        {
+            fwriter fw(counted);
+            fw.estimate(this);
+            fw.addfilter(opts);
+            elem.write(fw,V6);
+            fw.rmfilter();
+            fw.close();
+        }
+
+        // Everything but the arrays sampled was compressed for real, so the size can't be less
+        // than that, or more than the data stored uncompressed. The margin only widens the lower
+        // bound: a few windows have less history to draw on than the stream they are taken
+        // from, so they compress a little worse, never better.
+        const dim_t floor = 8 + counted->tell(), ceiling = 8 + compressBound(v.raw-8);
+        const double sd = std::sqrt(_variance);
+        auto clamp = [&](double x) {
+            return std::min(std::max((dim_t)std::llround(std::max(x,0.0)),floor),ceiling);
+        };
+        v.bytes = clamp(floor + _bytes);
+        v.low = clamp(floor + _bytes - 2*sd - _margin);
+        v.high = clamp(floor + _bytes + 2*sd);
+        v.staging = _staging;
+        v.exact = !_partial && !opts.tune;
+        return v;
+    }
+
+    dim_t estimator::compress(const unsigned char *data, dim_t bytes, int flush)
+    {
+        strm.next_in = const_cast<unsigned char *>(data);
+        strm.avail_in = bytes;
+        dim_t produced = 0;
+        do
+        {
+            strm.next_out = out.data();
+            strm.avail_out = out.size();
+            if (deflate(&strm, flush) == Z_STREAM_ERROR)
+                throw mfile_error("Could not compress data element");
+            produced += out.size()-strm.avail_out;
+        } while (strm.avail_out == 0);
+        return produced;
+    }
+
+    void estimator::sample(dim_t bytes, unsigned int width, const reader &read)
+    {
+        MAT_TRACE_SPAN("estimator::sample");
+        if (!init)
+        {
+            if (deflateInit2(&strm, level, Z_DEFLATED, 15, 8, strategy) != Z_OK)
+                throw mfile_error("Could not initialise zlib library");
+            init = true;
+        }
+
+        // Each window holds a whole number of values, and starts at a multiple of 64 of them
+        const dim_t numel = bytes/width, windows = MAT_ZWINDOWS;
+        const dim_t per = std::max<dim_t>(_limit/windows/width, 1);
+        std::vector<dim_t> size(windows);
+        in.resize(windows*per*width);
+        dim_t raw = 0;
+        for (dim_t k = 0; k < windows; ++k)
+        {
+            dim_t first = numel*k/windows/64*64, n = std::min(per, numel-first);
+            read(first, n, in.data() + raw);
+            size[k] = n*width;
+            raw += size[k];
+        }
+        out.resize(deflateBound(&strm, raw) + 64);
+
+        // The spread of the compression ratio between windows comes from compressing each one
+        // in turn, flushing after each. Flushing costs a few bytes, and ends the block, so the
+        // ratio itself comes from compressing all of them again as one stream.
+        deflateReset(&strm);
+        double sum = 0, squares = 0;
+        for (dim_t k = 0, offset = 0; k < windows; offset += size[k++])
+        {
+            double ratio = (double)compress(in.data() + offset, size[k], Z_SYNC_FLUSH)/size[k];
+            sum += ratio;
+            squares += ratio*ratio;
+        }
+        deflateReset(&strm);
+        const double ratio = (double)compress(in.data(), raw, Z_FINISH)/raw;
+
+        // The variance of the mean ratio of the windows, as a sample of the windows making up
+        // the array, scaled to the ratio of the stream and the size of the array
+        const double mean = sum/windows, spread = (squares - sum*mean)/(windows-1);
+        const double unsampled = std::max(1.0 - (double)raw/bytes, 0.0);
+        const double predicted = ratio*bytes;
+        _bytes += predicted;
+        if (mean > 0)
+            _variance += std::max(spread, 0.0)/(mean*mean)/windows*unsampled*predicted*predicted;
+        _margin += MAT_ZMARGIN*predicted;
+        _sampled += raw;
+        _partial = true;
+    }
+
+}
@@ -18,41 +18,86 @@
  */
 
 #include "io/fwriter.hpp"
+#include "trace.hpp"
+#include <algorithm>
 #include <cstring>
+#include <mutex>
+#include <vector>
 
 namespace mat
 {
-    filter::filter(FILE *file)
+
+    // Compressors are costly to set up (two MAT_ZCHUNK buffers and the zlib state), and V7 files
+    // use a fresh one for every element, so finished ones are kept here for the next element --
+    // in this file, another file, or another thread
+    static std::mutex zpool_mutex;
+    static std::vector<std::unique_ptr<zfilter>> zpool;
+    void check_compression(const compress_options &opts)
+    {
+        if (opts.level < -1 || opts.level > 9)
+            throw mfile_error("Compression level must be from -1 to 9");
+        switch (opts.strategy)
+        {
+            case Z_DEFAULT_STRATEGY:
+            case Z_FILTERED:
+            case Z_HUFFMAN_ONLY:
+            case Z_RLE:
+            case Z_FIXED:
+                break;
+            default:
+                throw mfile_error("Unknown compression strategy");
+        }
+        if (!opts.chunk) throw mfile_error("Compression chunk size cannot be zero");
+    }
+
+    filter::filter(sink *out)
     :
-        fptr(file)
+        out(out)
     {}
 
+    dim_t filter::put(const unsigned char *data, dim_t bytes)
+    {
+        if (!stats) return out->write(data,bytes);
+        auto start = stats_clock::now();
+        dim_t n = out->write(data,bytes);
+        stats->io += seconds_since(start);
+        stats->writes++;
+        stats->written += n;
+        return n;
+    }
+
 
-    nofilter::nofilter(FILE *file)
+    nofilter::nofilter(sink *out)
     :
-        filter(file)
+        filter(out)
     {}
 
     dim_t nofilter::write(const unsigned char *data, dim_t bytes)
     {
-        return fwrite(data,1,bytes,fptr);
+        if (stats) stats->bytes += bytes;
+        return put(data,bytes);
     }
 
     void nofilter::flush(){}
 
-    zfilter::zfilter(FILE *file, unsigned int level)
+    zfilter::zfilter(sink *out, const compress_options &opts)
     :
-        filter(file),
-        bptr(buffer),
-        bend(buffer+MAT_ZCHUNK)
+        filter(out),
+        buffer(opts.chunk),
+        zbuffer(opts.chunk),
+        level(opts.level),
+        strategy(opts.strategy)
     {
+        if (!opts.chunk) throw mfile_error("Compression chunk size cannot be zero");
+        bptr = buffer.data();
+        bend = bptr+buffer.size();
 
         strm.zalloc = Z_NULL;
         strm.zfree = Z_NULL;
         strm.opaque = Z_NULL;
-        auto ret = deflateInit(&strm, level);
+        auto ret = deflateInit2(&strm, level, Z_DEFLATED, 15, 8, strategy);
         if (ret != Z_OK)
-            throw mfile_error("Could not initiakuse zlib library");
+            throw mfile_error("Could not initialise zlib library");
     }
 
     zfilter::~zfilter()
@@ -61,24 +106,55 @@ namespace mat
         deflateEnd(&strm);
     }
 
+    void zfilter::reset(sink *out, const compress_options &opts)
+    {
+        if (!opts.chunk) throw mfile_error("Compression chunk size cannot be zero");
+        this->out = out;
+        finished = false;
+        if (buffer.size() != opts.chunk)
+        {
+            buffer.resize(opts.chunk);
+            zbuffer.resize(opts.chunk);
+        }
+        bptr = buffer.data();
+        bend = bptr+buffer.size();
+        if (deflateReset(&strm) != Z_OK)
+            throw mfile_error("Could not initialise zlib library");
+        if (opts.level != level || opts.strategy != strategy)
+        {
+            // Nothing has been compressed since the reset, so this takes effect immediately
+            if (deflateParams(&strm, opts.level, opts.strategy) != Z_OK)
+                throw mfile_error("Invalid compression settings");
+            level = opts.level;
+            strategy = opts.strategy;
+        }
+    }
+
     void zfilter::compress(bool finish)
     {
-        strm.avail_in = bptr-buffer;
-        strm.next_in = buffer;
-        strm.avail_out = MAT_ZCHUNK;
-        strm.next_out = zbuffer;
+        MAT_TRACE_SPAN("zfilter::compress");
+        strm.avail_in = bptr-buffer.data();
+        strm.next_in = buffer.data();
+        if (stats) stats->peak = std::max<dim_t>(stats->peak, strm.avail_in);
         auto f = finish ? Z_FINISH : Z_NO_FLUSH;
         do {
+            strm.avail_out = zbuffer.size();
+            strm.next_out = zbuffer.data();
+            stats_clock::time_point start;
+            if (stats) start = stats_clock::now();
             auto ret = deflate(&strm,f);
+            if (stats) stats->deflate += seconds_since(start);
             if (ret == Z_STREAM_ERROR) throw mfile_error("Could not compress data element");
-            auto have = MAT_ZCHUNK-strm.avail_out;
-            fwrite(zbuffer,1,have,fptr);
+            auto have = zbuffer.size()-strm.avail_out;
+            put(zbuffer.data(),have);
         } while (strm.avail_out == 0);
-        bptr = buffer;
+        bptr = buffer.data();
+        finished = finish;
     }
 
     dim_t zfilter::write(const unsigned char *data, dim_t bytes)
     {
+        if (stats) stats->bytes += bytes;
         dim_t avail = bend-bptr;
         if (avail > bytes)
         {
@@ -93,6 +169,8 @@ namespace mat
             bptr = bend;
             off += avail;
             compress(false);
+            // Only the first pass tops up a partly filled buffer; after that it is empty
+            avail = bend-bptr;
         } while(bytes-off > avail);
         memcpy(bptr,data+off,bytes-off);
         bptr += bytes-off;
@@ -101,15 +179,26 @@ namespace mat
 
     void zfilter::flush()
     {
-        compress(true);
+        // The stream can only be finished once; after that there is nothing left to write
+        if (!finished) compress(true);
     }
 
     fwriter::fwriter(const std::string &path)
     :
-        fptr(fopen(path.c_str(),"wb"))
+        fwriter(std::make_shared<file_sink>(path))
+    {}
+
+    fwriter::fwriter(FILE *file)
+    :
+        fwriter(std::make_shared<file_sink>(file))
+    {}
+
+    fwriter::fwriter(std::shared_ptr<sink> out)
+    :
+        out(std::move(out))
     {
-        if (!fptr) throw mfile_error("Could not open file");
-        filt = new nofilter(fptr);
+        if (!this->out) throw mfile_error("Could not open file");
+        filt = new nofilter(this->out.get());
     }
 
     fwriter::~fwriter()
@@ -117,37 +206,116 @@ namespace mat
         close();
     }
 
+    void fwriter::release()
+    {
+        auto *f = filt;
+        filt = nullptr;
+        auto *z = dynamic_cast<zfilter *>(f);
+        if (!z)
+        {
+            delete f;
+            return;
+        }
+        std::unique_ptr<zfilter> zp(z);
+        // Finished, so it writes nothing more to the file when it is eventually destroyed
+        zp->flush();
+        std::lock_guard<std::mutex> lock(zpool_mutex);
+        if (zpool.size() < MAT_ZPOOL) zpool.push_back(std::move(zp));
+    }
+
+    void fwriter::addfilter(const compress_options &opts)
+    {
+        release();
+        std::unique_ptr<zfilter> z;
+        {
+            std::lock_guard<std::mutex> lock(zpool_mutex);
+            if (!zpool.empty())
+            {
+                z = std::move(zpool.back());
+                zpool.pop_back();
+            }
+        }
+        if (z) z->reset(out.get(), opts);
+        else z.reset(new zfilter(out.get(), opts));
+        filt = z.release();
+        filt->stats = stat;
+    }
+
     void fwriter::rmfilter()
     {
-        delete filt;
-        filt = new nofilter(fptr);
+        release();
+        filt = new nofilter(out.get());
+        filt->stats = stat;
+    }
+
+    void fwriter::stats(write_stats *stats)
+    {
+        stat = stats;
+        if (filt) filt->stats = stats;
+    }
+
+    write_stats *fwriter::stats() const
+    {
+        return stat;
+    }
+
+    void fwriter::estimate(estimator *est)
+    {
+        this->est = est;
+    }
+
+    estimator *fwriter::estimate() const
+    {
+        return est;
     }
 
     dim_t fwriter::tellp() const
     {
-        if (!fptr) throw mfile_error("Cannot tell closed file");
-        return ftell(fptr);
+        if (!out) throw mfile_error("Cannot tell closed file");
+        return out->tell();
     }
+
     dim_t fwriter::seekp(dim_t pos, ios::filepos whence)
     {
-        if (!fptr) throw mfile_error("Cannot seek closed file");
+        if (!out) throw mfile_error("Cannot seek closed file");
+        MAT_TRACE_SPAN("fwriter::seekp");
+        if (stat) stat->seeks++;
         filt->flush();
-        return fseek(fptr,(long) pos,whence);
+        out->seek(pos,whence);
+        return 0;
+    }
+
+    bool fwriter::seekable() const
+    {
+        return out && out->seekable();
     }
 
     dim_t fwriter::write(const std::string &str)
     {
-        if (!fptr) throw mfile_error("Cannot write to closed file");
+        if (!out) throw mfile_error("Cannot write to closed file");
         return filt->write((const unsigned char *)&str[0],str.size());
     }
 
+    dim_t fwriter::pad(dim_t n)
+    {
+        static const unsigned char zeros[64] = {};
+        if (!out) throw mfile_error("Cannot write to closed file");
+        if (stat) stat->padding += n;
+        for (dim_t left = n; left; )
+        {
+            dim_t m = std::min<dim_t>(left,sizeof(zeros));
+            filt->write(zeros,m);
+            left -= m;
+        }
+        return n;
+    }
+
     void fwriter::close()
     {
-        delete filt;
-        filt = nullptr;
-        if (!fptr) return;
-        fclose(fptr);
-        fptr = nullptr;
+        release();
+        if (!out) return;
+        out->close();
+        out.reset();
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,330 @@
+/*
+ * 2mat/io/sink.cpp -- class implementations for sink.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/sink.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Alignment required of the buffers, offsets and sizes of O_DIRECT writes
+static const mat::dim_t PAGE = 4096;
+
+namespace mat
+{
+
+    file_sink::file_sink(const std::string &path)
+    :
+        fptr(fopen(path.c_str(),"wb")),
+        _name(path)
+    {
+        if (!fptr) throw mfile_error("Could not open file");
+    }
+
+    file_sink::file_sink(FILE *file, std::string name)
+    :
+        fptr(file),
+        _name(std::move(name))
+    {
+        if (!fptr) throw mfile_error("Could not open file");
+    }
+
+    file_sink::~file_sink()
+    {
+        close();
+    }
+
+    dim_t file_sink::write(const unsigned char *data, dim_t bytes)
+    {
+        return fwrite(data,1,bytes,fptr);
+    }
+
+    dim_t file_sink::tell() const
+    {
+        return ftell(fptr);
+    }
+
+    void file_sink::seek(dim_t pos, ios::filepos whence)
+    {
+        if (fseek(fptr,(long)pos,whence)) throw mfile_error("Could not seek file");
+    }
+
+    void file_sink::close()
+    {
+        if (!fptr) return;
+        fclose(fptr);
+        fptr = nullptr;
+    }
+
+    memory_sink::memory_sink(dim_t reserve)
+    {
+        _buf.reserve(reserve);
+    }
+
+    dim_t memory_sink::write(const unsigned char *data, dim_t bytes)
+    {
+        // Writes after a seek back overwrite what is there, and may run on past the end
+        if (_pos+bytes > _buf.size()) _buf.resize(_pos+bytes);
+        std::memcpy(_buf.data()+_pos,data,bytes);
+        _pos += bytes;
+        return bytes;
+    }
+
+    void memory_sink::seek(dim_t pos, ios::filepos whence)
+    {
+        dim_t base = whence == ios::beg ? 0 : whence == ios::cur ? _pos : _buf.size();
+        if (base+pos > _buf.size()) throw mfile_error("Cannot seek past the end of the buffer");
+        _pos = base+pos;
+    }
+
+    std::vector<unsigned char> memory_sink::take()
+    {
+        _pos = 0;
+        return std::move(_buf);
+    }
+
+    stream_sink::stream_sink(FILE *file, bool owned, std::string name)
+    :
+        fptr(file),
+        owned(owned),
+        _name(std::move(name))
+    {
+        if (!fptr) throw mfile_error("Could not open stream");
+    }
+
+    stream_sink::~stream_sink()
+    {
+        close();
+    }
+
+    dim_t stream_sink::write(const unsigned char *data, dim_t bytes)
+    {
+        dim_t n = fwrite(data,1,bytes,fptr);
+        _pos += n;
+        return n;
+    }
+
+    void stream_sink::seek(dim_t, ios::filepos)
+    {
+        throw mfile_error("Cannot seek a stream");
+    }
+
+    void stream_sink::close()
+    {
+        if (!fptr) return;
+        if (owned) fclose(fptr);
+        else fflush(fptr);
+        fptr = nullptr;
+    }
+
+    large_file_sink::large_file_sink(const std::string &path, const large_file_options &opts)
+    :
+        _name(path),
+        opts(opts)
+    {
+        this->opts.block = std::max<dim_t>((opts.block+PAGE-1)/PAGE*PAGE,PAGE);
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (opts.direct)
+        {
+            // Reads are needed to patch bytes in place, a page at a time
+            fd = open(path.c_str(),O_RDWR | O_CREAT | O_TRUNC | O_DIRECT,0644);
+            if (fd < 0 && errno != EINVAL) throw mfile_error("Could not open file");
+        } else {
+            fd = -1;
+        }
+        if (fd < 0) this->opts.direct = false;
+#else
+        fd = -1;
+        this->opts.direct = false;
+#endif
+        if (fd < 0) fd = open(path.c_str(),flags,0644);
+        if (fd < 0) throw mfile_error("Could not open file");
+
+        if (posix_memalign((void **)&buf,PAGE,this->opts.block))
+        {
+            ::close(fd);
+            throw mfile_error("Could not allocate write buffer");
+        }
+
+        if (opts.expected)
+        {
+#ifdef __linux__
+            // Reserve the space without changing the size of the file, so that an estimate that
+            // is too large costs nothing once the file is truncated on closing
+            int ret = fallocate(fd,FALLOC_FL_KEEP_SIZE,0,(off_t)opts.expected);
+            if (ret && errno == ENOSPC)
+            {
+                ::close(fd);
+                free(buf);
+                throw mfile_error("Not enough space for file");
+            }
+#endif
+        }
+    }
+
+    large_file_sink::~large_file_sink()
+    {
+        try
+        {
+            close();
+        } catch (...) {}
+    }
+
+    void large_file_sink::put(const unsigned char *data, dim_t bytes, dim_t off)
+    {
+        while (bytes)
+        {
+            ssize_t n = pwrite(fd,data,bytes,(off_t)off);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw mfile_error("Could not write file");
+            data += n;
+            bytes -= n;
+            off += n;
+        }
+    }
+
+    void large_file_sink::patch(const unsigned char *data, dim_t bytes, dim_t off)
+    {
+        if (!opts.direct)
+        {
+            put(data,bytes,off);
+            return;
+        }
+        // O_DIRECT can only write whole pages, so read each page back, change it and rewrite it.
+        // Only blocks already written are patched, and those were written a page at a time.
+        unsigned char *page;
+        if (posix_memalign((void **)&page,PAGE,PAGE)) throw mfile_error("Could not patch file");
+        std::unique_ptr<unsigned char, decltype(&free)> guard(page,&free);
+        while (bytes)
+        {
+            dim_t start = off/PAGE*PAGE, at = off-start, n = std::min(bytes,PAGE-at);
+            if (pread(fd,page,PAGE,(off_t)start) != (ssize_t)PAGE)
+                throw mfile_error("Could not patch file");
+            std::memcpy(page+at,data,n);
+            put(page,PAGE,start);
+            data += n;
+            bytes -= n;
+            off += n;
+        }
+    }
+
+    void large_file_sink::flush_block()
+    {
+        put(buf,opts.block,base);
+#ifdef __linux__
+        if (opts.drop_cache && !opts.direct)
+        {
+            // Start writing this block back, then wait for the one before (which has had a whole
+            // block's worth of time to get there) and drop it from the page cache
+            sync_file_range(fd,(off_t)base,(off_t)opts.block,SYNC_FILE_RANGE_WRITE);
+            if (base)
+            {
+                off_t prev = (off_t)(base-opts.block);
+                sync_file_range(fd,prev,(off_t)opts.block,SYNC_FILE_RANGE_WAIT_BEFORE
+                    | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+                posix_fadvise(fd,prev,(off_t)opts.block,POSIX_FADV_DONTNEED);
+            }
+        }
+#endif
+        base += opts.block;
+        fill = 0;
+    }
+
+    dim_t large_file_sink::write(const unsigned char *data, dim_t bytes)
+    {
+        if (fd < 0) throw mfile_error("Cannot write to closed file");
+        dim_t total = bytes;
+        while (bytes)
+        {
+            if (pos < base)
+            {
+                dim_t n = std::min(bytes,base-pos);
+                patch(data,n,pos);
+                data += n;
+                bytes -= n;
+                pos += n;
+                continue;
+            }
+            dim_t off = pos-base;
+            if (off == opts.block)
+            {
+                flush_block();
+                continue;
+            }
+            dim_t n = std::min(bytes,opts.block-off);
+            std::memcpy(buf+off,data,n);
+            data += n;
+            bytes -= n;
+            pos += n;
+            fill = std::max(fill,off+n);
+        }
+        return total;
+    }
+
+    void large_file_sink::seek(dim_t pos, ios::filepos whence)
+    {
+        dim_t end = base+fill;
+        dim_t to = (whence == ios::beg ? 0 : whence == ios::cur ? this->pos : end) + pos;
+        // Only what has been written can be seeked over; the file has no holes
+        if (to > end) throw mfile_error("Cannot seek past the end of the file");
+        this->pos = to;
+    }
+
+    void large_file_sink::close()
+    {
+        if (fd < 0) return;
+        dim_t size = base+fill;
+        std::exception_ptr error;
+        try
+        {
+            if (fill)
+            {
+                // O_DIRECT writes whole pages, so the last one is padded and then cut off below
+                dim_t n = opts.direct ? (fill+PAGE-1)/PAGE*PAGE : fill;
+                std::memset(buf+fill,0,n-fill);
+                put(buf,n,base);
+            }
+            if (ftruncate(fd,(off_t)size)) throw mfile_error("Could not write file");
+#ifdef __linux__
+            if (opts.drop_cache && !opts.direct)
+            {
+                sync_file_range(fd,0,0,SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE
+                    | SYNC_FILE_RANGE_WAIT_AFTER);
+                posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED);
+            }
+#endif
+        } catch (...) {
+            error = std::current_exception();
+        }
+        ::close(fd);
+        fd = -1;
+        free(buf);
+        buf = nullptr;
+        if (error) std::rethrow_exception(error);
+    }
+
+}
@@ -0,0 +1,158 @@
+/*
+ * 2mat/io/tune.cpp -- implementation for tune.hpp
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/tune.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace mat
+{
+
+    namespace
+    {
+
+        // Thrown by the sampler once the sample is complete, to stop writing the element
+        struct sample_full {};
+
+        // Collects MAT_ZWINDOWS evenly spaced windows of the bytes written through it
+        class sampler : public filter
+        {
+            std::vector<unsigned char> &out;
+            dim_t pos = 0, window, stride;
+            unsigned int next = 0, windows;
+        public:
+            sampler(sink *dest, std::vector<unsigned char> &out, dim_t total, dim_t sample)
+            :
+                filter(dest),
+                out(out)
+            {
+                if (total <= sample)
+                {
+                    windows = 1;
+                    window = stride = total;
+                } else {
+                    windows = MAT_ZWINDOWS;
+                    window = std::max<dim_t>(sample/windows,1);
+                    stride = total/windows;
+                }
+                out.reserve(window*windows);
+            }
+
+            dim_t write(const unsigned char *data, dim_t bytes) override
+            {
+                dim_t end = pos+bytes;
+                while (next < windows)
+                {
+                    dim_t ws = next*stride, we = ws+window;
+                    if (ws >= end) break;
+                    dim_t a = std::max(ws,pos), b = std::min(we,end);
+                    out.insert(out.end(), data+(a-pos), data+(b-pos));
+                    if (b < we) break;
+                    ++next;
+                }
+                pos = end;
+                if (next == windows) throw sample_full();
+                return bytes;
+            }
+
+            void flush() override {}
+        };
+
+        struct trial
+        {
+            int level, strategy;
+            double ratio = 0, speed = 0;
+        };
+
+        // Compresses the sample with the settings in t, recording the ratio and speed achieved
+        void run(trial &t, const std::vector<unsigned char> &sample)
+        {
+            z_stream strm{};
+            if (deflateInit2(&strm, t.level, Z_DEFLATED, 15, 8, t.strategy) != Z_OK)
+                throw mfile_error("Could not initialise zlib library");
+            std::vector<unsigned char> out(deflateBound(&strm, sample.size()));
+            strm.next_in = (unsigned char *)sample.data();
+            strm.avail_in = sample.size();
+            strm.next_out = out.data();
+            strm.avail_out = out.size();
+
+            auto start = std::chrono::steady_clock::now();
+            auto ret = deflate(&strm, Z_FINISH);
+            std::chrono::duration<double> dt = std::chrono::steady_clock::now()-start;
+            dim_t zbytes = out.size()-strm.avail_out;
+            deflateEnd(&strm);
+            if (ret != Z_STREAM_END) throw mfile_error("Could not compress data element");
+
+            t.ratio = (double)sample.size()/std::max<dim_t>(zbytes,1);
+            t.speed = sample.size()/std::max(dt.count(),1e-9)/1e6;
+        }
+
+    }
+
+    compress_options tune(element &elem, const compress_options &opts)
+    {
+        std::vector<unsigned char> sample;
+        {
+            // The sampler keeps what it needs, and passes nothing on to the sink
+            fwriter fw(std::make_shared<memory_sink>());
+            fw.addfilter<sampler>(sample, elem.size(true), opts.sample);
+            try
+            {
+                elem.write(fw, V6);
+            } catch (sample_full &) {}
+            fw.close();
+        }
+
+        compress_options best = opts;
+        best.tune = false;
+        if (sample.empty()) return best;
+
+        trial trials[] = {
+            {1, Z_DEFAULT_STRATEGY},
+            {6, Z_DEFAULT_STRATEGY},
+            {9, Z_DEFAULT_STRATEGY},
+            {6, Z_FILTERED},
+            {6, Z_RLE},
+            {6, Z_HUFFMAN_ONLY}
+        };
+        for (auto &t : trials) run(t, sample);
+
+        auto fast = [&](const trial &t) { return t.speed >= opts.speed; };
+        auto small = [&](const trial &t) { return t.ratio >= opts.ratio; };
+        const trial *pick = nullptr;
+        // The fastest that meets both targets...
+        for (auto &t : trials)
+            if (fast(t) && small(t) && (!pick || t.speed > pick->speed)) pick = &t;
+        // ...or the smallest that is fast enough...
+        if (!pick)
+            for (auto &t : trials)
+                if (fast(t) && (!pick || t.ratio > pick->ratio)) pick = &t;
+        // ...or just the fastest
+        if (!pick)
+            for (auto &t : trials)
+                if (!pick || t.speed > pick->speed) pick = &t;
+
+        best.level = pick->level;
+        best.strategy = pick->strategy;
+        return best;
+    }
+
+}
@@ -0,0 +1,424 @@
+/*
+ * 2mat/io/uring.cpp -- class implementation for uring.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/uring.hpp"
+#include "trace.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define MAT_HAVE_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+static const mat::dim_t PAGE = 4096;
+
+// Completions of patches are told apart from those of buffers by this bit of their user data
+static const uint64_t PATCH = 1ull << 32;
+
+namespace mat
+{
+
+#ifdef MAT_HAVE_URING
+
+    namespace
+    {
+        int uring_setup(unsigned int entries, io_uring_params *p)
+        {
+            return (int)syscall(__NR_io_uring_setup, entries, p);
+        }
+
+        int uring_enter(int fd, unsigned int submit, unsigned int wait, unsigned int flags)
+        {
+            return (int)syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0);
+        }
+
+        int uring_register(int fd, unsigned int op, const void *arg, unsigned int n)
+        {
+            return (int)syscall(__NR_io_uring_register, fd, op, arg, n);
+        }
+
+        // The operations used by uring_sink that the kernel supports
+        struct operations
+        {
+            bool write = false, write_fixed = false;
+        };
+
+        // Asks a small ring which operations it supports; worked out once. Kernels too old to be
+        // probed (before 5.6) are also too old for IORING_OP_WRITE, so support nothing.
+        const operations &probe()
+        {
+            static const operations found = [] {
+                operations ops;
+                io_uring_params p{};
+                int fd = uring_setup(1, &p);
+                if (fd < 0) return ops;
+                size_t len = sizeof(io_uring_probe) + IORING_OP_LAST*sizeof(io_uring_probe_op);
+                std::unique_ptr<unsigned char[]> buf(new unsigned char[len]());
+                auto *pr = (io_uring_probe *)buf.get();
+                if (!uring_register(fd, IORING_REGISTER_PROBE, pr, IORING_OP_LAST))
+                {
+                    auto has = [pr](int op) {
+                        return op <= pr->last_op && (pr->ops[op].flags & IO_URING_OP_SUPPORTED);
+                    };
+                    ops.write = has(IORING_OP_WRITE);
+                    ops.write_fixed = has(IORING_OP_WRITE_FIXED);
+                }
+                ::close(fd);
+                return ops;
+            }();
+            return found;
+        }
+    }
+
+    // The mapped submission and completion queues of a ring
+    struct uring_sink::ring
+    {
+        int fd = -1;
+        unsigned int entries = 0;
+        bool fixed = false;
+
+        void *sq_map = MAP_FAILED, *cq_map = MAP_FAILED, *sqe_map = MAP_FAILED;
+        size_t sq_size = 0, cq_size = 0, sqe_size = 0;
+
+        unsigned int *sq_tail = nullptr, *sq_mask = nullptr, *sq_array = nullptr;
+        io_uring_sqe *sqes = nullptr;
+        unsigned int *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+        io_uring_cqe *cqes = nullptr;
+
+        explicit ring(unsigned int entries)
+        {
+            io_uring_params p{};
+            fd = uring_setup(entries, &p);
+            if (fd < 0) throw mfile_error("Could not set up io_uring");
+            this->entries = p.sq_entries;
+
+            sq_size = p.sq_off.array + p.sq_entries*sizeof(unsigned int);
+            cq_size = p.cq_off.cqes + p.cq_entries*sizeof(io_uring_cqe);
+            if (p.features & IORING_FEAT_SINGLE_MMAP) sq_size = cq_size = std::max(sq_size,cq_size);
+            sq_map = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                IORING_OFF_SQ_RING);
+            if (sq_map == MAP_FAILED) fail();
+            if (p.features & IORING_FEAT_SINGLE_MMAP)
+            {
+                cq_map = sq_map;
+            } else {
+                cq_map = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    fd, IORING_OFF_CQ_RING);
+                if (cq_map == MAP_FAILED) fail();
+            }
+            sqe_size = p.sq_entries*sizeof(io_uring_sqe);
+            sqe_map = mmap(nullptr, sqe_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                IORING_OFF_SQES);
+            if (sqe_map == MAP_FAILED) fail();
+
+            auto sq = (char *)sq_map, cq = (char *)cq_map;
+            sq_tail = (unsigned int *)(sq + p.sq_off.tail);
+            sq_mask = (unsigned int *)(sq + p.sq_off.ring_mask);
+            sq_array = (unsigned int *)(sq + p.sq_off.array);
+            sqes = (io_uring_sqe *)sqe_map;
+            cq_head = (unsigned int *)(cq + p.cq_off.head);
+            cq_tail = (unsigned int *)(cq + p.cq_off.tail);
+            cq_mask = (unsigned int *)(cq + p.cq_off.ring_mask);
+            cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+        }
+
+        ~ring()
+        {
+            unmap();
+        }
+
+        void unmap()
+        {
+            if (sqe_map != MAP_FAILED) munmap(sqe_map, sqe_size);
+            if (cq_map != MAP_FAILED && cq_map != sq_map) munmap(cq_map, cq_size);
+            if (sq_map != MAP_FAILED) munmap(sq_map, sq_size);
+            sq_map = cq_map = sqe_map = MAP_FAILED;
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+
+        [[noreturn]] void fail()
+        {
+            unmap();
+            throw mfile_error("Could not set up io_uring");
+        }
+
+        // Queues a write and submits it straight away
+        void write(int file, const unsigned char *data, dim_t bytes, dim_t off, uint64_t tag,
+            int index)
+        {
+            unsigned int tail = *sq_tail, idx = tail & *sq_mask;
+            io_uring_sqe *sqe = &sqes[idx];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = index >= 0 ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            sqe->fd = file;
+            sqe->addr = (uint64_t)(uintptr_t)data;
+            sqe->len = (uint32_t)bytes;
+            sqe->off = off;
+            sqe->buf_index = index >= 0 ? (uint16_t)index : 0;
+            sqe->user_data = tag;
+            sq_array[idx] = idx;
+            __atomic_store_n(sq_tail, tail+1, __ATOMIC_RELEASE);
+            int ret;
+            while ((ret = uring_enter(fd, 1, 0, 0)) < 0 && errno == EINTR);
+            if (ret < 0) throw mfile_error("Could not write file");
+        }
+    };
+
+    bool uring_sink::supported()
+    {
+        return probe().write;
+    }
+
+    uring_sink::uring_sink(const std::string &path, const uring_options &opts)
+    :
+        _name(path),
+        opts(opts)
+    {
+        this->opts.depth = std::max(opts.depth,1u);
+        this->opts.block = std::max<dim_t>((opts.block+PAGE-1)/PAGE*PAGE,PAGE);
+        // A slot for each buffer, and as many again for patches
+        _ring.reset(new ring(2*this->opts.depth));
+
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) throw mfile_error("Could not open file");
+
+        bufs.resize(this->opts.depth);
+        std::vector<iovec> iov;
+        for (auto &b : bufs)
+        {
+            if (posix_memalign((void **)&b.data, PAGE, this->opts.block))
+            {
+                release();
+                throw mfile_error("Could not allocate write buffer");
+            }
+            iov.push_back({b.data, (size_t)this->opts.block});
+        }
+        // Registered buffers save the kernel mapping them on every write, but need locked
+        // memory, which may be limited, and a kernel with IORING_OP_WRITE_FIXED; plain writes
+        // work without
+        _ring->fixed = probe().write_fixed && !uring_register(_ring->fd, IORING_REGISTER_BUFFERS,
+            iov.data(), (unsigned int)iov.size());
+    }
+
+    void uring_sink::release()
+    {
+        if (_ring) _ring->unmap();
+        _ring.reset();
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        for (auto &b : bufs) free(b.data);
+        bufs.clear();
+        patches.clear();
+    }
+
+    void uring_sink::submit()
+    {
+        auto &b = bufs[current];
+        if (!b.size) return;
+        while (inflight >= _ring->entries) reap();
+        _ring->write(fd, b.data, b.size, b.offset, current, _ring->fixed ? (int)current : -1);
+        b.busy = true;
+        ++inflight;
+
+        dim_t next = b.offset + b.size;
+        current = (current+1) % opts.depth;
+        while (bufs[current].busy) reap();
+        bufs[current].offset = next;
+        bufs[current].size = 0;
+    }
+
+    void uring_sink::reap()
+    {
+        MAT_TRACE_SPAN("uring_sink::wait");
+        auto &r = *_ring;
+        unsigned int head = *r.cq_head;
+        while (head == __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE))
+        {
+            if (uring_enter(r.fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+                throw mfile_error("Could not write file");
+        }
+
+        bool failed = false;
+        do {
+            io_uring_cqe &cqe = r.cqes[head & *r.cq_mask];
+            uint64_t tag = cqe.user_data;
+            int res = cqe.res;
+            ++head;
+            --inflight;
+            if (tag & PATCH)
+            {
+                failed |= res < 0;
+                patches[tag & ~PATCH].reset();
+                continue;
+            }
+            auto &b = bufs[tag];
+            b.busy = false;
+            if (res < 0)
+            {
+                failed = true;
+                continue;
+            }
+            // Regular files only write less than asked when something is wrong (such as the disk
+            // being full); finish the write directly to find out
+            for (dim_t done = res; done < b.size && !failed; )
+            {
+                ssize_t n = pwrite(fd, b.data+done, b.size-done, (off_t)(b.offset+done));
+                if (n < 0 && errno == EINTR) continue;
+                failed = n <= 0;
+                if (n > 0) done += n;
+            }
+        } while (head != __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE));
+        __atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+
+        if (std::none_of(patches.begin(), patches.end(), [](auto &p) { return (bool)p; }))
+            patches.clear();
+        if (failed) throw mfile_error("Could not write file");
+    }
+
+    void uring_sink::patch(const unsigned char *data, dim_t bytes, dim_t off)
+    {
+        // The block holding these bytes must be written first, or it would overwrite them
+        for (auto &b : bufs)
+            while (b.busy && b.offset < off+bytes && off < b.offset+b.size) reap();
+        while (inflight >= _ring->entries) reap();
+        std::unique_ptr<unsigned char[]> copy(new unsigned char[bytes]);
+        std::memcpy(copy.get(), data, bytes);
+        _ring->write(fd, copy.get(), bytes, off, PATCH | patches.size(), -1);
+        patches.push_back(std::move(copy));
+        ++inflight;
+    }
+
+    dim_t uring_sink::write(const unsigned char *data, dim_t bytes)
+    {
+        if (fd < 0) throw mfile_error("Cannot write to closed file");
+        dim_t total = bytes;
+        while (bytes)
+        {
+            auto &b = bufs[current];
+            dim_t n;
+            if (pos < b.offset)
+            {
+                n = std::min(bytes, b.offset-pos);
+                patch(data, n, pos);
+            } else {
+                dim_t off = pos-b.offset;
+                if (off == opts.block)
+                {
+                    submit();
+                    continue;
+                }
+                n = std::min(bytes, opts.block-off);
+                std::memcpy(b.data+off, data, n);
+                b.size = std::max(b.size, off+n);
+            }
+            data += n;
+            bytes -= n;
+            pos += n;
+        }
+        return total;
+    }
+
+    void uring_sink::seek(dim_t pos, ios::filepos whence)
+    {
+        auto &b = bufs[current];
+        dim_t end = b.offset+b.size;
+        dim_t to = (whence == ios::beg ? 0 : whence == ios::cur ? this->pos : end) + pos;
+        if (to > end) throw mfile_error("Cannot seek past the end of the file");
+        this->pos = to;
+    }
+
+    void uring_sink::close()
+    {
+        if (fd < 0) return;
+        std::exception_ptr error;
+        try
+        {
+            submit();
+            while (inflight) reap();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        release();
+        if (error) std::rethrow_exception(error);
+    }
+
+#else
+
+    struct uring_sink::ring {};
+
+    bool uring_sink::supported()
+    {
+        return false;
+    }
+
+    uring_sink::uring_sink(const std::string &path, const uring_options &opts)
+    :
+        _name(path),
+        opts(opts)
+    {
+        throw mfile_error("io_uring is not supported on this system");
+    }
+
+    void uring_sink::release() {}
+    void uring_sink::submit() {}
+    void uring_sink::reap() {}
+    void uring_sink::patch(const unsigned char *, dim_t, dim_t) {}
+
+    dim_t uring_sink::write(const unsigned char *, dim_t)
+    {
+        throw mfile_error("Cannot write to closed file");
+    }
+
+    void uring_sink::seek(dim_t, ios::filepos)
+    {
+        throw mfile_error("Cannot seek closed file");
+    }
+
+    void uring_sink::close() {}
+
+#endif
+
+    uring_sink::~uring_sink()
+    {
+        try
+        {
+            close();
+        } catch (...) {}
+    }
+
+    std::shared_ptr<sink> uring_sink::open(const std::string &path, const uring_options &opts)
+    {
+        if (supported()) return std::make_shared<uring_sink>(path, opts);
+        return std::make_shared<file_sink>(path);
+    }
+
+}
@@ -0,0 +1,170 @@
+/*
+ * 2mat/io/zcache.cpp -- class implementation for zcache.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/zcache.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mat
+{
+
+    namespace
+    {
+        inline uint64_t rotl(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64-r));
+        }
+
+        inline uint64_t fmix(uint64_t k)
+        {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdull;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ull;
+            k ^= k >> 33;
+            return k;
+        }
+
+        // MurmurHash3 (x64, 128-bit), which runs at several GB/s and is plenty to tell elements
+        // apart; it is not meant to stand up to inputs crafted to collide
+        void murmur3(const unsigned char *data, dim_t bytes, uint64_t seed, uint64_t out[2])
+        {
+            const uint64_t c1 = 0x87c37b91114253d5ull, c2 = 0x4cf5ad432745937full;
+            uint64_t h1 = seed, h2 = seed;
+            dim_t blocks = bytes/16;
+            for (dim_t i = 0; i < blocks; ++i)
+            {
+                uint64_t k1, k2;
+                std::memcpy(&k1,data+16*i,8);
+                std::memcpy(&k2,data+16*i+8,8);
+
+                k1 *= c1; k1 = rotl(k1,31); k1 *= c2; h1 ^= k1;
+                h1 = rotl(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
+                k2 *= c2; k2 = rotl(k2,33); k2 *= c1; h2 ^= k2;
+                h2 = rotl(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
+            }
+
+            const unsigned char *tail = data+16*blocks;
+            uint64_t k1 = 0, k2 = 0;
+            for (dim_t i = bytes & 15; i > 8; --i)
+                k2 |= (uint64_t)tail[i-1] << 8*(i-9);
+            for (dim_t i = std::min<dim_t>(bytes & 15, 8); i > 0; --i)
+                k1 |= (uint64_t)tail[i-1] << 8*(i-1);
+            k2 *= c2; k2 = rotl(k2,33); k2 *= c1; h2 ^= k2;
+            k1 *= c1; k1 = rotl(k1,31); k1 *= c2; h1 ^= k1;
+
+            h1 ^= bytes; h2 ^= bytes;
+            h1 += h2; h2 += h1;
+            h1 = fmix(h1); h2 = fmix(h2);
+            h1 += h2; h2 += h1;
+            out[0] = h1;
+            out[1] = h2;
+        }
+    }
+
+    zcache::zcache(dim_t capacity)
+    :
+        _capacity(capacity)
+    {}
+
+    std::shared_ptr<zcache> zcache::shared()
+    {
+        static std::shared_ptr<zcache> cache = std::make_shared<zcache>();
+        return cache;
+    }
+
+    zcache::key zcache::digest(const unsigned char *data, dim_t bytes, const compress_options &opts)
+    {
+        MAT_TRACE_SPAN("zcache::digest");
+        // Elements compressed with different settings are kept apart. Tuned elements all share
+        // one key: whichever settings tuning picked, the result is the same once decompressed.
+        uint64_t seed = opts.tune ? 1ull << 32
+            : (uint64_t)(opts.level+1) << 8 | (uint64_t)(unsigned int)opts.strategy;
+        key k{};
+        murmur3(data,bytes,seed,k.hash);
+        k.size = bytes;
+        return k;
+    }
+
+    zcache::blob zcache::find(const key &k)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(k);
+        if (it == index.end())
+        {
+            ++_misses;
+            return nullptr;
+        }
+        ++_hits;
+        lru.splice(lru.begin(),lru,it->second);
+        return it->second->data;
+    }
+
+    void zcache::insert(const key &k, blob data)
+    {
+        if (!data || data->size() > _capacity) return;
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(k);
+        if (it != index.end())
+        {
+            // Compressed by another thread in the meantime
+            lru.splice(lru.begin(),lru,it->second);
+            return;
+        }
+        _size += data->size();
+        lru.push_front({k,std::move(data)});
+        index.emplace(k,lru.begin());
+        while (_size > _capacity)
+        {
+            auto &last = lru.back();
+            _size -= last.data->size();
+            index.erase(last.k);
+            lru.pop_back();
+        }
+    }
+
+    void zcache::clear()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        index.clear();
+        lru.clear();
+        _size = _hits = _misses = 0;
+    }
+
+    dim_t zcache::size() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return _size;
+    }
+
+    dim_t zcache::hits() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return _hits;
+    }
+
+    dim_t zcache::misses() const
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return _misses;
+    }
+
+}
@@ -18,6 +18,13 @@
  */
 
 #include "matrix.hpp"
+#include "io/estimate.hpp"
+#include "io/fwriter.hpp"
+#include "simd/kernels.hpp"
+#include "trace.hpp"
+
+#include <cstring>
+#include <memory>
 
 namespace mat
 {
@@ -26,31 +33,25 @@ namespace mat
     :
         element(name),
         _class(mxDOUBLE_CLASS),
-        _dims({0,0}),
+        _dims(make_dims(std::vector<dim_t>{0,0},0)),
         _logical(false),
         _complex(false)
     {}
 
     template <>
     matrix::matrix(const std::string &name, std::initializer_list<char> data,
-        const std::vector<dim_t> &dims)
+        const std::vector<dim_t> &dims, array_order order)
     :
-        matrix(name,data.begin(),data.end(),dims)
+        matrix(name,data.begin(),data.end(),dims,order)
     {}
 
-    dim_t utflen(const std::string &str)
-    {
-        int len = 0;
-        const char *s = &str[0];
-        while (*s) len += (*s++ & 0xc0) != 0x80;
-        return len;
-    }
-
     matrix::matrix(const std::string &name, const std::string &str)
     :
         element(name,str),
         _class(mxCHAR_CLASS),
-        _dims(std::vector<dim_t>{1ull,(dim_t)(utflen(str))}),
+        // The string is stored as either ASCII or UTF-16 (see element), so this is its length in
+        // UTF-16 code units
+        _dims(make_dims(std::vector<dim_t>(),_data.size()/(datasize(_type)/8))),
         _logical(false),
         _complex(false)
     {}
@@ -58,7 +59,7 @@ namespace mat
     :
         element(name,str),
         _class(mxCHAR_CLASS),
-        _dims(std::vector<dim_t>{1ull,(dim_t)(str.size())}),
+        _dims(make_dims(std::vector<dim_t>(),str.size())),
         _logical(false),
         _complex(false)
     {}
@@ -66,19 +67,367 @@ namespace mat
     :
         element(name,str),
         _class(mxCHAR_CLASS),
-        _dims(std::vector<dim_t>{1ull,(dim_t)(str.size())}),
+        _dims(make_dims(std::vector<dim_t>(),str.size())),
         _logical(false),
         _complex(false)
     {}
 
+    matrix::matrix(const std::string &name, const std::vector<std::string> &strs)
+    :
+        element(name),
+        _class(mxCHAR_CLASS),
+        _logical(false),
+        _complex(false)
+    {
+        MAT_TRACE_SPAN("matrix::strings");
+        std::vector<dim_t> lengths(strs.size());
+        dim_t cols = 0;
+        bool ascii = true;
+        for (dim_t i = 0; i < strs.size(); ++i)
+        {
+            lengths[i] = simd::utf16_length(strs[i].data(),strs[i].size());
+            cols = std::max(cols,lengths[i]);
+            ascii = ascii && lengths[i] == strs[i].size();
+        }
+
+        // Each string is copied into a row, padded with spaces as MATLAB's char() does, and the
+        // rows are reordered into columns as the matrix is written. As for a single string (see
+        // element::element), rows that are all ASCII are stored as they are, in half the space;
+        // otherwise every row is transcoded to UTF-16
+        _dims = make_dims(std::vector<dim_t>{strs.size(),cols},0);
+        if (ascii)
+        {
+            _type = miUTF8;
+            _data = small_buffer(strs.size()*cols);
+            auto out = ptr<char>();
+            for (dim_t i = 0; i < strs.size(); ++i, out += cols)
+            {
+                std::memcpy(out,strs[i].data(),strs[i].size());
+                std::fill(out+lengths[i],out+cols,' ');
+            }
+        } else {
+            _type = miUTF16;
+            _data = small_buffer(strs.size()*cols*2);
+            auto out = ptr<char16_t>();
+            for (dim_t i = 0; i < strs.size(); ++i, out += cols)
+            {
+                simd::utf8_to_utf16(strs[i].data(),strs[i].size(),out);
+                std::fill(out+lengths[i],out+cols,u' ');
+            }
+        }
+        order(row_major);
+    }
+
+    matrix::matrix(const std::string &name, const std::vector<bool> &mask,
+        const std::vector<dim_t> &dims)
+    :
+        element(name),
+        _class(mxUINT8_CLASS),
+        _dims(make_dims(dims,mask.size())),
+        _logical(true),
+        _complex(false),
+        _packed(true)
+    {
+        dim_t prod = 1;
+        for (auto d : _dims) prod *= d;
+        if (prod != mask.size())
+            throw mfile_error("Matrix dimensions must be commensurate with number of elements.");
+        _type = miUINT8;
+        _data = small_buffer(((prod+63)/64)*8);
+        auto words = ptr<uint64_t>();
+        for (dim_t i = 0; i < prod; ++i)
+            words[i/64] |= (uint64_t)mask[i] << (i & 63);
+    }
+
+    matrix::matrix(const std::string &name, const bitmask &mask, const std::vector<dim_t> &dims)
+    :
+        element(name),
+        _class(mxUINT8_CLASS),
+        _dims(make_dims(dims,mask.numel)),
+        _logical(true),
+        _complex(false),
+        _packed(true)
+    {
+        dim_t prod = 1;
+        for (auto d : _dims) prod *= d;
+        if (prod != mask.numel)
+            throw mfile_error("Matrix dimensions must be commensurate with number of elements.");
+        _type = miUINT8;
+        _data = small_buffer(((prod+63)/64)*8);
+        if (prod) std::memcpy(ptr(),mask.words,(prod+7)/8);
+    }
+
+    matrix::matrix(const std::string &name, std::shared_ptr<source> src,
+        const std::vector<dim_t> &dims)
+    :
+        element(name),
+        _class(src->mclass()),
+        _dims(make_dims(dims,src->numel())),
+        _logical(false),
+        _complex(false),
+        _packed(false),
+        _source(std::move(src))
+    {
+        dim_t prod = 1;
+        for (auto d : _dims) prod *= d;
+        if (prod != _source->numel())
+            throw mfile_error("Matrix dimensions must be commensurate with number of elements.");
+        _type = _source->type();
+        if (!datasize(_type)) throw mfile_error("Source must produce a numeric datatype.");
+    }
+
+    void matrix::order(array_order order)
+    {
+        // Data with at most one dimension larger than 1 is laid out the same either way
+        auto wide = std::count_if(_dims.begin(),_dims.end(),[](dim_t d) { return d > 1; });
+        bool empty = std::find(_dims.begin(),_dims.end(),0) != _dims.end();
+        _order = order == row_major && wide > 1 && !empty ? row_major : column_major;
+    }
+
+    dim_t matrix::plane_bytes() const
+    {
+        if (_source) return _source->numel()*(datasize(_type)/8);
+        if (_packed)
+        {
+            dim_t prod = 1;
+            for (auto d : _dims) prod *= d;
+            return prod;
+        }
+        dim_t n = _data.size();
+        return _complex ? n/2 : n;
+    }
+
     dim_t matrix::size(bool with_name) const {
-        dim_t size = 40 + ceil8(_dims.size()*4) + (_data->size()<=4? 0 : ceil8(_data->size()));
+        MAT_TRACE_SPAN("matrix::size");
+        dim_t n = plane_bytes();
+        dim_t size = 40 + ceil8(_dims.size()*4) + (n<=4? 0 : ceil8(n));
+        // The imaginary part is a second data element, with its own tag
+        if (_complex) size += 8 + (n<=4? 0 : ceil8(n));
         if (with_name) size += (_name.size() > 4 ? ceil8(_name.size()) : 0);
         return size;
     }
 
+    // A buffer of MAT_SCHUNK bytes for data on its way to the writer, kept for each thread so
+    // that it is neither on the stack nor allocated for every matrix
+    static unsigned char *staging()
+    {
+        thread_local std::unique_ptr<unsigned char[]> buf(new unsigned char[MAT_SCHUNK]);
+        return buf.get();
+    }
+
+    template <typename T>
+    static void write_plane(fwriter &fw, const T *data, dim_t n, unsigned int plane)
+    {
+        // Split the data a chunk at a time, so that the separate real and imaginary parts never
+        // exist in full
+        T *buf = (T *)staging();
+        const dim_t chunk = MAT_SCHUNK/sizeof(T);
+        for (dim_t i = 0; i < n; i += chunk)
+        {
+            dim_t m = std::min(chunk, n-i);
+            simd::extract_plane(data+2*i, buf, m, plane);
+            fw.write<T>(buf, m);
+        }
+    }
+
+    void matrix::write_data(fwriter &fw, unsigned int plane)
+    {
+        dim_t n = plane_bytes();
+        if (!n) return;
+        if (auto est = fw.estimate())
+        {
+            // Record the buffers the data would be staged in, and sample it if it is too large
+            // to compress in full
+            const unsigned int width = datasize(_type)/8;
+            if (_order == row_major)
+                est->staging(std::min<dim_t>(n*(_complex ? 2 : 1), MAT_TBUF));
+            else if (_source || _packed || _complex)
+                est->staging(MAT_SCHUNK);
+            if (n > est->limit())
+            {
+                est->sample(n, _packed ? 1 : width, [&](dim_t first, dim_t m, unsigned char *buf) {
+                    read_data(plane, first, m, buf);
+                });
+                return;
+            }
+        }
+        if (_source)
+        {
+            if (auto data = _source->contiguous())
+            {
+                fw.write<unsigned char>((const unsigned char *)data, n);
+                return;
+            }
+            // Pull the data from the source a chunk at a time
+            unsigned char *buf = staging();
+            const dim_t width = datasize(_type)/8, chunk = MAT_SCHUNK/width, numel = n/width;
+            for (dim_t i = 0; i < numel; i += chunk)
+            {
+                dim_t m = std::min(chunk, numel-i);
+                _source->read(i, m, buf);
+                fw.write<unsigned char>(buf, m*width);
+            }
+            return;
+        }
+        if (_packed)
+        {
+            // Expand the mask a chunk at a time, each starting on a word boundary
+            static_assert(MAT_SCHUNK % 64 == 0, "MAT_SCHUNK must be a multiple of 64");
+            unsigned char *buf = staging();
+            auto words = ptr<uint64_t>();
+            for (dim_t i = 0; i < n; i += MAT_SCHUNK)
+            {
+                dim_t m = std::min((dim_t)MAT_SCHUNK, n-i);
+                simd::expand_bits(words+i/64, buf, m);
+                fw.write<unsigned char>(buf, m);
+            }
+            return;
+        }
+        if (_order == row_major)
+        {
+            write_row_major(fw, plane);
+            return;
+        }
+        if (!_complex)
+        {
+            fw.write<unsigned char>(ptr(),n);
+            return;
+        }
+        switch (_type)
+        {
+            case miSINGLE:
+                write_plane(fw, ptr<float>(), n/sizeof(float), plane);
+                return;
+            case miDOUBLE:
+                write_plane(fw, ptr<double>(), n/sizeof(double), plane);
+                return;
+            default:
+                throw mfile_error("Complex matrices must contain single or double data.");
+        }
+    }
+
+    void matrix::read_data(unsigned int plane, dim_t first, dim_t n, unsigned char *buf)
+    {
+        if (_source)
+        {
+            _source->read(first, n, buf);
+            return;
+        }
+        if (_packed)
+        {
+            // Windows start on a word boundary
+            simd::expand_bits(ptr<uint64_t>()+first/64, buf, n);
+            return;
+        }
+        const dim_t width = datasize(_type)/8, parts = _complex ? 2 : 1;
+        const unsigned char *data = ptr();
+        if (_order == column_major && !_complex)
+        {
+            std::memcpy(buf, data + first*width, n*width);
+            return;
+        }
+        // The offset of each value as stored, from its index in column-major order
+        const dim_t k = _dims.size();
+        std::vector<dim_t> strides(k, 1);
+        if (_order == row_major)
+            for (dim_t a = k-1; a > 0; --a) strides[a-1] = strides[a]*_dims[a];
+        else
+            for (dim_t a = 1; a < k; ++a) strides[a] = strides[a-1]*_dims[a-1];
+        for (dim_t i = first; i < first+n; ++i)
+        {
+            dim_t offset = 0, rest = i;
+            for (dim_t a = 0; a < k; ++a)
+            {
+                offset += (rest % _dims[a])*strides[a];
+                rest /= _dims[a];
+            }
+            std::memcpy(buf + (i-first)*width, data + (offset*parts+plane)*width, width);
+        }
+    }
+
+    void matrix::write_row_major(fwriter &fw, unsigned int plane)
+    {
+        MAT_TRACE_SPAN("matrix::write_row_major");
+        // Each value as stored, with both parts for complex matrices
+        const dim_t width = (datasize(_type)/8) * (_complex ? 2 : 1);
+        const dim_t k = _dims.size(), rows = _dims[0], last = _dims[k-1];
+        // The distance between consecutive values of each index in the stored data
+        std::vector<dim_t> strides(k, 1);
+        for (dim_t a = k-1; a > 0; --a) strides[a-1] = strides[a]*_dims[a];
+        const dim_t numel = strides[0]*rows;
+
+        // MATLAB expects the values with the first index varying fastest and the last slowest,
+        // while the last varies fastest as stored. So the values are written a few columns (of
+        // the last index) at a time: for each set of the middle indices, a block of rows x
+        // columns values is transposed into place. Each column gives a slab of numel/last
+        // values. Columns are taken a cache line at a time if the buffer holds that many slabs;
+        // if it can't even hold one, each slab is gathered and written in pieces.
+        const dim_t slab = numel/last, mids = slab/rows;
+        const dim_t piece = std::min(slab, std::max<dim_t>(MAT_TBUF/width, 1));
+        const dim_t line = std::max<dim_t>(64/width, 1);
+        const dim_t cols = piece < slab ? 1
+            : std::min({line, last, std::max<dim_t>(MAT_TBUF/(slab*width), 1)});
+        std::vector<unsigned char> buf(cols*piece*width);
+        const unsigned char *data = ptr();
+
+        // Moves on to the next set of middle indices (the second varying fastest), returning
+        // the offset of the values it selects
+        std::vector<dim_t> index(k, 0);
+        auto advance = [&](dim_t offset) {
+            for (dim_t a = 1; a+1 < k; ++a)
+            {
+                if (++index[a] < _dims[a]) return offset + strides[a];
+                index[a] = 0;
+                offset -= (_dims[a]-1)*strides[a];
+            }
+            return offset;
+        };
+
+        auto emit = [&](dim_t n) {
+            if (!_complex) fw.write<unsigned char>(buf.data(), n*width);
+            else if (_type == miSINGLE) write_plane(fw, (const float *)buf.data(), n, plane);
+            else write_plane(fw, (const double *)buf.data(), n, plane);
+        };
+
+        for (dim_t j = 0; j < last; j += cols)
+        {
+            dim_t c = std::min(cols, last-j), offset = 0;
+            if (piece == slab)
+            {
+                for (dim_t m = 0; m < mids; ++m)
+                {
+                    simd::transpose(data + (offset+j)*width, strides[0], buf.data() + m*rows*width,
+                        slab, rows, c, width);
+                    offset = advance(offset);
+                }
+                emit(c*slab);
+                continue;
+            }
+            dim_t filled = 0;
+            for (dim_t m = 0; m < mids; ++m)
+            {
+                for (dim_t i = 0; i < rows; )
+                {
+                    dim_t n = std::min(rows-i, piece-filled);
+                    simd::transpose(data + (offset+i*strides[0]+j)*width, strides[0],
+                        buf.data() + filled*width, 1, n, 1, width);
+                    filled += n;
+                    i += n;
+                    if (filled == piece)
+                    {
+                        emit(filled);
+                        filled = 0;
+                    }
+                }
+                offset = advance(offset);
+            }
+            if (filled) emit(filled);
+        }
+    }
+
     void matrix::write(fwriter& fw, file_version v, bool write_name)
     {
+        MAT_TRACE_SPAN("matrix::write");
         switch(v)
         {
             // Writing for V6 and V7 is the same -- only the compression at the end differs
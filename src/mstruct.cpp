@@ -18,6 +18,7 @@
  */
 
 #include "mstruct.hpp"
+#include "trace.hpp"
 
 namespace mat
 {
@@ -30,6 +31,7 @@ namespace mat
 
     [[nodiscard]] dim_t mstruct::size(bool with_name) const
     {
+        MAT_TRACE_SPAN("mstruct::size");
         dim_t size = 56;
         if (with_name) size += _name.size()> 4 ? ceil8(_name.size()) : 0;
 
@@ -44,6 +46,7 @@ namespace mat
 
     void mstruct::write(fwriter& fw, file_version v, bool write_name)
     {
+        MAT_TRACE_SPAN("mstruct::write");
         switch(v)
         {
             // Writing for V6 and V7 is the same -- only the compression at the end differs
@@ -72,5 +75,59 @@ namespace mat
         container::add(name,str);
         return *this;
     }
+    mstruct &mstruct::add(const std::string &name, const std::vector<std::string> &strs)
+    {
+        container::add(name,strs);
+        return *this;
+    }
+    mstruct &mstruct::add(const std::string &name, const std::vector<bool> &mask,
+        const std::vector<dim_t> &dims)
+    {
+        container::add(name,mask,dims);
+        return *this;
+    }
+    mstruct &mstruct::add(const std::string &name, const bitmask &mask,
+        const std::vector<dim_t> &dims)
+    {
+        container::add(name,mask,dims);
+        return *this;
+    }
+    mstruct &mstruct::add(const std::string &name, std::shared_ptr<source> src,
+        const std::vector<dim_t> &dims)
+    {
+        container::add(name,std::move(src),dims);
+        return *this;
+    }
+    mstruct &mstruct::add(const std::string &name,
+        const std::vector<std::chrono::system_clock::time_point> &t,
+        const std::vector<dim_t> &dims)
+    {
+        container::add(name,t,dims);
+        return *this;
+    }
+    mstruct &mstruct::add_time(const std::string &name, time_epoch epoch, const double *t,
+        dim_t numel, const std::vector<dim_t> &dims)
+    {
+        container::add_time(name,epoch,t,numel,dims);
+        return *this;
+    }
+    mstruct &mstruct::add_time(const std::string &name, time_epoch epoch, const long long *t,
+        dim_t numel, const std::vector<dim_t> &dims)
+    {
+        container::add_time(name,epoch,t,numel,dims);
+        return *this;
+    }
+    mstruct &mstruct::add_time(const std::string &name, time_epoch epoch, const long *t,
+        dim_t numel, const std::vector<dim_t> &dims)
+    {
+        container::add_time(name,epoch,t,numel,dims);
+        return *this;
+    }
+    mstruct &mstruct::add_half(const std::string &name, half_format format, const uint16_t *data,
+        dim_t numel, const std::vector<dim_t> &dims)
+    {
+        container::add_half(name,format,data,numel,dims);
+        return *this;
+    }
 
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+ * 2mat/simd/complex.cpp -- kernels for splitting interleaved complex data into planes
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        void extract_plane(const float *src, float *dst, dim_t n, unsigned int lane)
+        {
+            dim_t i = 0;
+#if defined(__AVX2__)
+            // Each 128-bit half of the shuffle picks two values from a and two from b, so the
+            // result needs a cross-lane permute to put the values back in order
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256 a = _mm256_loadu_ps(src + 2*i);
+                __m256 b = _mm256_loadu_ps(src + 2*i + 8);
+                __m256 s = lane ? _mm256_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1))
+                                : _mm256_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0));
+                s = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(s),
+                        _MM_SHUFFLE(3,1,2,0)));
+                _mm256_storeu_ps(dst + i, s);
+            }
+#endif
+#if defined(__SSE2__)
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128 a = _mm_loadu_ps(src + 2*i);
+                __m128 b = _mm_loadu_ps(src + 2*i + 4);
+                __m128 s = lane ? _mm_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1))
+                                : _mm_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0));
+                _mm_storeu_ps(dst + i, s);
+            }
+#endif
+            for (; i < n; ++i) dst[i] = src[2*i+lane];
+        }
+
+        void extract_plane(const double *src, double *dst, dim_t n, unsigned int lane)
+        {
+            dim_t i = 0;
+#if defined(__AVX2__)
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256d a = _mm256_loadu_pd(src + 2*i);
+                __m256d b = _mm256_loadu_pd(src + 2*i + 4);
+                __m256d s = lane ? _mm256_unpackhi_pd(a,b) : _mm256_unpacklo_pd(a,b);
+                _mm256_storeu_pd(dst + i, _mm256_permute4x64_pd(s,_MM_SHUFFLE(3,1,2,0)));
+            }
+#endif
+#if defined(__SSE2__)
+            for (; i + 2 <= n; i += 2)
+            {
+                __m128d a = _mm_loadu_pd(src + 2*i);
+                __m128d b = _mm_loadu_pd(src + 2*i + 2);
+                _mm_storeu_pd(dst + i, lane ? _mm_unpackhi_pd(a,b) : _mm_unpacklo_pd(a,b));
+            }
+#endif
+            for (; i < n; ++i) dst[i] = src[2*i+lane];
+        }
+
+    }
+
+}
@@ -0,0 +1,69 @@
+/*
+ * 2mat/simd/datenum.cpp -- kernels for converting arrays of timestamps to datenums
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        // Note that the division is kept as a division -- multiplying by the reciprocal would be
+        // faster, but would not round identically to the scalar routines
+
+        void divide_add(const double *src, double *dst, dim_t n, double d, double a)
+        {
+            dim_t i = 0;
+#if defined(__AVX__)
+            const __m256d d256 = _mm256_set1_pd(d), a256 = _mm256_set1_pd(a);
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(dst+i, _mm256_add_pd(a256, _mm256_div_pd(_mm256_loadu_pd(src+i), d256)));
+#endif
+#if defined(__SSE2__)
+            const __m128d d128 = _mm_set1_pd(d), a128 = _mm_set1_pd(a);
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(dst+i, _mm_add_pd(a128, _mm_div_pd(_mm_loadu_pd(src+i), d128)));
+#endif
+            for (; i < n; ++i) dst[i] = a + src[i]/d;
+        }
+
+        void add_subtract(const double *src, double *dst, dim_t n, double a, double b)
+        {
+            dim_t i = 0;
+#if defined(__AVX__)
+            const __m256d a256 = _mm256_set1_pd(a), b256 = _mm256_set1_pd(b);
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(dst+i, _mm256_sub_pd(_mm256_add_pd(_mm256_loadu_pd(src+i), a256), b256));
+#endif
+#if defined(__SSE2__)
+            const __m128d a128 = _mm_set1_pd(a), b128 = _mm_set1_pd(b);
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(dst+i, _mm_sub_pd(_mm_add_pd(_mm_loadu_pd(src+i), a128), b128));
+#endif
+            for (; i < n; ++i) dst[i] = src[i] + a - b;
+        }
+
+    }
+
+}
@@ -0,0 +1,125 @@
+/*
+ * 2mat/simd/gather.cpp -- kernels for gathering strided data into contiguous arrays
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+#include "util.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        namespace
+        {
+            struct u128
+            {
+                uint64_t lo, hi;
+            };
+
+            template <typename T>
+            void strided(const T *src, std::ptrdiff_t stride, T *dst, dim_t n)
+            {
+                if (stride == 1)
+                {
+                    std::memcpy(dst, src, n*sizeof(T));
+                    return;
+                }
+                dim_t i = 0;
+                for (; i + 4 <= n; i += 4, src += 4*stride)
+                {
+                    dst[i] = src[0];
+                    dst[i+1] = src[stride];
+                    dst[i+2] = src[2*stride];
+                    dst[i+3] = src[3*stride];
+                }
+                for (; i < n; ++i, src += stride) dst[i] = *src;
+            }
+        }
+
+        void gather(const unsigned char *src, std::ptrdiff_t stride, unsigned char *dst, dim_t n,
+            unsigned int width)
+        {
+            switch (width)
+            {
+                case 1:
+                    strided(src, stride, dst, n);
+                    return;
+                case 2:
+                    strided((const uint16_t *)src, stride, (uint16_t *)dst, n);
+                    return;
+                case 4:
+                {
+                    dim_t i = 0;
+#if defined(__AVX2__)
+                    // The offsets of eight values must fit the 32-bit indices of the gather
+                    if (stride != 1 && stride > -(INT32_MAX/8) && stride < INT32_MAX/8)
+                    {
+                        const int s = (int)stride;
+                        const __m256i idx = _mm256_setr_epi32(0, s, 2*s, 3*s, 4*s, 5*s, 6*s, 7*s);
+                        for (; i + 8 <= n; i += 8)
+                        {
+                            auto from = (const int *)src + (std::ptrdiff_t)i*stride;
+                            __m256i v = _mm256_i32gather_epi32(from, idx, 4);
+                            _mm256_storeu_si256((__m256i *)(dst + 4*i), v);
+                        }
+                    }
+#endif
+                    auto from = (const uint32_t *)src + (std::ptrdiff_t)i*stride;
+                    strided(from, stride, (uint32_t *)dst + i, n-i);
+                    return;
+                }
+                case 8:
+                {
+                    dim_t i = 0;
+#if defined(__AVX2__)
+                    if (stride != 1)
+                    {
+                        const long long s = stride;
+                        const __m256i idx = _mm256_setr_epi64x(0, s, 2*s, 3*s);
+                        for (; i + 4 <= n; i += 4)
+                        {
+                            auto from = (const long long *)src + (std::ptrdiff_t)i*stride;
+                            __m256i v = _mm256_i64gather_epi64(from, idx, 8);
+                            _mm256_storeu_si256((__m256i *)(dst + 8*i), v);
+                        }
+                    }
+#endif
+                    auto from = (const uint64_t *)src + (std::ptrdiff_t)i*stride;
+                    strided(from, stride, (uint64_t *)dst + i, n-i);
+                    return;
+                }
+                case 16:
+                    strided((const u128 *)src, stride, (u128 *)dst, n);
+                    return;
+                default:
+                    throw mfile_error("Cannot gather values of this size");
+            }
+        }
+
+    }
+
+}
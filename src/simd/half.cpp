@@ -0,0 +1,104 @@
+/*
+ * 2mat/simd/half.cpp -- kernels for widening 16-bit floating point values to single precision
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        namespace
+        {
+            inline float from_bits(uint32_t bits)
+            {
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                return f;
+            }
+
+            // Widens one binary16 value, rebiasing the exponent of normal numbers and scaling
+            // subnormals (which are all normal in single precision). NaNs are made quiet, as
+            // F16C does, so the result does not depend on the instructions available.
+            inline float widen(uint16_t h)
+            {
+                const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+                const uint32_t exp = (h >> 10) & 0x1f, mant = h & 0x3ff;
+                if (exp == 0x1f)
+                    return from_bits(sign | 0x7f800000 | (mant ? 0x400000 : 0) | mant << 13);
+                if (exp) return from_bits(sign | (exp + 112) << 23 | mant << 13);
+                // mant * 2^-24, which is exact
+                float f = (float)mant * 5.9604644775390625e-8f;
+                return sign ? -f : f;
+            }
+        }
+
+        void widen_half(const uint16_t *src, float *dst, dim_t n)
+        {
+            dim_t i = 0;
+#if defined(__AVX512F__)
+            for (; i + 16 <= n; i += 16)
+            {
+                __m256i h = _mm256_loadu_si256((const __m256i *)(src + i));
+                _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(h));
+            }
+#endif
+#if defined(__F16C__)
+            for (; i + 8 <= n; i += 8)
+            {
+                __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+                _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+            }
+#endif
+            for (; i < n; ++i) dst[i] = widen(src[i]);
+        }
+
+        void widen_bfloat16(const uint16_t *src, float *dst, dim_t n)
+        {
+            // A bfloat16 is the top 16 bits of a single
+            dim_t i = 0;
+#if defined(__AVX2__)
+            for (; i + 8 <= n; i += 8)
+            {
+                __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+                __m256i f = _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16);
+                _mm256_storeu_si256((__m256i *)(dst + i), f);
+            }
+#elif defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= n; i += 8)
+            {
+                __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+                _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(zero, h));
+                _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(zero, h));
+            }
+#endif
+            for (; i < n; ++i) dst[i] = from_bits((uint32_t)src[i] << 16);
+        }
+
+    }
+
+}
@@ -0,0 +1,88 @@
+/*
+ * 2mat/simd/logical.cpp -- kernels for expanding bit-packed logical masks
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        // Expands the 8 bits of b to 8 bytes of 0 or 1, without SIMD instructions
+        static inline uint64_t expand8(uint64_t b)
+        {
+            // Copy b to every byte, keep bit k in byte k, and then turn any non-zero byte into 1
+            uint64_t x = (b * 0x0101010101010101ull) & 0x8040201008040201ull;
+            return ((x + 0x7f7f7f7f7f7f7f7full) & 0x8080808080808080ull) >> 7;
+        }
+
+        void expand_bits(const uint64_t *words, unsigned char *dst, dim_t n)
+        {
+            dim_t i = 0;
+#if defined(__AVX512BW__)
+            const __m512i one512 = _mm512_set1_epi8(1);
+            for (; i + 64 <= n; i += 64)
+                _mm512_storeu_si512(dst + i, _mm512_maskz_mov_epi8(words[i/64], one512));
+#elif defined(__AVX2__)
+            // Each byte of the mask is broadcast to 8 bytes, which are then tested against the
+            // bit each one represents
+            const __m256i shuf = _mm256_setr_epi8(0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,
+                                                  2,2,2,2,2,2,2,2,3,3,3,3,3,3,3,3);
+            const __m256i bits256 = _mm256_set1_epi64x((long long)0x8040201008040201ull);
+            const __m256i one256 = _mm256_set1_epi8(1);
+            for (; i + 32 <= n; i += 32)
+            {
+                uint32_t b = (uint32_t)(words[i/64] >> (i & 63));
+                __m256i x = _mm256_shuffle_epi8(_mm256_set1_epi32((int)b), shuf);
+                x = _mm256_cmpeq_epi8(_mm256_and_si256(x,bits256),bits256);
+                _mm256_storeu_si256((__m256i *)(dst + i), _mm256_and_si256(x,one256));
+            }
+#endif
+#if defined(__SSE2__)
+            const __m128i bits128 = _mm_set1_epi64x((long long)0x8040201008040201ull);
+            const __m128i one128 = _mm_set1_epi8(1);
+            for (; i + 16 <= n; i += 16)
+            {
+                uint32_t b = (uint16_t)(words[i/64] >> (i & 63));
+                __m128i x = _mm_cvtsi32_si128((int)b);
+                x = _mm_unpacklo_epi8(x,x);
+                x = _mm_unpacklo_epi16(x,x);
+                x = _mm_unpacklo_epi32(x,x);
+                x = _mm_cmpeq_epi8(_mm_and_si128(x,bits128),bits128);
+                _mm_storeu_si128((__m128i *)(dst + i), _mm_and_si128(x,one128));
+            }
+#endif
+            for (; i + 8 <= n; i += 8)
+            {
+                uint64_t x = expand8((words[i/64] >> (i & 63)) & 0xff);
+                std::memcpy(dst + i, &x, 8);
+            }
+            for (; i < n; ++i) dst[i] = (words[i/64] >> (i & 63)) & 1;
+        }
+
+    }
+
+}
@@ -0,0 +1,238 @@
+/*
+ * 2mat/simd/transpose.cpp -- kernels for transposing blocks of row-major data
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Size of the square tiles a block is transposed in, in values
+static const mat::dim_t TILE = 32;
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        namespace
+        {
+            struct u128
+            {
+                uint64_t lo, hi;
+            };
+
+            /*
+             * Transposes the block a TILE x TILE tile at a time, using kernel for each K x K
+             * square within the tile (if K > 1), and copying the edges one value at a time.
+             * kernel(s, ss, d, ds) transposes the K x K square at s into d.
+             */
+            template <typename T, unsigned int K, typename F>
+            void blocked(const T *src, dim_t ss, T *dst, dim_t ds, dim_t rows, dim_t cols,
+                F kernel)
+            {
+                for (dim_t i0 = 0; i0 < rows; i0 += TILE)
+                {
+                    dim_t i1 = std::min(i0+TILE,rows);
+                    for (dim_t j0 = 0; j0 < cols; j0 += TILE)
+                    {
+                        dim_t j1 = std::min(j0+TILE,cols);
+                        dim_t ik = i0, jk = j0;
+                        if (K > 1)
+                        {
+                            ik = i0 + (i1-i0)/K*K;
+                            jk = j0 + (j1-j0)/K*K;
+                            for (dim_t i = i0; i < ik; i += K)
+                                for (dim_t j = j0; j < jk; j += K)
+                                    kernel(src + i*ss + j, ss, dst + j*ds + i, ds);
+                        }
+                        for (dim_t i = i0; i < i1; ++i)
+                            for (dim_t j = i < ik ? jk : j0; j < j1; ++j)
+                                dst[j*ds + i] = src[i*ss + j];
+                    }
+                }
+            }
+
+            template <typename T>
+            void scalar(const T *src, dim_t ss, T *dst, dim_t ds, dim_t rows, dim_t cols)
+            {
+                blocked<T,1>(src,ss,dst,ds,rows,cols,[](const T *, dim_t, T *, dim_t) {});
+            }
+
+#if defined(__SSE2__)
+            inline __m128i load(const void *p)
+            {
+                return _mm_loadu_si128((const __m128i *)p);
+            }
+
+            inline void store(void *p, __m128i v)
+            {
+                _mm_storeu_si128((__m128i *)p, v);
+            }
+
+            // 16 x 16 bytes: interleave pairs of rows, then pairs of pairs, and so on, doubling
+            // the width of the values interleaved each time
+            void kernel8(const uint8_t *s, dim_t ss, uint8_t *d, dim_t ds)
+            {
+                __m128i r[16], t[16];
+                for (int i = 0; i < 16; ++i) r[i] = load(s + i*ss);
+                for (int p = 0; p < 8; ++p)
+                {
+                    t[2*p] = _mm_unpacklo_epi8(r[2*p], r[2*p+1]);
+                    t[2*p+1] = _mm_unpackhi_epi8(r[2*p], r[2*p+1]);
+                }
+                for (int q = 0; q < 4; ++q)
+                {
+                    r[4*q] = _mm_unpacklo_epi16(t[4*q], t[4*q+2]);
+                    r[4*q+1] = _mm_unpackhi_epi16(t[4*q], t[4*q+2]);
+                    r[4*q+2] = _mm_unpacklo_epi16(t[4*q+1], t[4*q+3]);
+                    r[4*q+3] = _mm_unpackhi_epi16(t[4*q+1], t[4*q+3]);
+                }
+                for (int h = 0; h < 2; ++h)
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        t[8*h+2*c] = _mm_unpacklo_epi32(r[8*h+c], r[8*h+4+c]);
+                        t[8*h+2*c+1] = _mm_unpackhi_epi32(r[8*h+c], r[8*h+4+c]);
+                    }
+                for (int e = 0; e < 8; ++e)
+                {
+                    store(d + 2*e*ds, _mm_unpacklo_epi64(t[e], t[8+e]));
+                    store(d + (2*e+1)*ds, _mm_unpackhi_epi64(t[e], t[8+e]));
+                }
+            }
+
+            // 8 x 8 16-bit values
+            void kernel16(const uint16_t *s, dim_t ss, uint16_t *d, dim_t ds)
+            {
+                __m128i r[8], a[8];
+                for (int i = 0; i < 8; ++i) r[i] = load(s + i*ss);
+                for (int p = 0; p < 4; ++p)
+                {
+                    a[2*p] = _mm_unpacklo_epi16(r[2*p], r[2*p+1]);
+                    a[2*p+1] = _mm_unpackhi_epi16(r[2*p], r[2*p+1]);
+                }
+                for (int h = 0; h < 2; ++h)
+                {
+                    r[4*h] = _mm_unpacklo_epi32(a[4*h], a[4*h+2]);
+                    r[4*h+1] = _mm_unpackhi_epi32(a[4*h], a[4*h+2]);
+                    r[4*h+2] = _mm_unpacklo_epi32(a[4*h+1], a[4*h+3]);
+                    r[4*h+3] = _mm_unpackhi_epi32(a[4*h+1], a[4*h+3]);
+                }
+                for (int c = 0; c < 4; ++c)
+                {
+                    store(d + 2*c*ds, _mm_unpacklo_epi64(r[c], r[4+c]));
+                    store(d + (2*c+1)*ds, _mm_unpackhi_epi64(r[c], r[4+c]));
+                }
+            }
+
+            // 4 x 4 32-bit values
+            void kernel32(const uint32_t *s, dim_t ss, uint32_t *d, dim_t ds)
+            {
+                __m128 r0 = _mm_castsi128_ps(load(s));
+                __m128 r1 = _mm_castsi128_ps(load(s + ss));
+                __m128 r2 = _mm_castsi128_ps(load(s + 2*ss));
+                __m128 r3 = _mm_castsi128_ps(load(s + 3*ss));
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                store(d, _mm_castps_si128(r0));
+                store(d + ds, _mm_castps_si128(r1));
+                store(d + 2*ds, _mm_castps_si128(r2));
+                store(d + 3*ds, _mm_castps_si128(r3));
+            }
+
+#if defined(__AVX__)
+            // 4 x 4 64-bit values: swap within each 128-bit lane, then swap the lanes
+            void kernel64(const uint64_t *s, dim_t ss, uint64_t *d, dim_t ds)
+            {
+                __m256d r0 = _mm256_loadu_pd((const double *)s);
+                __m256d r1 = _mm256_loadu_pd((const double *)(s + ss));
+                __m256d r2 = _mm256_loadu_pd((const double *)(s + 2*ss));
+                __m256d r3 = _mm256_loadu_pd((const double *)(s + 3*ss));
+                __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+                __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+                _mm256_storeu_pd((double *)d, _mm256_permute2f128_pd(t0, t2, 0x20));
+                _mm256_storeu_pd((double *)(d + ds), _mm256_permute2f128_pd(t1, t3, 0x20));
+                _mm256_storeu_pd((double *)(d + 2*ds), _mm256_permute2f128_pd(t0, t2, 0x31));
+                _mm256_storeu_pd((double *)(d + 3*ds), _mm256_permute2f128_pd(t1, t3, 0x31));
+            }
+            static const unsigned int K64 = 4;
+#else
+            // 2 x 2 64-bit values
+            void kernel64(const uint64_t *s, dim_t ss, uint64_t *d, dim_t ds)
+            {
+                __m128i r0 = load(s), r1 = load(s + ss);
+                store(d, _mm_unpacklo_epi64(r0, r1));
+                store(d + ds, _mm_unpackhi_epi64(r0, r1));
+            }
+            static const unsigned int K64 = 2;
+#endif
+#endif
+        }
+
+        void transpose(const unsigned char *src, dim_t sstride, unsigned char *dst, dim_t dstride,
+            dim_t rows, dim_t cols, unsigned int width)
+        {
+            switch (width)
+            {
+                case 1:
+#if defined(__SSE2__)
+                    blocked<uint8_t,16>(src,sstride,dst,dstride,rows,cols,kernel8);
+#else
+                    scalar((const uint8_t *)src,sstride,(uint8_t *)dst,dstride,rows,cols);
+#endif
+                    return;
+                case 2:
+#if defined(__SSE2__)
+                    blocked<uint16_t,8>((const uint16_t *)src,sstride,(uint16_t *)dst,dstride,
+                        rows,cols,kernel16);
+#else
+                    scalar((const uint16_t *)src,sstride,(uint16_t *)dst,dstride,rows,cols);
+#endif
+                    return;
+                case 4:
+#if defined(__SSE2__)
+                    blocked<uint32_t,4>((const uint32_t *)src,sstride,(uint32_t *)dst,dstride,
+                        rows,cols,kernel32);
+#else
+                    scalar((const uint32_t *)src,sstride,(uint32_t *)dst,dstride,rows,cols);
+#endif
+                    return;
+                case 8:
+#if defined(__SSE2__)
+                    blocked<uint64_t,K64>((const uint64_t *)src,sstride,(uint64_t *)dst,dstride,
+                        rows,cols,kernel64);
+#else
+                    scalar((const uint64_t *)src,sstride,(uint64_t *)dst,dstride,rows,cols);
+#endif
+                    return;
+                case 16:
+                    scalar((const u128 *)src,sstride,(u128 *)dst,dstride,rows,cols);
+                    return;
+                default:
+                    throw mfile_error("Cannot transpose values of this size");
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,130 @@
+/*
+ * 2mat/simd/utf8.cpp -- kernels for validating and transcoding UTF-8 strings
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "simd/kernels.hpp"
+#include "util.hpp"
+
+#include <string>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace mat
+{
+
+    namespace simd
+    {
+
+        namespace
+        {
+            /*
+             * Decodes the multi-byte sequence at s (of which n bytes remain), returning its length
+             * and setting cp to its code point. Truncated sequences, stray continuation bytes,
+             * overlong encodings, surrogates and code points beyond U+10FFFF are all rejected.
+             */
+            unsigned int decode(const unsigned char *s, dim_t n, dim_t at, char32_t &cp)
+            {
+                const unsigned char c = s[0];
+                unsigned int len;
+                char32_t min;
+                if (c >= 0xc2 && c < 0xe0) { len = 2; cp = c & 0x1f; min = 0x80; }
+                else if (c >= 0xe0 && c < 0xf0) { len = 3; cp = c & 0x0f; min = 0x800; }
+                else if (c >= 0xf0 && c < 0xf5) { len = 4; cp = c & 0x07; min = 0x10000; }
+                else len = 0;
+                bool valid = len && len <= n;
+                for (unsigned int k = 1; valid && k < len; ++k)
+                {
+                    valid = (s[k] & 0xc0) == 0x80;
+                    cp = (cp << 6) | (s[k] & 0x3f);
+                }
+                if (!valid || cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp < 0xe000))
+                    throw mfile_error("Invalid UTF-8 at byte " + std::to_string(at) + " of string.");
+                return len;
+            }
+
+            // The number of leading bytes of s (at most n) which are ASCII, checked 16 at a time
+            inline dim_t ascii_run(const unsigned char *s, dim_t n)
+            {
+                dim_t i = 0;
+#if defined(__SSE2__)
+                for (; i + 16 <= n; i += 16)
+                {
+                    int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i)));
+                    if (mask) return i + __builtin_ctz(mask);
+                }
+#endif
+                while (i < n && s[i] < 0x80) ++i;
+                return i;
+            }
+        }
+
+        dim_t utf16_length(const char *src, dim_t n)
+        {
+            auto s = (const unsigned char *)src;
+            dim_t i = 0, units = 0;
+            while (i < n)
+            {
+                dim_t run = ascii_run(s + i, n - i);
+                i += run;
+                units += run;
+                if (i == n) break;
+                char32_t cp;
+                i += decode(s + i, n - i, i, cp);
+                units += cp > 0xffff ? 2 : 1;
+            }
+            return units;
+        }
+
+        dim_t utf8_to_utf16(const char *src, dim_t n, char16_t *dst)
+        {
+            auto s = (const unsigned char *)src;
+            char16_t *out = dst;
+            dim_t i = 0;
+            while (i < n)
+            {
+#if defined(__SSE2__)
+                // Widen runs of ASCII 16 bytes at a time
+                const __m128i zero = _mm_setzero_si128();
+                for (; i + 16 <= n; i += 16, out += 16)
+                {
+                    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+                    if (_mm_movemask_epi8(v)) break;
+                    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(v, zero));
+                    _mm_storeu_si128((__m128i *)(out + 8), _mm_unpackhi_epi8(v, zero));
+                }
+#endif
+                for (; i < n && s[i] < 0x80; ++i) *out++ = s[i];
+                if (i == n) break;
+                char32_t cp;
+                i += decode(s + i, n - i, i, cp);
+                if (cp > 0xffff)
+                {
+                    cp -= 0x10000;
+                    *out++ = (char16_t)(0xd800 + (cp >> 10));
+                    *out++ = (char16_t)(0xdc00 + (cp & 0x3ff));
+                }
+                else *out++ = (char16_t)cp;
+            }
+            return out - dst;
+        }
+
+    }
+
+}
@@ -0,0 +1,245 @@
+/*
+ * 2mat/trace.cpp -- implementation for trace.hpp
+ * 
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ * 
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trace.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+namespace mat
+{
+
+    namespace trace
+    {
+
+        namespace
+        {
+
+            struct event
+            {
+                const char *name;
+                uint64_t start, end;
+            };
+
+            // Events are only ever appended by the owning thread; count is published with a
+            // release store, so a reader sees every event below the count it loads
+            struct chunk
+            {
+                event events[MAT_TRACE_CHUNK];
+                std::atomic<unsigned int> count{0};
+                std::atomic<chunk *> next{nullptr};
+            };
+
+            // The spans of a single thread. Only the owning thread appends to its buffer; the list
+            // of buffers is guarded by the lock, which dump() holds while it reads them, so a
+            // buffer is only freed (by clear(), once its thread has exited) when nobody reads it
+            struct buffer
+            {
+                unsigned int tid;
+                chunk *head, *tail;
+                unsigned int chunks = 1;
+                // The clear() the buffer was last compacted after (see recycle)
+                uint64_t cleared = 0;
+                bool exited = false;
+                buffer *next = nullptr;
+
+                ~buffer()
+                {
+                    while (head)
+                    {
+                        chunk *c = head;
+                        head = c->next.load(std::memory_order_relaxed);
+                        delete c;
+                    }
+                }
+            };
+
+            std::mutex lock;
+            buffer *buffers = nullptr;
+            std::atomic<unsigned int> next_tid{1};
+            std::atomic<uint64_t> since{0};
+
+            std::chrono::steady_clock::time_point epoch()
+            {
+                static const auto start = std::chrono::steady_clock::now();
+                return start;
+            }
+
+            // Marks the buffer of a thread as finished when the thread exits; its spans are kept
+            // for dump() until the next clear()
+            struct owner
+            {
+                buffer *b = nullptr;
+
+                ~owner()
+                {
+                    if (!b) return;
+                    std::lock_guard<std::mutex> guard(lock);
+                    b->exited = true;
+                }
+            };
+
+            buffer *local()
+            {
+                thread_local owner o;
+                if (o.b) return o.b;
+                auto *b = new buffer;
+                b->tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+                b->head = b->tail = new chunk;
+                std::lock_guard<std::mutex> guard(lock);
+                b->next = buffers;
+                buffers = b;
+                return o.b = b;
+            }
+
+            // Makes room in the full buffer of the calling thread by dropping the spans that started
+            // before the last clear(), which are never dumped, and packing the rest at the front.
+            // The lock keeps dump() from reading the buffer meanwhile. Returns whether there is
+            // now room for another span
+            bool recycle(buffer *b)
+            {
+                uint64_t from = since.load(std::memory_order_relaxed);
+                if (from <= b->cleared) return false;
+                std::lock_guard<std::mutex> guard(lock);
+                b->cleared = from;
+                chunk *dst = b->head;
+                unsigned int m = 0, chunks = 1;
+                for (chunk *c = b->head; c; c = c->next.load(std::memory_order_relaxed))
+                {
+                    unsigned int n = c->count.load(std::memory_order_relaxed);
+                    for (unsigned int i = 0; i < n; ++i)
+                    {
+                        if (c->events[i].start < from) continue;
+                        if (m == MAT_TRACE_CHUNK)
+                        {
+                            dst = dst->next.load(std::memory_order_relaxed);
+                            m = 0;
+                            chunks++;
+                        }
+                        dst->events[m++] = c->events[i];
+                    }
+                }
+                for (chunk *c = b->head; c != dst; c = c->next.load(std::memory_order_relaxed))
+                    c->count.store(MAT_TRACE_CHUNK, std::memory_order_relaxed);
+                dst->count.store(m, std::memory_order_relaxed);
+                chunk *rest = dst->next.exchange(nullptr, std::memory_order_relaxed);
+                while (rest)
+                {
+                    chunk *c = rest;
+                    rest = c->next.load(std::memory_order_relaxed);
+                    delete c;
+                }
+                b->tail = dst;
+                b->chunks = chunks;
+                return m < MAT_TRACE_CHUNK || chunks < MAT_TRACE_CHUNKS;
+            }
+
+        }
+
+        uint64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now()-epoch()).count();
+        }
+
+        void record(const char *name, uint64_t start, uint64_t end)
+        {
+            buffer *b = local();
+            chunk *c = b->tail;
+            unsigned int n = c->count.load(std::memory_order_relaxed);
+            if (n == MAT_TRACE_CHUNK && b->chunks == MAT_TRACE_CHUNKS)
+            {
+                if (!recycle(b)) return;
+                c = b->tail;
+                n = c->count.load(std::memory_order_relaxed);
+            }
+            if (n == MAT_TRACE_CHUNK)
+            {
+                auto *next = new chunk;
+                c->next.store(next, std::memory_order_release);
+                b->tail = c = next;
+                b->chunks++;
+                n = 0;
+            }
+            c->events[n] = {name, start, end};
+            c->count.store(n+1, std::memory_order_release);
+        }
+
+        void dump(std::ostream &out)
+        {
+            uint64_t from = since.load(std::memory_order_relaxed);
+            char line[64];
+            bool first = true;
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            std::lock_guard<std::mutex> guard(lock);
+            for (buffer *b = buffers; b; b = b->next)
+            {
+                out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    << "\"tid\":" << b->tid << ",\"args\":{\"name\":\"2mat thread " << b->tid
+                    << "\"}}";
+                first = false;
+                for (chunk *c = b->head; c; c = c->next.load(std::memory_order_acquire))
+                {
+                    unsigned int n = c->count.load(std::memory_order_acquire);
+                    for (unsigned int i = 0; i < n; ++i)
+                    {
+                        auto &e = c->events[i];
+                        if (e.start < from) continue;
+                        // Chrome trace timestamps are in (fractional) microseconds
+                        snprintf(line, sizeof(line), "\"ts\":%.3f,\"dur\":%.3f", e.start/1e3,
+                            (e.end-e.start)/1e3);
+                        out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"2mat\",\"ph\":\"X\","
+                            << line << ",\"pid\":1,\"tid\":" << b->tid << "}";
+                    }
+                }
+            }
+            out << "\n]}\n";
+        }
+
+        bool dump(const std::string &path)
+        {
+            std::ofstream out(path);
+            if (!out) return false;
+            dump(out);
+            return (bool)out;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            since.store(now(), std::memory_order_relaxed);
+            for (buffer **b = &buffers; *b;)
+            {
+                if (!(*b)->exited)
+                {
+                    b = &(*b)->next;
+                    continue;
+                }
+                buffer *done = *b;
+                *b = done->next;
+                delete done;
+            }
+        }
+
+    }
+
+}
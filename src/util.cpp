@@ -19,9 +19,59 @@
 
 #include "util.hpp"
 
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
 namespace mat
 {
 
+    void parallel_for(dim_t n, dim_t grain, const std::function<void(dim_t,dim_t)> &fn,
+        unsigned int threads)
+    {
+        dim_t nthreads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        nthreads = std::min(nthreads, n/std::max(grain,(dim_t)1));
+        if (nthreads <= 1)
+        {
+            fn(0,n);
+            return;
+        }
+
+        // An exception escaping a thread would terminate the program, so the first one thrown is
+        // kept and rethrown once every thread has finished
+        std::exception_ptr error;
+        std::mutex lock;
+        auto run = [&](dim_t begin, dim_t end) {
+            try
+            {
+                fn(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error) error = std::current_exception();
+            }
+        };
+
+        // The calling thread takes the last block, rather than sitting idle, and any block no
+        // thread could be started for
+        std::vector<std::thread> workers;
+        workers.reserve(nthreads-1);
+        for (dim_t i = 0; i < nthreads-1; ++i)
+        {
+            try
+            {
+                workers.emplace_back(run, n*i/nthreads, n*(i+1)/nthreads);
+            } catch (std::system_error &) {
+                run(n*i/nthreads, n*(i+1)/nthreads);
+            }
+        }
+        run(n*(nthreads-1)/nthreads, n);
+        for (auto &t : workers) t.join();
+        if (error) std::rethrow_exception(error);
+    }
+
     mfile_error::mfile_error(const std::string &m)
     :
         runtime_error(m)
@@ -32,16 +32,19 @@ namespace mat
 
     static const uint16_t VERSION = 0x0100, ENDIAN = 0x4d49;
 
-    static std::string create_header(const std::string &head)
+    static std::string create_header(const std::string &head, bool stamp)
     {
-        // Write the creation time to the header. We don't need to do this, but it's sometimes 
-        // useful to have this information
-        time_t rawtime;
-        time(&rawtime);
-
         std::stringstream ss;
-        ss << "MATLAB 5.0 MAT-file, Created on: ";
-        ss << ctime(&rawtime) << " " << head;
+        ss << "MATLAB 5.0 MAT-file, ";
+        if (stamp)
+        {
+            // Write the creation time to the header. We don't need to do this, but it's sometimes
+            // useful to have this information
+            time_t rawtime;
+            time(&rawtime);
+            ss << "Created on: " << ctime(&rawtime) << " ";
+        }
+        ss << head;
 
         std::string str = ss.str();
         // truncate the header string if it is too long, otherwise pad it with spaces (we could use
@@ -66,7 +69,7 @@ namespace mat
         fw.write<uint32_t>(n*4);
         fw.write<dim_t,uint32_t>(&_dims[0],n);
         n *= 4;
-        fw.write_n<char>(0,ceil8(n)-n);
+        fw.pad(ceil8(n)-n);
 
         if (write_name)
         {
@@ -76,30 +79,34 @@ namespace mat
                 fw.write<uint16_t>(miINT8);
                 fw.write<uint16_t>(n);
                 fw.write<char>(&_name[0],n);
-                fw.write_n<char>(0,4-n);
+                fw.pad(4-n);
             } else {
                 fw.write<uint32_t>(miINT8);
                 fw.write<uint32_t>(n);
                 fw.write<char>(&_name[0],n);
-                fw.write_n<char>(0,ceil8(n)-n);
+                fw.pad(ceil8(n)-n);
             }
         } else {
             fw.write<uint32_t>(miINT8);
             fw.write<uint32_t>(0);
         }
 
-        n = _data->size();
-        if (n <= 4)
+        // Complex matrices are written as two data elements, with the real part first
+        n = plane_bytes();
+        for (unsigned int plane = 0; plane < (_complex ? 2u : 1u); ++plane)
         {
-            fw.write<uint16_t>(_type);
-            fw.write<uint16_t>(n);
-            fw.write<unsigned char>(ptr(),n);
-            fw.write_n<char>(0,4-n);
-        } else {
-            fw.write<uint32_t>(_type);
-            fw.write<uint32_t>(n);
-            fw.write<unsigned char>(ptr(),n);
-            fw.write_n<char>(0,ceil8(n)-n);
+            if (n <= 4)
+            {
+                fw.write<uint16_t>(_type);
+                fw.write<uint16_t>(n);
+                write_data(fw,plane);
+                fw.pad(4-n);
+            } else {
+                fw.write<uint32_t>(_type);
+                fw.write<uint32_t>(n);
+                write_data(fw,plane);
+                fw.pad(ceil8(n)-n);
+            }
         }
     }
 
@@ -131,12 +138,12 @@ namespace mat
                 fw.write<uint16_t>(miINT8);
                 fw.write<uint16_t>(n);
                 fw.write<char>(&_name[0],n);
-                fw.write_n<char>(0,4-n);
+                fw.pad(4-n);
             } else {
                 fw.write<uint32_t>(miINT8);
                 fw.write<uint32_t>(n);
                 fw.write<char>(&_name[0],n);
-                fw.write_n<char>(0,ceil8(n)-n);
+                fw.pad(ceil8(n)-n);
             }
         } else {
             fw.write<uint32_t>(miINT8);
@@ -159,9 +166,9 @@ namespace mat
             auto name = elem->name().substr(0,namesz);
             n = name.size();
             fw.write<char>(&name[0],n);
-            fw.write_n<char>(0,namesz-n);
+            fw.pad(namesz-n);
         }
-        fw.write_n<char>(0, ceil8(_children.size()*namesz) - _children.size()*namesz);
+        fw.pad(ceil8(_children.size()*namesz) - _children.size()*namesz);
 
         for (auto &elem : _children)
         {
@@ -170,21 +177,18 @@ namespace mat
     }
 
     template <>
-    void file<V6>::close()
+    void file<V6>::write_header(fwriter &fw, const std::string &head, bool stamp)
     {
-        if (_children.empty()) return;
-        fwriter fw(_name);
-        fw.write(create_header(head));
+        fw.write(create_header(head,stamp));
         fw.write<uint64_t>(0); // subsys offset
         fw.write<uint16_t>(VERSION);
         fw.write<uint16_t>(ENDIAN);
+    }
 
-        for (auto const &child : _children)
-        {
-            child->write(fw,V6);
-        }
-        fw.close();
-        open = false;
+    template <>
+    void file<V6>::write_child(fwriter &fw, element &child, const compress_options &)
+    {
+        child.write(fw,V6);
     }
 
 }
\ No newline at end of file
@@ -18,6 +18,8 @@
  */
 
 #include "io/fwriter.hpp"
+#include "io/tune.hpp"
+#include "io/zcache.hpp"
 #include "file.hpp"
 #include "matrix.hpp"
 #include "util.hpp"
@@ -31,16 +33,19 @@ namespace mat
 
     static const uint16_t VERSION = 0x0100, ENDIAN = 0x4d49;
 
-    static std::string create_header(const std::string &head)
+    static std::string create_header(const std::string &head, bool stamp)
     {
-        // Write the creation time to the header. We don't need to do this, but it's sometimes 
-        // useful to have this information
-        time_t rawtime;
-        time(&rawtime);
-
         std::stringstream ss;
-        ss << "MATLAB 5.0 MAT-file, Created on: ";
-        ss << ctime(&rawtime) << " " << head;
+        ss << "MATLAB 5.0 MAT-file, ";
+        if (stamp)
+        {
+            // Write the creation time to the header. We don't need to do this, but it's sometimes
+            // useful to have this information
+            time_t rawtime;
+            time(&rawtime);
+            ss << "Created on: " << ctime(&rawtime) << " ";
+        }
+        ss << head;
 
         std::string str = ss.str();
         // truncate the header string if it is too long, otherwise pad it with spaces (we could use
@@ -50,30 +55,112 @@ namespace mat
     }
 
     template <>
-    void file<V7>::close()
+    void file<V7>::write_header(fwriter &fw, const std::string &head, bool stamp)
     {
-        if (_children.empty()) return;
-        fwriter fw(_name);
-        fw.write(create_header(head));
+        fw.write(create_header(head,stamp));
         fw.write<uint64_t>(0); // subsys offset
         fw.write<uint16_t>(VERSION);
         fw.write<uint16_t>(ENDIAN);
+    }
+
+    // Writes an element already compressed into memory, with its tag
+    static void write_compressed(fwriter &fw, const std::vector<unsigned char> &buf)
+    {
+        auto *stats = fw.stats();
+        fw.stats(nullptr);
+        auto start = stats_clock::now();
+        fw.write<uint32_t>(miCOMPRESSED);
+        fw.write<dim_t,uint32_t>(buf.size());
+        fw.write(buf.data(),buf.size());
+        fw.stats(stats);
+        if (stats)
+        {
+            // The compressed data was counted as it was written into memory; only the tag and
+            // the time taken to copy it out are left
+            stats->io += seconds_since(start);
+            stats->bytes += 8;
+            stats->written += 8;
+        }
+    }
+
+    // Finds the compressed form of an element in opts.cache, or compresses it and keeps it there
+    static zcache::blob compress_cached(fwriter &fw, element &child, const compress_options &opts)
+    {
+        auto raw = std::make_shared<memory_sink>(child.size(true)+8);
+        {
+            fwriter rw(raw);
+            child.write(rw,V6);
+            rw.close();
+        }
+        auto &bytes = raw->data();
+        auto key = zcache::digest(bytes.data(),bytes.size(),opts);
+        auto *stats = fw.stats();
+        if (auto blob = opts.cache->find(key))
+        {
+            if (stats)
+            {
+                stats->bytes += bytes.size();
+                stats->written += blob->size();
+                stats->cached++;
+            }
+            return blob;
+        }
+
+        auto mem = std::make_shared<memory_sink>();
+        {
+            fwriter zw(mem);
+            zw.stats(stats);
+            zw.addfilter(opts.tune ? tune(child,opts) : opts);
+            zw.write(bytes.data(),bytes.size());
+            zw.close();
+        }
+        auto blob = std::make_shared<const std::vector<unsigned char>>(mem->take());
+        opts.cache->insert(key,blob);
+        return blob;
+    }
+
+    template <>
+    void file<V7>::write_child(fwriter &fw, element &child, const compress_options &opts)
+    {
+        if (opts.cache)
+        {
+            write_compressed(fw,*compress_cached(fw,child,opts));
+            return;
+        }
+
+        if (!fw.seekable())
+        {
+            // The compressed size can't be filled in afterwards, so the element is compressed into
+            // memory and written out once it is finished
+            auto mem = std::make_shared<memory_sink>();
+            {
+                fwriter zw(mem);
+                zw.stats(fw.stats());
+                zw.addfilter(opts.tune ? tune(child,opts) : opts);
+                child.write(zw,V6);
+                zw.close();
+            }
+            write_compressed(fw,mem->data());
+            return;
+        }
 
-        for (auto const &child : _children)
+        fw.write<uint32_t>(miCOMPRESSED);
+        fw.write<uint32_t>(0);
+        auto sloc = fw.tellp();
+        fw.addfilter(opts.tune ? tune(child,opts) : opts);
+        child.write(fw,V6);
+        fw.rmfilter();
+        auto eloc = fw.tellp();
+        fw.seekp(sloc-4);
+        fw.write<uint32_t>(eloc-sloc);
+        fw.seekp(eloc);
+        if (auto *stats = fw.stats())
         {
-            fw.write<uint32_t>(miCOMPRESSED);
-            fw.write<uint32_t>(0);
-            auto sloc = fw.tellp();
-            fw.addfilter<zfilter>();
-            child->write(fw,V6);
-            fw.rmfilter();
-            auto eloc = fw.tellp();
-            fw.seekp(sloc-4);
-            fw.write<uint32_t>(eloc-sloc);
-            fw.seekp(eloc);
+            // The size overwrites the placeholder already counted, so it costs a seek and a write
+            // but adds no bytes to the file
+            stats->bytes -= 4;
+            stats->written -= 4;
         }
-        fw.close();
-        open = false;
     }
 
 }
\ No newline at end of file
@@ -41,9 +41,13 @@ namespace mat
     }
 
     template <>
-    void file<V7_3>::close()
+    std::shared_future<void> file<V7_3>::close()
     {
         open = false;
+        std::promise<void> done;
+        done.set_value();
+        _closed = done.get_future().share();
+        return _closed;
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+ * 2mat/view.cpp -- class implementation for view.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "view.hpp"
+#include "simd/kernels.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+
+namespace mat
+{
+
+    void view_source::init()
+    {
+        // The indices added to make a matrix have a single value, so their stride is never used
+        strides.insert(strides.begin(), _dims.size()-strides.size(), 0);
+    }
+
+    const void *view_source::contiguous() const
+    {
+        // Indices with a single value can have any stride, as it is never used
+        std::ptrdiff_t step = 1;
+        for (dim_t r = 0; r < _dims.size(); ++r)
+        {
+            if (_dims[r] == 1) continue;
+            if (strides[r] != step) return nullptr;
+            step *= (std::ptrdiff_t)_dims[r];
+        }
+        return base;
+    }
+
+    void view_source::read(dim_t first, dim_t n, void *buf)
+    {
+        MAT_TRACE_SPAN("view_source::read");
+        auto out = (unsigned char *)buf;
+        // The index of the first value, with the first varying fastest, and its offset
+        const dim_t k = _dims.size();
+        std::vector<dim_t> index(k);
+        std::ptrdiff_t offset = 0;
+        dim_t rest = first;
+        for (dim_t r = 0; r < k; ++r)
+        {
+            index[r] = rest % _dims[r];
+            rest /= _dims[r];
+            offset += (std::ptrdiff_t)index[r]*strides[r];
+        }
+
+        while (n)
+        {
+            // The rest of this run of the first index
+            dim_t m = std::min(n, _dims[0]-index[0]);
+            simd::gather(base + offset*(std::ptrdiff_t)width, strides[0], out, m, width);
+            out += m*width;
+            n -= m;
+            offset -= (std::ptrdiff_t)index[0]*strides[0];
+            index[0] = 0;
+            for (dim_t r = 1; r < k; ++r)
+            {
+                offset += strides[r];
+                if (++index[r] < _dims[r]) break;
+                offset -= (std::ptrdiff_t)_dims[r]*strides[r];
+                index[r] = 0;
+            }
+        }
+    }
+
+}
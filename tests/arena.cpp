@@ -0,0 +1,96 @@
+/*
+ * 2mat/tests/arena.cpp -- tests of elements constructed in arenas
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace mat;
+
+// What is allocated from an arena keeps it alive, so it must be owned by a shared_ptr
+static_assert(!std::is_constructible<arena::scope, arena *>::value,
+    "arena::scope must not take an arena that is not shared");
+
+MAT_TEST(arena, scope_allocates_from_the_arena)
+{
+    auto path = test::scratch("arena_scope.mat");
+    std::vector<double> x(1000);
+    for (size_t i = 0; i < x.size(); ++i) x[i] = (double)i;
+    auto a = std::make_shared<arena>();
+    std::unique_ptr<matrix> m;
+    {
+        arena::scope s(a);
+        CHECK(arena::current() == a.get());
+        m.reset(new matrix("x", x.data(), x.size()));
+    }
+    CHECK(arena::current() == nullptr);
+    CHECK(a->allocated() >= 8*x.size());
+    // The matrix holds the arena, so it outlives the last reference to it elsewhere
+    a.reset();
+    {
+        file<V6> f(path);
+        f.add(*m);
+        f.close().get();
+    }
+    m.reset();
+    auto vars = test::read_mat(path);
+    CHECK(vars[0].values<double>() == x);
+}
+
+MAT_TEST(arena, scopes_nest)
+{
+    auto a = std::make_shared<arena>(), b = std::make_shared<arena>();
+    {
+        arena::scope outer(a);
+        {
+            arena::scope inner(b);
+            CHECK(arena::current() == b.get());
+            {
+                arena::scope none(nullptr);
+                CHECK(arena::current() == nullptr);
+            }
+            CHECK(arena::current() == b.get());
+        }
+        CHECK(arena::current() == a.get());
+    }
+    CHECK(arena::current() == nullptr);
+}
+
+MAT_TEST(arena, container_children_outlive_the_arena)
+{
+    auto path = test::scratch("arena_file.mat");
+    std::vector<double> x(1000, 2.5);
+    auto a = std::make_shared<arena>();
+    {
+        file<V7> f(path);
+        f.memory(a);
+        f.add("x", x.begin(), x.end());
+        f.add("s", std::string("text"));
+        a.reset();
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    CHECK(test::find(vars, "x").values<double>() == x);
+    CHECK(test::find(vars, "s").text() == std::u16string(u"text"));
+}
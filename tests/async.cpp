@@ -0,0 +1,184 @@
+/*
+ * 2mat/tests/async.cpp -- tests of files written in the background
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+MAT_TEST(async, round_trips_in_order)
+{
+    auto path = test::scratch("async.mat");
+    std::vector<std::vector<double>> data(20);
+    {
+        file<V7> f(path);
+        f.add("before", {1.0, 2.0});
+        async_options opts;
+        opts.workers = 2;
+        opts.budget = 4096;
+        f.async(opts);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i].assign(50 + i*10, (double)i);
+            f.add("x" + std::to_string(i), data[i].begin(), data[i].end());
+        }
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars.size(), data.size()+1);
+    CHECK_EQ(vars[0].name, std::string("before"));
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        CHECK_EQ(vars[i+1].name, "x" + std::to_string(i));
+        CHECK(vars[i+1].values<double>() == data[i]);
+    }
+}
+
+MAT_TEST(async, close_without_adds_leaves_empty_file)
+{
+    auto path = test::scratch("async_empty.mat");
+    {
+        file<V6> f(path);
+        f.async();
+        f.close().get();
+    }
+    CHECK_EQ(test::read_file(path).size(), (size_t)128);
+    CHECK(test::read_mat(path).empty());
+}
+
+MAT_TEST(async, elements_added_before_async_ignore_the_budget)
+{
+    auto path = test::scratch("async_before.mat");
+    std::vector<double> big(1000, 1.0);
+    {
+        file<V6> f(path);
+        for (int i = 0; i < 5; ++i) f.add("b" + std::to_string(i), big.begin(), big.end());
+        async_options opts;
+        opts.budget = 100;
+        opts.block = false;
+        f.async(opts);
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars.size(), (size_t)5);
+    for (auto &v : vars) CHECK(v.values<double>() == big);
+}
+
+MAT_TEST(async, exhausted_budget_rejects_the_element)
+{
+    auto path = test::scratch("async_budget.mat");
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::vector<double> data(100, 2.0);
+    {
+        file<V6> f(path);
+        // Lets the writer go before the file is closed, even if a check fails
+        struct guard
+        {
+            std::promise<void> &p;
+            ~guard() { try { p.set_value(); } catch (...) {} }
+        } let_go{release};
+        async_options opts;
+        opts.budget = 1000;
+        opts.block = false;
+        f.async(opts);
+        // The writer is held up on the first element, which stays queued until it is written
+        f.add("slow", generate<double>(100, [released](dim_t, dim_t n, double *buf) {
+            released.wait();
+            for (dim_t i = 0; i < n; ++i) buf[i] = 1.0;
+        }));
+        CHECK_THROWS(f.add("rejected", data.begin(), data.end()), mfile_error);
+        release.set_value();
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars.size(), (size_t)1);
+    CHECK_EQ(vars[0].name, std::string("slow"));
+    CHECK(vars[0].values<double>() == std::vector<double>(100, 1.0));
+}
+
+MAT_TEST(async, compression_changes_while_writing)
+{
+    auto path = test::scratch("async_zopts.mat");
+    auto ref = test::scratch("async_zopts_ref.mat");
+    std::vector<double> data(4096);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = (double)((i*i) % 251);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    {
+        file<V7> f(path);
+        f.timestamp(false);
+        struct guard
+        {
+            std::promise<void> &p;
+            ~guard() { try { p.set_value(); } catch (...) {} }
+        } let_go{release};
+        f.async({});
+        // The writer is held up until every variable has been added, and the settings changed
+        // after each of them
+        f.add("slow", generate<double>(16, [released](dim_t, dim_t n, double *buf) {
+            released.wait();
+            for (dim_t i = 0; i < n; ++i) buf[i] = 1.0;
+        }));
+        for (int i = 0; i < 20; ++i)
+        {
+            compress_options opts;
+            opts.level = i % 10;
+            opts.strategy = i < 10 ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+            f.compression(opts);
+            f.add("x" + std::to_string(i), data.begin(), data.end());
+        }
+        compress_options last;
+        last.level = 0;
+        f.compression(last);
+        release.set_value();
+        f.close().get();
+    }
+    // The same variables written one at a time, each with the settings it was added with
+    {
+        file<V7> f(ref);
+        f.timestamp(false);
+        std::vector<double> ones(16, 1.0);
+        f.add("slow", ones.begin(), ones.end());
+        for (int i = 0; i < 20; ++i)
+        {
+            compress_options opts;
+            opts.level = i % 10;
+            opts.strategy = i < 10 ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+            f.compression("x" + std::to_string(i), opts);
+            f.add("x" + std::to_string(i), data.begin(), data.end());
+        }
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars.size(), (size_t)21);
+    for (size_t i = 1; i < vars.size(); ++i)
+    {
+        CHECK(vars[i].compressed);
+        CHECK(vars[i].values<double>() == data);
+    }
+    auto got = test::elements(test::read_file(path)), want = test::elements(test::read_file(ref));
+    CHECK_EQ(got.size(), want.size());
+    for (size_t i = 1; i < got.size(); ++i) CHECK(got[i] == want[i]);
+}
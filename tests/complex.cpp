@@ -0,0 +1,150 @@
+/*
+ * 2mat/tests/complex.cpp -- tests of complex matrices
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+#include "io/fwriter.hpp"
+
+#include <complex>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    template <typename T>
+    std::vector<std::complex<T>> values(size_t n)
+    {
+        std::vector<std::complex<T>> v(n);
+        for (size_t i = 0; i < n; ++i) v[i] = {(T)i + (T)0.5, -(T)i*2};
+        return v;
+    }
+
+    // Every length up to a few vectors of each kernel, so that each tail is written, and one
+    // spanning several chunks
+    template <file_version V, typename T>
+    void round_trip(array_class mclass, datatype type)
+    {
+        std::vector<size_t> sizes;
+        for (size_t n = 1; n <= 20; ++n) sizes.push_back(n);
+        sizes.push_back(3*MAT_SCHUNK/sizeof(T) + 7);
+        auto path = test::scratch("complex.mat");
+        {
+            file<V> f(path);
+            for (auto n : sizes)
+            {
+                auto v = values<T>(n);
+                f.add("z" + std::to_string(n), v.begin(), v.end());
+            }
+            f.close().get();
+        }
+        auto vars = test::read_mat(path);
+        CHECK_EQ(vars.size(), sizes.size());
+        for (auto n : sizes)
+        {
+            auto &z = test::find(vars, "z" + std::to_string(n));
+            CHECK(z.complex);
+            CHECK_EQ(z.mclass, mclass);
+            CHECK_EQ(z.type, type);
+            CHECK_EQ(z.itype, type);
+            CHECK(z.dims == (std::vector<dim_t>{1, n}));
+            auto v = values<T>(n);
+            auto re = z.values<double>(), im = z.values<double>(true);
+            CHECK_EQ(re.size(), n);
+            CHECK_EQ(im.size(), n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                CHECK_EQ(re[i], (double)v[i].real());
+                CHECK_EQ(im[i], (double)v[i].imag());
+            }
+        }
+    }
+
+}
+
+MAT_TEST(complex, v6_double)
+{
+    round_trip<V6, double>(mxDOUBLE_CLASS, miDOUBLE);
+}
+
+MAT_TEST(complex, v7_double)
+{
+    round_trip<V7, double>(mxDOUBLE_CLASS, miDOUBLE);
+}
+
+MAT_TEST(complex, v6_single)
+{
+    round_trip<V6, float>(mxSINGLE_CLASS, miSINGLE);
+}
+
+MAT_TEST(complex, v7_single)
+{
+    round_trip<V7, float>(mxSINGLE_CLASS, miSINGLE);
+}
+
+MAT_TEST(complex, scalars_and_dims)
+{
+    // A complex single scalar has parts small enough to be packed into their tags
+    std::complex<float> s(1.5f, -2.5f);
+    auto m = values<double>(12);
+    auto path = test::scratch("complex_scalar.mat");
+    {
+        file<V6> f(path);
+        f.add("s", &s, 1);
+        f.add("m", m.data(), m.size(), {3, 4});
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    auto &sv = test::find(vars, "s");
+    CHECK(sv.complex);
+    CHECK(sv.values<double>() == (std::vector<double>{1.5}));
+    CHECK(sv.values<double>(true) == (std::vector<double>{-2.5}));
+    auto &mv = test::find(vars, "m");
+    CHECK(mv.dims == (std::vector<dim_t>{3, 4}));
+    CHECK_EQ(mv.values<double>()[11], m[11].real());
+    CHECK_EQ(mv.values<double>(true)[11], m[11].imag());
+}
+
+MAT_TEST(complex, row_major)
+{
+    // 2 x 3 x 2, with the last index varying fastest
+    auto v = values<double>(12);
+    auto path = test::scratch("complex_rows.mat");
+    {
+        file<V7> f(path);
+        f.add("r", v.data(), v.size(), {2, 3, 2}, row_major);
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    auto &r = test::find(vars, "r");
+    CHECK(r.complex);
+    CHECK(r.dims == (std::vector<dim_t>{2, 3, 2}));
+    auto re = r.values<double>(), im = r.values<double>(true);
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            for (size_t k = 0; k < 2; ++k)
+            {
+                size_t col = i + 2*(j + 3*k), row = (i*3 + j)*2 + k;
+                CHECK_EQ(re[col], v[row].real());
+                CHECK_EQ(im[col], v[row].imag());
+            }
+}
@@ -0,0 +1,233 @@
+/*
+ * 2mat/tests/compression.cpp -- tests of the compression settings of V7 files
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+#include "io/tune.hpp"
+
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+using namespace mat;
+
+namespace
+{
+
+    // Compressible, but not so much that every setting gives the same stream
+    std::vector<double> series(size_t n)
+    {
+        std::vector<double> out(n);
+        for (size_t i = 0; i < n; ++i) out[i] = (double)((i*i) % 251) + (i % 7)*0.25;
+        return out;
+    }
+
+    // The compressed stream of each element of a V7 file
+    std::vector<std::vector<unsigned char>> streams(const std::string &path)
+    {
+        auto out = test::elements(test::read_file(path));
+        for (auto &e : out)
+        {
+            CHECK(e.size() > 8);
+            e.erase(e.begin(), e.begin() + 8);
+        }
+        return out;
+    }
+
+    // A stream compressed in one go with the passed settings
+    std::vector<unsigned char> deflated(const std::vector<unsigned char> &raw, int level,
+        int strategy)
+    {
+        z_stream strm{};
+        CHECK_EQ(deflateInit2(&strm, level, Z_DEFLATED, 15, 8, strategy), Z_OK);
+        std::vector<unsigned char> out(deflateBound(&strm, raw.size()));
+        strm.next_in = const_cast<unsigned char *>(raw.data());
+        strm.avail_in = raw.size();
+        strm.next_out = out.data();
+        strm.avail_out = out.size();
+        int ret = deflate(&strm, Z_FINISH);
+        out.resize(out.size() - strm.avail_out);
+        deflateEnd(&strm);
+        CHECK_EQ(ret, Z_STREAM_END);
+        return out;
+    }
+
+    // Whether the stream is what zlib gives with the passed settings
+    bool compressed_with(const std::vector<unsigned char> &stream, int level, int strategy)
+    {
+        auto raw = test::inflate_all(stream.data(), stream.size());
+        return stream == deflated(raw, level, strategy);
+    }
+
+}
+
+MAT_TEST(compression, levels_and_strategies_are_used)
+{
+    // Smaller than a chunk, so the file's stream is compressed in one go as well
+    auto data = series(2000);
+    int strategies[] = {Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED};
+    for (int level = -1; level <= 9; ++level)
+    {
+        for (int strategy : strategies)
+        {
+            auto path = test::scratch("zopts_level.mat");
+            {
+                file<V7> f(path);
+                compress_options opts;
+                opts.level = level;
+                opts.strategy = strategy;
+                f.compression(opts);
+                f.add("x", data.begin(), data.end());
+                f.close().get();
+            }
+            auto vars = test::read_mat(path);
+            CHECK(vars[0].compressed);
+            CHECK(vars[0].values<double>() == data);
+            CHECK(compressed_with(streams(path)[0], level, strategy));
+        }
+    }
+}
+
+MAT_TEST(compression, variable_settings_override_the_file)
+{
+    auto data = series(2000);
+    auto path = test::scratch("zopts_variable.mat");
+    {
+        file<V7> f(path);
+        compress_options opts, mine;
+        opts.level = 9;
+        mine.level = 1;
+        mine.strategy = Z_RLE;
+        f.compression(opts);
+        f.compression("b", mine);
+        f.add("a", data.begin(), data.end());
+        f.add("b", data.begin(), data.end());
+        CHECK_EQ(f.compression("a").level, 9);
+        CHECK_EQ(f.compression("b").level, 1);
+        f.close().get();
+    }
+    auto zs = streams(path);
+    CHECK(compressed_with(zs[0], 9, Z_DEFAULT_STRATEGY));
+    CHECK(compressed_with(zs[1], 1, Z_RLE));
+}
+
+MAT_TEST(compression, settings_apply_to_variables_added_afterwards)
+{
+    auto data = series(2000);
+    auto path = test::scratch("zopts_later.mat");
+    {
+        file<V7> f(path);
+        compress_options opts;
+        opts.level = 1;
+        f.compression(opts);
+        f.add("a", data.begin(), data.end());
+        opts.level = 9;
+        f.compression(opts);
+        f.add("b", data.begin(), data.end());
+        opts.level = 0;
+        f.compression(opts);
+        f.compression("b", opts);
+        f.close().get();
+    }
+    auto zs = streams(path);
+    CHECK(compressed_with(zs[0], 1, Z_DEFAULT_STRATEGY));
+    CHECK(compressed_with(zs[1], 9, Z_DEFAULT_STRATEGY));
+}
+
+MAT_TEST(compression, chunk_size_is_used)
+{
+    auto data = series(20000);
+    for (dim_t chunk : {(dim_t)1000, (dim_t)4096, (dim_t)MAT_ZCHUNK})
+    {
+        auto path = test::scratch("zopts_chunk.mat");
+        file<V7> f(path);
+        f.record_stats();
+        compress_options opts;
+        opts.chunk = chunk;
+        f.compression(opts);
+        f.add("x", data.begin(), data.end());
+        f.close().get();
+        // The most held waiting to be compressed is a chunk, or the whole element if smaller
+        auto zs = streams(path);
+        dim_t raw = test::inflate_all(zs[0].data(), zs[0].size()).size();
+        CHECK(raw > 4096);
+        CHECK_EQ(f.stats().variables[0].peak, std::min(chunk, raw));
+        auto vars = test::read_mat(path);
+        CHECK(vars[0].values<double>() == data);
+    }
+}
+
+MAT_TEST(compression, tuning_uses_the_settings_it_picks)
+{
+    auto data = series(2000);
+    compress_options opts;
+    opts.tune = true;
+    // No setting can reach this ratio, so the smallest output is picked
+    opts.ratio = 1e9;
+    matrix m("x", data.begin(), data.end());
+    auto picked = tune(m, opts);
+    CHECK(!picked.tune);
+
+    auto path = test::scratch("zopts_tune.mat");
+    {
+        file<V7> f(path);
+        f.compression(opts);
+        f.add("x", data.begin(), data.end());
+        f.close().get();
+    }
+    auto zs = streams(path);
+    CHECK(compressed_with(zs[0], picked.level, picked.strategy));
+    // The element fits in the sample, so the pick is the smallest of the settings tried on it
+    auto raw = test::inflate_all(zs[0].data(), zs[0].size());
+    int tried[][2] = {{1, Z_DEFAULT_STRATEGY}, {6, Z_DEFAULT_STRATEGY}, {9, Z_DEFAULT_STRATEGY},
+        {6, Z_FILTERED}, {6, Z_RLE}, {6, Z_HUFFMAN_ONLY}};
+    for (auto &t : tried) CHECK(zs[0].size() <= deflated(raw, t[0], t[1]).size());
+}
+
+MAT_TEST(compression, bad_settings_are_rejected)
+{
+    auto data = series(100);
+    auto path = test::scratch("zopts_bad.mat");
+    std::vector<compress_options> bad(5);
+    bad[0].level = -2;
+    bad[1].level = 10;
+    bad[2].strategy = 42;
+    bad[3].strategy = -1;
+    bad[4].chunk = 0;
+    {
+        file<V7> f(path);
+        rolling<V7> r(test::scratch("zopts_bad_rolling"));
+        for (auto &opts : bad)
+        {
+            CHECK_THROWS(f.compression(opts), mfile_error);
+            CHECK_THROWS(f.compression("x", opts), mfile_error);
+            CHECK_THROWS(r.compression(opts), mfile_error);
+            CHECK_THROWS(r.compression("x", opts), mfile_error);
+        }
+        // None of them were kept, so the file is written with the defaults
+        CHECK_EQ(f.compression("x").level, MAT_ZLEVEL);
+        f.add("x", data.begin(), data.end());
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars.size(), (size_t)1);
+    CHECK(vars[0].values<double>() == data);
+    CHECK(compressed_with(streams(path)[0], MAT_ZLEVEL, Z_DEFAULT_STRATEGY));
+}
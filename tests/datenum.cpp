@@ -0,0 +1,125 @@
+/*
+ * 2mat/tests/datenum.cpp -- tests of the batch datenum conversions
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "datenum.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+    // Enough values that the conversions are split into blocks, with a ragged end
+    const dim_t N = (1 << 19) + 37;
+
+    bool same_bits(double a, double b)
+    {
+        return std::memcmp(&a, &b, sizeof(double)) == 0;
+    }
+
+    template <typename T, typename R>
+    void check_batch(const std::vector<T> &in, void (*batch)(const T *, double *, dim_t),
+        R (*scalar)(T))
+    {
+        std::vector<double> out(in.size());
+        batch(in.data(), out.data(), in.size());
+        for (dim_t i = 0; i < in.size(); ++i)
+            if (!same_bits(out[i], scalar(in[i])))
+                throw test::failure("batch conversion differs at " + std::to_string(i));
+    }
+
+    std::vector<double> doubles(double lo, double hi)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> dist(lo, hi);
+        std::vector<double> v(N);
+        for (auto &x : v) x = dist(rng);
+        // Values the SIMD paths might round differently
+        v[0] = 0;
+        v[1] = -0.0;
+        v[2] = lo;
+        v[3] = hi;
+        v[4] = 1e-300;
+        return v;
+    }
+}
+
+MAT_TEST(datenum, unix_batch_is_bit_exact)
+{
+    check_batch<double>(doubles(-4e9, 4e9), unix2dn, unix2dn);
+}
+
+MAT_TEST(datenum, julian_batches_are_bit_exact)
+{
+    check_batch<double>(doubles(2.3e6, 2.6e6), j19002dn, j19002dn);
+    check_batch<double>(doubles(-1e5, 1e5), j20002dn, j20002dn);
+    check_batch<double>(doubles(0, 1e5), mjd2dn, mjd2dn);
+}
+
+MAT_TEST(datenum, tt2000_batch_is_bit_exact)
+{
+    // Sorted epochs across the leap seconds of 1972-2017, then the same shuffled
+    std::vector<long long> tt(N);
+    const long long from = -883655957816000000ll, to = 536500869184000000ll;
+    for (dim_t i = 0; i < N; ++i) tt[i] = from + (long long)((double)(to-from)/N*i);
+    check_batch<long long>(tt, tt20002dn, tt20002dn);
+    std::shuffle(tt.begin(), tt.end(), std::mt19937_64(7));
+    check_batch<long long>(tt, tt20002dn, tt20002dn);
+}
+
+MAT_TEST(datenum, batch_converts_in_place)
+{
+    auto in = doubles(-4e9, 4e9), out = in;
+    unix2dn(out.data(), out.data(), out.size());
+    for (dim_t i = 0; i < in.size(); ++i) CHECK(same_bits(out[i], unix2dn(in[i])));
+}
+
+MAT_TEST(datenum, parallel_for_covers_range_once)
+{
+    std::vector<std::atomic<int>> seen(1000);
+    parallel_for(seen.size(), 10, [&](dim_t b, dim_t e) {
+        for (dim_t i = b; i < e; ++i) seen[i]++;
+    }, 7);
+    for (auto &s : seen) CHECK_EQ(s.load(), 1);
+}
+
+MAT_TEST(datenum, parallel_for_rethrows_worker_errors)
+{
+    // Every block but the calling thread's (the last) throws
+    std::atomic<int> finished(0);
+    CHECK_THROWS(parallel_for(1000, 10, [&](dim_t, dim_t e) {
+        finished++;
+        if (e != 1000) throw std::runtime_error("worker failed");
+    }, 4), std::runtime_error);
+    CHECK_EQ(finished.load(), 4);
+    // An error on the calling thread still waits for the others
+    finished = 0;
+    CHECK_THROWS(parallel_for(1000, 10, [&](dim_t, dim_t e) {
+        finished++;
+        if (e == 1000) throw std::runtime_error("caller failed");
+    }, 4), std::runtime_error);
+    CHECK_EQ(finished.load(), 4);
+}
@@ -0,0 +1,153 @@
+/*
+ * 2mat/tests/estimate.cpp -- tests of the file size estimate
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    // Values with the same statistics throughout, so that any window is representative
+    std::vector<double> noisy(size_t n)
+    {
+        std::vector<double> v(n);
+        uint32_t x = 12345;
+        for (size_t i = 0; i < v.size(); ++i)
+        {
+            x = x*1664525u + 1013904223u;
+            v[i] = (double)(i % 64) + (double)(x >> 28);
+        }
+        return v;
+    }
+
+    // Adds the same variables to any file, and returns the estimate made before it is closed
+    template <file_version V>
+    size_estimate write(const std::string &path, const std::vector<double> &a,
+        const std::vector<double> &b)
+    {
+        file<V> f(path);
+        f.timestamp(false);
+        f.add("a", a.begin(), a.end());
+        f.add("b", b.begin(), b.end(), {b.size()/4, 4});
+        f.add("c", std::string("estimated"));
+        f.add("d", {1.0, 2.0, 3.0});
+        auto est = f.estimate();
+        f.close().get();
+        return est;
+    }
+
+    // Checks an exact estimate against the file written
+    void check_exact(const size_estimate &est, const std::string &path)
+    {
+        auto bytes = test::read_file(path);
+        CHECK(est.exact);
+        CHECK_EQ(est.bytes, (dim_t)bytes.size());
+        CHECK_EQ(est.low, est.bytes);
+        CHECK_EQ(est.high, est.bytes);
+        auto vars = test::read_mat(bytes);
+        CHECK_EQ(est.variables.size(), vars.size());
+        for (size_t i = 0; i < vars.size(); ++i)
+        {
+            CHECK_EQ(est.variables[i].name, vars[i].name);
+            CHECK(est.variables[i].exact);
+            CHECK_EQ(est.variables[i].bytes, vars[i].stored);
+        }
+    }
+
+}
+
+MAT_TEST(estimate, v6_is_exact)
+{
+    auto a = noisy(100000), b = noisy(1000);
+    auto path = test::scratch("estimate_v6.mat");
+    auto est = write<V6>(path, a, b);
+    check_exact(est, path);
+    CHECK_EQ(est.raw, est.bytes);
+    CHECK_EQ(est.sampled, (dim_t)0);
+}
+
+MAT_TEST(estimate, small_v7_is_exact)
+{
+    // Every array is within the sample size, so is compressed in full
+    auto a = noisy(MAT_ZSAMPLE/sizeof(double)), b = noisy(400);
+    auto path = test::scratch("estimate_small.mat");
+    auto est = write<V7>(path, a, b);
+    check_exact(est, path);
+    CHECK(est.bytes < est.raw);
+}
+
+MAT_TEST(estimate, large_v7_is_within_bounds)
+{
+    auto a = noisy(1 << 19), b = noisy(1 << 17);
+    auto path = test::scratch("estimate_large.mat");
+    auto est = write<V7>(path, a, b);
+    auto actual = (dim_t)test::read_file(path).size();
+    CHECK(!est.exact);
+    CHECK(est.low <= actual);
+    CHECK(actual <= est.high);
+    // Far less is compressed than is written
+    CHECK(est.sampled > 0);
+    CHECK(est.sampled < est.raw/8);
+    CHECK(!est.variables[0].exact);
+    CHECK(est.variables[3].exact);
+}
+
+MAT_TEST(estimate, does_not_change_the_file)
+{
+    auto a = noisy(1 << 18), b = noisy(4000);
+    auto with = test::scratch("estimate_with.mat"), without = test::scratch("estimate_no.mat");
+    write<V7>(with, a, b);
+    {
+        file<V7> f(without);
+        f.timestamp(false);
+        f.add("a", a.begin(), a.end());
+        f.add("b", b.begin(), b.end(), {b.size()/4, 4});
+        f.add("c", std::string("estimated"));
+        f.add("d", {1.0, 2.0, 3.0});
+        f.close().get();
+    }
+    CHECK(test::read_file(with) == test::read_file(without));
+}
+
+MAT_TEST(estimate, memory_of_a_file_in_memory)
+{
+    auto a = noisy(10000);
+    auto out = std::make_shared<memory_sink>();
+    file<V6> f(out);
+    f.add("a", a.begin(), a.end());
+    auto est = f.estimate();
+    CHECK(est.memory >= est.bytes);
+    f.close().get();
+    CHECK_EQ((dim_t)out->data().size(), est.bytes);
+}
+
+MAT_TEST(estimate, only_before_writing)
+{
+    file<V7> f(test::scratch("estimate_closed.mat"));
+    f.add("a", {1.0});
+    f.close().get();
+    CHECK_THROWS((void)f.estimate(), mfile_error);
+}
@@ -0,0 +1,94 @@
+/*
+ * 2mat/tests/generator.cpp -- tests of matrices filled by a callback as they are written
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+#include "io/fwriter.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+    // Writes generated matrices of a few widths, several chunks long with a ragged end, and
+    // checks each value and the order the callback was called in
+    template <file_version V>
+    void round_trip(const std::string &path)
+    {
+        const dim_t n = 5*(MAT_SCHUNK/sizeof(double)/2 + 1);
+        dim_t next = 0;
+        {
+            file<V> f(path);
+            f.add("d", generate<double>(n, [&](dim_t first, dim_t m, double *buf) {
+                CHECK_EQ(first, next);
+                next += m;
+                for (dim_t i = 0; i < m; ++i) buf[i] = 0.5*(double)(first+i);
+            }), {n/5, 5});
+            f.add("i8", generate<int8_t>(n, [](dim_t first, dim_t m, int8_t *buf) {
+                for (dim_t i = 0; i < m; ++i) buf[i] = (int8_t)(first+i);
+            }));
+            f.add("f", generate<float>(7, [](dim_t first, dim_t m, float *buf) {
+                for (dim_t i = 0; i < m; ++i) buf[i] = -(float)(first+i);
+            }));
+            f.close().get();
+        }
+        CHECK_EQ(next, n);
+
+        auto vars = test::read_mat(path);
+        auto &d = test::find(vars, "d");
+        CHECK_EQ(d.mclass, mxDOUBLE_CLASS);
+        CHECK(!d.complex);
+        CHECK(d.dims == (std::vector<dim_t>{n/5, 5}));
+        auto dv = d.values<double>();
+        CHECK_EQ(dv.size(), n);
+        for (dim_t i = 0; i < n; ++i) CHECK_EQ(dv[i], 0.5*(double)i);
+
+        auto &i8 = test::find(vars, "i8");
+        CHECK_EQ(i8.mclass, mxINT8_CLASS);
+        auto iv = i8.values<int8_t>();
+        CHECK_EQ(iv.size(), n);
+        for (dim_t i = 0; i < n; ++i) CHECK_EQ((int)iv[i], (int)(int8_t)i);
+
+        auto &f = test::find(vars, "f");
+        CHECK_EQ(f.mclass, mxSINGLE_CLASS);
+        CHECK(f.values<float>() == (std::vector<float>{0,-1,-2,-3,-4,-5,-6}));
+    }
+}
+
+MAT_TEST(generator, round_trips_v6)
+{
+    round_trip<V6>(test::scratch("generator6.mat"));
+}
+
+MAT_TEST(generator, round_trips_v7)
+{
+    round_trip<V7>(test::scratch("generator7.mat"));
+}
+
+MAT_TEST(generator, errors_propagate)
+{
+    file<V6> f(test::scratch("generator_error.mat"));
+    f.add("x", generate<double>(10, [](dim_t, dim_t, double *) {
+        throw mfile_error("no data");
+    }));
+    CHECK_THROWS(f.close().get(), mfile_error);
+}
@@ -0,0 +1,155 @@
+/*
+ * 2mat/tests/half.cpp -- tests of half-precision and bfloat16 matrices
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    // Reference conversions, one value at a time
+    float from_half(uint16_t h)
+    {
+        int sign = h >> 15, exp = (h >> 10) & 0x1f, mant = h & 0x3ff;
+        float v;
+        if (exp == 0) v = std::ldexp((float)mant, -24);
+        else if (exp == 31) v = mant ? NAN : INFINITY;
+        else v = std::ldexp((float)(mant | 0x400), exp - 25);
+        return sign ? -v : v;
+    }
+
+    float from_bfloat16(uint16_t b)
+    {
+        uint32_t bits = (uint32_t)b << 16;
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    uint32_t bits(float f)
+    {
+        uint32_t b;
+        std::memcpy(&b, &f, sizeof(b));
+        return b;
+    }
+
+    // Every 16-bit pattern, written and read back
+    template <file_version V>
+    void every_value(half_format format)
+    {
+        std::vector<uint16_t> all(65536);
+        for (size_t i = 0; i < all.size(); ++i) all[i] = (uint16_t)i;
+        auto path = test::scratch("half_all.mat");
+        {
+            file<V> f(path);
+            f.add_half("x", format, all.data(), all.size(), {256, 256});
+            f.close().get();
+        }
+        auto vars = test::read_mat(path);
+        auto &x = test::find(vars, "x");
+        CHECK_EQ(x.mclass, mxSINGLE_CLASS);
+        CHECK_EQ(x.type, miSINGLE);
+        CHECK(x.dims == (std::vector<dim_t>{256, 256}));
+        auto got = x.values<float>();
+        CHECK_EQ(got.size(), all.size());
+        for (size_t i = 0; i < all.size(); ++i)
+        {
+            float expected = format == FLOAT16 ? from_half(all[i]) : from_bfloat16(all[i]);
+            if (std::isnan(expected))
+            {
+                CHECK(std::isnan(got[i]));
+                CHECK_EQ(std::signbit(got[i]), std::signbit(expected));
+            } else {
+                CHECK_EQ(bits(got[i]), bits(expected));
+            }
+        }
+    }
+
+}
+
+MAT_TEST(half, v6_float16_exact)
+{
+    every_value<V6>(FLOAT16);
+}
+
+MAT_TEST(half, v7_float16_exact)
+{
+    every_value<V7>(FLOAT16);
+}
+
+MAT_TEST(half, v6_bfloat16_exact)
+{
+    every_value<V6>(BFLOAT16);
+}
+
+MAT_TEST(half, v7_bfloat16_exact)
+{
+    every_value<V7>(BFLOAT16);
+}
+
+MAT_TEST(half, in_struct_and_default_dims)
+{
+    // 1.0, -2.0 and 0.5 in each format
+    std::vector<uint16_t> h = {0x3c00, 0xc000, 0x3800}, b = {0x3f80, 0xc000, 0x3f00};
+    auto path = test::scratch("half_struct.mat");
+    {
+        file<V7> f(path);
+        mstruct s("s");
+        s.add_half("h", FLOAT16, h.data(), h.size());
+        s.add_half("b", BFLOAT16, b.data(), b.size());
+        f.add(s);
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    auto &s = test::find(vars, "s");
+    for (auto name : {"h", "b"})
+    {
+        auto &v = s.field(name);
+        CHECK(v.dims == (std::vector<dim_t>{1, 3}));
+        CHECK(v.values<float>() == (std::vector<float>{1.0f, -2.0f, 0.5f}));
+    }
+}
+
+MAT_TEST(half, uint16_arrays_stay_integers)
+{
+    // add() with a uint16_t pointer writes a uint16 matrix, with or without dimensions
+    std::vector<uint16_t> u = {1, 2, 3, 4};
+    auto path = test::scratch("half_uint16.mat");
+    {
+        file<V6> f(path);
+        f.add("a", u.data(), u.size(), {});
+        f.add("b", u.data(), u.size(), {2, 2});
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    for (auto &v : vars)
+    {
+        CHECK_EQ(v.mclass, mxUINT16_CLASS);
+        CHECK(v.values<uint16_t>() == u);
+    }
+}
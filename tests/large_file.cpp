@@ -0,0 +1,100 @@
+/*
+ * 2mat/tests/large_file.cpp -- tests of files written in large-file mode
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "plain.hpp"
+#include "2mat.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    template <file_version V>
+    void matches_plain_file(bool direct, bool drop_cache, dim_t expected)
+    {
+        test::matches_plain_file<V>("large.mat", [=](file<V> &f) {
+            large_file_options opts;
+            opts.block = 4096;
+            opts.direct = direct;
+            opts.drop_cache = drop_cache;
+            opts.expected = expected;
+            f.large_file(opts);
+        });
+    }
+
+}
+
+MAT_TEST(large_file, v6_matches_plain_file)
+{
+    matches_plain_file<V6>(false, true, 0);
+}
+
+MAT_TEST(large_file, v7_matches_plain_file)
+{
+    matches_plain_file<V7>(false, true, 0);
+}
+
+MAT_TEST(large_file, without_dropping_the_cache)
+{
+    matches_plain_file<V7>(false, false, 0);
+}
+
+MAT_TEST(large_file, unused_reserved_space_is_released)
+{
+    matches_plain_file<V7>(false, true, 16 << 20);
+}
+
+MAT_TEST(large_file, direct_io_or_its_fallback)
+{
+    // Filesystems without O_DIRECT (such as tmpfs) fall back to writing through the cache
+    matches_plain_file<V6>(true, true, 0);
+    matches_plain_file<V7>(true, true, 1 << 20);
+}
+
+MAT_TEST(large_file, patches_blocks_already_written)
+{
+    auto path = test::scratch("large_patch.bin");
+    std::vector<unsigned char> expected(10000);
+    for (size_t i = 0; i < expected.size(); ++i) expected[i] = (unsigned char)(i*7);
+    {
+        // Blocks are rounded up to a whole page
+        large_file_options opts;
+        opts.block = 1000;
+        large_file_sink out(path, opts);
+        out.write(expected.data(), expected.size());
+        // Both in a block already written out, and across into the block still buffered
+        const unsigned char patch[6] = {1, 2, 3, 4, 5, 6};
+        out.seek(10, ios::beg);
+        out.write(patch, 6);
+        out.seek(8189, ios::beg);
+        out.write(patch, 6);
+        std::copy(patch, patch+6, expected.begin()+10);
+        std::copy(patch, patch+6, expected.begin()+8189);
+        CHECK_EQ(out.tell(), (dim_t)8195);
+        CHECK_THROWS(out.seek(1, ios::end), mfile_error);
+        out.close();
+    }
+    CHECK(test::read_file(path) == expected);
+}
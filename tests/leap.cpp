@@ -0,0 +1,158 @@
+/*
+ * 2mat/tests/leap.cpp -- tests of the leap second table
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "2mat.hpp"
+#include "datenum.hpp"
+#include "date/leap.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    const long long NS = 1000000000ll;
+    // 2017-01-01 00:00:00 UTC, just after the last leap second, and 2015-07-01 00:00:00 UTC
+    const long long Y2017 = 536500869184000000ll, Y2015 = 488980868184000000ll;
+
+    // Datenums of the same instant may differ in the last bits; 1e-9 days is under 0.1 ms
+    void check_time(long long tt, double dn)
+    {
+        if (std::fabs(tt20002dn(tt) - dn) < 1e-9) return;
+        throw test::failure("TT2000 " + std::to_string(tt) + " converts to "
+            + std::to_string(tt20002dn(tt)) + ", not " + std::to_string(dn));
+    }
+
+    // Puts back the table in use when it was created, when it goes out of scope
+    struct restore
+    {
+        std::vector<std::pair<long long,int>> changes;
+
+        restore()
+        {
+            auto &t = leap_seconds();
+            for (size_t i = 0; i < t.size(); ++i)
+            {
+                long long utc = t[i].start - t[i].offset;
+                changes.emplace_back((utc/NS + 43200)/86400 + 51544,
+                    (int)((t[i].offset - 32184000000ll)/NS));
+            }
+        }
+
+        ~restore()
+        {
+            leap_seconds(changes);
+        }
+    };
+
+    std::string write(const std::string &name, const std::string &text)
+    {
+        auto path = test::scratch(name);
+        std::ofstream(path) << text;
+        return path;
+    }
+
+    // The last two leap seconds are in each sample, with an entry from before 1972 to ignore
+    void check_loaded()
+    {
+        CHECK_EQ(leap_seconds().size(), (size_t)2);
+        check_time(Y2017, datenum(2017,1,1));
+        check_time(Y2015, datenum(2015,7,1));
+        check_time(Y2017 - 2*NS, datenum(2016,12,31,23,59,59));
+    }
+
+}
+
+MAT_TEST(leap, absolute_times)
+{
+    check_time(0, datenum(2000,1,1,11,58,55.816));
+    check_time(Y2017, datenum(2017,1,1));
+    check_time(Y2015, datenum(2015,7,1));
+}
+
+MAT_TEST(leap, either_side_of_leap_seconds)
+{
+    // 23:59:60 falls between the two, so they are two seconds of TT2000 apart, but one of UTC
+    check_time(Y2017 - 2*NS, datenum(2016,12,31,23,59,59));
+    check_time(Y2017 + NS, datenum(2017,1,1,0,0,1));
+    check_time(Y2015 - 2*NS, datenum(2015,6,30,23,59,59));
+    check_time(Y2015 + NS, datenum(2015,7,1,0,0,1));
+    // And before the first leap second of 1972
+    check_time(-883655957816000000ll, datenum(1972,1,1));
+}
+
+MAT_TEST(leap, loads_ietf)
+{
+    restore r;
+    load_leap_seconds(write("leap_ietf.list",
+        "#\tleap-seconds.list\n"
+        "#@\t3929093000\n"
+        "2272060800\t10\t# 1 Jan 1972\n"
+        "3644697600\t36\t# 1 Jul 2015\n"
+        "3692217600\t37\t# 1 Jan 2017\n"));
+    // The 1972 entry is the first kept; drop it to match the other samples
+    CHECK_EQ(leap_seconds().size(), (size_t)3);
+    load_leap_seconds(write("leap_ietf2.list",
+        "3644697600\t36\n"
+        "3692217600\t37\n"));
+    check_loaded();
+}
+
+MAT_TEST(leap, loads_iers)
+{
+    restore r;
+    load_leap_seconds(write("leap_iers.dat",
+        "#  File expires on 28 June 2027\n"
+        "#    MJD        Date        TAI-UTC (s)\n"
+        "#           day month year\n"
+        "    57204.0    1  7 2015       36\n"
+        "    57754.0    1  1 2017       37\n"));
+    check_loaded();
+}
+
+MAT_TEST(leap, loads_cdf)
+{
+    restore r;
+    load_leap_seconds(write("leap_cdf.txt",
+        "; Source: CDF leap seconds\n"
+        ";  Year Month Day  Leap Seconds      Drift\n"
+        "   1968   2    1    4.2131700   39126.0   0.002592\n"
+        "   2015   7    1   36.0             0.0    0.0\n"
+        "   2017   1    1   37.0             0.0    0.0\n"));
+    check_loaded();
+}
+
+MAT_TEST(leap, rejects_bad_files)
+{
+    restore r;
+    auto before = leap_seconds().size();
+    CHECK_THROWS(load_leap_seconds(test::scratch("leap_missing.txt")), mfile_error);
+    CHECK_THROWS(load_leap_seconds(write("leap_short.txt", "2017 1 1\n")), mfile_error);
+    CHECK_THROWS(load_leap_seconds(write("leap_empty.txt", "# nothing here\n")), mfile_error);
+    CHECK_THROWS(load_leap_seconds(write("leap_text.txt", "not a leap second file\n")),
+        mfile_error);
+    // The table in use is left alone
+    CHECK_EQ(leap_seconds().size(), before);
+}
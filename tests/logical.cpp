@@ -0,0 +1,126 @@
+/*
+ * 2mat/tests/logical.cpp -- tests of logical matrices
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+#include "io/fwriter.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    bool pattern(size_t i)
+    {
+        return (i*7 + i/3) % 5 < 2;
+    }
+
+    // Sizes on either side of a word, and one spanning several chunks that isn't a multiple of 64
+    const std::vector<size_t> sizes = {1, 3, 63, 64, 65, 100, 3*MAT_SCHUNK + 37};
+
+    void check(const test::variable &v, size_t n, const std::vector<dim_t> &dims)
+    {
+        CHECK(v.logical);
+        CHECK_EQ(v.mclass, mxUINT8_CLASS);
+        CHECK(v.dims == dims);
+        auto got = v.values<int>();
+        CHECK_EQ(got.size(), n);
+        for (size_t i = 0; i < n; ++i) CHECK_EQ(got[i], pattern(i) ? 1 : 0);
+    }
+
+    template <file_version V>
+    void round_trip()
+    {
+        std::vector<std::vector<bool>> masks;
+        std::vector<std::vector<uint64_t>> words;
+        std::vector<std::unique_ptr<bool[]>> bools;
+        auto path = test::scratch("logical.mat");
+        {
+            file<V> f(path);
+            for (auto n : sizes)
+            {
+                std::vector<bool> m(n);
+                std::vector<uint64_t> w((n+63)/64, 0);
+                std::unique_ptr<bool[]> b(new bool[n]);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    m[i] = b[i] = pattern(i);
+                    if (pattern(i)) w[i/64] |= 1ull << (i % 64);
+                }
+                auto name = std::to_string(n);
+                f.add("v" + name, m);
+                f.add("k" + name, bitmask{w.data(), n});
+                f.add("b" + name, b.get(), n);
+                masks.push_back(std::move(m));
+                words.push_back(std::move(w));
+                bools.push_back(std::move(b));
+            }
+            f.close().get();
+        }
+        auto vars = test::read_mat(path);
+        CHECK_EQ(vars.size(), 3*sizes.size());
+        for (auto n : sizes)
+        {
+            auto name = std::to_string(n);
+            for (auto prefix : {"v", "k", "b"})
+                check(test::find(vars, prefix + name), n, {1, n});
+        }
+    }
+
+}
+
+MAT_TEST(logical, v6_round_trip)
+{
+    round_trip<V6>();
+}
+
+MAT_TEST(logical, v7_round_trip)
+{
+    round_trip<V7>();
+}
+
+MAT_TEST(logical, dims)
+{
+    std::vector<bool> m(70);
+    std::vector<uint64_t> w(2, 0);
+    for (size_t i = 0; i < m.size(); ++i)
+    {
+        m[i] = pattern(i);
+        if (pattern(i)) w[i/64] |= 1ull << (i % 64);
+    }
+    auto path = test::scratch("logical_dims.mat");
+    {
+        file<V7> f(path);
+        f.add("v", m, {7, 10});
+        f.add("k", bitmask{w.data(), 70}, {10, 7});
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    check(test::find(vars, "v"), 70, {7, 10});
+    check(test::find(vars, "k"), 70, {10, 7});
+    file<V7> f(test::scratch("logical_bad.mat"));
+    CHECK_THROWS(f.add("bad", m, {7, 7}), mfile_error);
+    CHECK_THROWS(f.add("bad", bitmask{w.data(), 70}, {8, 8}), mfile_error);
+}
@@ -0,0 +1,100 @@
+/*
+ * 2mat/tests/main.cpp -- runs the 2mat tests
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Usage: 2mat_tests [suite ...]
+ *
+ * Runs the tests of the named suites (default: all of them), printing each failure to stderr.
+ * Returns 0 if every test passed. Scratch files are written to the directory in the
+ * environment variable MAT_TEST_DIR, or the current directory.
+ */
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mat
+{
+
+    namespace test
+    {
+
+        namespace
+        {
+            struct test_case
+            {
+                const char *suite, *name;
+                void (*fn)();
+            };
+
+            std::vector<test_case> &tests()
+            {
+                static std::vector<test_case> list;
+                return list;
+            }
+
+            std::vector<std::string> scratched;
+        }
+
+        registrar::registrar(const char *suite, const char *name, void (*fn)())
+        {
+            tests().push_back({suite, name, fn});
+        }
+
+        std::string scratch(const std::string &name)
+        {
+            const char *dir = std::getenv("MAT_TEST_DIR");
+            std::string path = std::string(dir ? dir : ".") + "/2mat_test_" + name;
+            scratched.push_back(path);
+            return path;
+        }
+
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    using namespace mat::test;
+    std::vector<std::string> suites(argv+1, argv+argc);
+    int run = 0, failed = 0;
+    for (auto &t : tests())
+    {
+        if (!suites.empty() && std::find(suites.begin(),suites.end(),t.suite) == suites.end())
+            continue;
+        ++run;
+        try
+        {
+            t.fn();
+        } catch (std::exception &e) {
+            ++failed;
+            std::cerr << t.suite << "." << t.name << " FAILED: " << e.what() << "\n";
+        }
+        for (auto &path : scratched) std::remove(path.c_str());
+        scratched.clear();
+    }
+    std::cerr << run-failed << "/" << run << " tests passed\n";
+    return failed || !run ? 1 : 0;
+}
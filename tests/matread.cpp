@@ -0,0 +1,267 @@
+/*
+ * 2mat/tests/matread.cpp -- class implementation for matread.hpp
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "matread.hpp"
+#include "test.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <zlib.h>
+
+namespace mat
+{
+
+    namespace test
+    {
+
+        namespace
+        {
+            [[noreturn]] void malformed(const std::string &why)
+            {
+                throw failure("Malformed MAT file: " + why);
+            }
+
+            uint32_t u32(const unsigned char *p)
+            {
+                uint32_t v;
+                std::memcpy(&v, p, 4);
+                return v;
+            }
+
+            // A data element: its type, and where its data is
+            struct tag
+            {
+                uint32_t type;
+                const unsigned char *data;
+                dim_t bytes;
+            };
+
+            // Reads the data element at pos, and moves pos past it (and its padding, if pad)
+            tag next(const unsigned char *&pos, const unsigned char *end, bool pad = true)
+            {
+                if (end - pos < 8) malformed("truncated tag");
+                uint32_t type = u32(pos);
+                if (type >> 16)
+                {
+                    // Small data element format: the data is in the second half of the tag
+                    tag t{type & 0xffff, pos+4, type >> 16};
+                    if (t.bytes > 4) malformed("small element of more than 4 bytes");
+                    pos += 8;
+                    return t;
+                }
+                tag t{type, pos+8, u32(pos+4)};
+                dim_t step = 8 + (pad ? (t.bytes+7)/8*8 : t.bytes);
+                if ((dim_t)(end - pos) < step) malformed("element runs past its parent");
+                pos += step;
+                return t;
+            }
+
+            variable parse_matrix(const unsigned char *pos, const unsigned char *end);
+
+            // The variables in a miMATRIX element of a struct or cell array
+            variable child(const unsigned char *&pos, const unsigned char *end)
+            {
+                tag t = next(pos, end);
+                if (t.type != miMATRIX) malformed("field is not a matrix");
+                return parse_matrix(t.data, t.data + t.bytes);
+            }
+
+            variable parse_matrix(const unsigned char *pos, const unsigned char *end)
+            {
+                variable v;
+                // An empty element stands for an empty matrix
+                if (pos == end) return v;
+
+                tag flags = next(pos, end);
+                if (flags.type != miUINT32 || flags.bytes != 8) malformed("bad array flags");
+                uint32_t f = u32(flags.data);
+                v.mclass = (array_class)(f & 0xff);
+                v.complex = f & 0x800;
+                v.logical = f & 0x200;
+
+                tag dims = next(pos, end);
+                if (dims.type != miINT32 || dims.bytes < 8 || dims.bytes % 4)
+                    malformed("bad dimensions");
+                for (dim_t i = 0; i < dims.bytes/4; ++i)
+                    v.dims.push_back((int32_t)u32(dims.data + 4*i));
+
+                tag name = next(pos, end);
+                if (name.type != miINT8) malformed("bad array name");
+                v.name.assign((const char *)name.data, name.bytes);
+
+                if (v.mclass == mxSTRUCT_CLASS)
+                {
+                    tag len = next(pos, end);
+                    tag names = next(pos, end);
+                    dim_t width = u32(len.data);
+                    if (len.type != miINT32 || names.type != miINT8 || !width ||
+                            names.bytes % width)
+                        malformed("bad field names");
+                    dim_t nfields = names.bytes/width;
+                    for (dim_t i = 0; i < v.numel()*nfields; ++i)
+                    {
+                        auto field = child(pos, end);
+                        auto *n = (const char *)names.data + (i % nfields)*width;
+                        field.name.assign(n, strnlen(n, width));
+                        v.fields.push_back(std::move(field));
+                    }
+                } else if (v.mclass == mxCELL_CLASS) {
+                    for (dim_t i = 0; i < v.numel(); ++i) v.fields.push_back(child(pos, end));
+                } else {
+                    tag real = next(pos, end);
+                    v.type = (datatype)real.type;
+                    v.real.assign(real.data, real.data + real.bytes);
+                    if (v.complex)
+                    {
+                        tag imag = next(pos, end);
+                        v.itype = (datatype)imag.type;
+                        v.imag.assign(imag.data, imag.data + imag.bytes);
+                    }
+                }
+                if (pos != end) malformed("trailing data in " + v.name);
+                return v;
+            }
+        }
+
+        dim_t variable::numel() const
+        {
+            dim_t n = 1;
+            for (auto d : dims) n *= d;
+            return n;
+        }
+
+        std::u16string variable::text() const
+        {
+            std::u16string out;
+            if (type == miUTF8 || type == miUINT8 || type == miINT8)
+            {
+                for (size_t i = 0; i < real.size();)
+                {
+                    unsigned char c = real[i];
+                    int n = c < 0x80 ? 1 : c < 0xe0 ? 2 : c < 0xf0 ? 3 : 4;
+                    char32_t cp = n == 1 ? c : c & (0x7f >> n);
+                    for (int k = 1; k < n && i+k < real.size(); ++k)
+                        cp = cp << 6 | (real[i+k] & 0x3f);
+                    i += n;
+                    if (cp >= 0x10000)
+                    {
+                        out += (char16_t)(0xd800 + ((cp - 0x10000) >> 10));
+                        out += (char16_t)(0xdc00 + (cp & 0x3ff));
+                    } else out += (char16_t)cp;
+                }
+                return out;
+            }
+            for (auto c : values<uint32_t>()) out += (char16_t)c;
+            return out;
+        }
+
+        const variable &variable::field(const std::string &name) const
+        {
+            for (auto &f : fields) if (f.name == name) return f;
+            throw failure("No field named " + name);
+        }
+
+        std::vector<unsigned char> inflate_all(const unsigned char *data, dim_t bytes)
+        {
+            std::vector<unsigned char> out(std::max<dim_t>(bytes*4, 1024));
+            z_stream strm{};
+            if (inflateInit(&strm) != Z_OK) malformed("could not start zlib");
+            strm.next_in = const_cast<unsigned char *>(data);
+            strm.avail_in = bytes;
+            int ret;
+            do
+            {
+                if (strm.total_out == out.size()) out.resize(out.size()*2);
+                strm.next_out = out.data() + strm.total_out;
+                strm.avail_out = out.size() - strm.total_out;
+                ret = inflate(&strm, Z_NO_FLUSH);
+            } while (ret == Z_OK);
+            out.resize(strm.total_out);
+            bool ended = ret == Z_STREAM_END && strm.avail_in == 0;
+            inflateEnd(&strm);
+            if (!ended) malformed("bad compressed element");
+            return out;
+        }
+
+        std::vector<unsigned char> read_file(const std::string &path)
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) throw failure("Could not open " + path);
+            return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        }
+
+        std::vector<variable> read_mat(const std::string &path)
+        {
+            return read_mat(read_file(path));
+        }
+
+        std::vector<variable> read_mat(const std::vector<unsigned char> &bytes)
+        {
+            if (bytes.size() < 128) malformed("no header");
+            if (std::string((const char *)bytes.data(), 6) != "MATLAB")
+                malformed("bad header text");
+            if (bytes[124] != 0x00 || bytes[125] != 0x01 || bytes[126] != 'I' || bytes[127] != 'M')
+                malformed("bad version or endian indicator");
+
+            std::vector<variable> vars;
+            const unsigned char *pos = bytes.data() + 128, *end = bytes.data() + bytes.size();
+            while (pos != end)
+            {
+                const unsigned char *start = pos;
+                if (u32(pos) == miCOMPRESSED)
+                {
+                    // Compressed elements are not padded
+                    tag t = next(pos, end, false);
+                    auto raw = inflate_all(t.data, t.bytes);
+                    const unsigned char *rpos = raw.data(), *rend = raw.data() + raw.size();
+                    tag m = next(rpos, rend);
+                    if (m.type != miMATRIX || rpos != rend) malformed("bad compressed matrix");
+                    vars.push_back(parse_matrix(m.data, m.data + m.bytes));
+                    vars.back().compressed = true;
+                } else {
+                    tag t = next(pos, end);
+                    if (t.type != miMATRIX) malformed("top-level element is not a matrix");
+                    vars.push_back(parse_matrix(t.data, t.data + t.bytes));
+                }
+                vars.back().stored = pos - start;
+            }
+            return vars;
+        }
+
+        std::vector<std::vector<unsigned char>> elements(const std::vector<unsigned char> &bytes)
+        {
+            std::vector<std::vector<unsigned char>> out;
+            auto at = bytes.begin() + 128;
+            for (auto &v : read_mat(bytes))
+            {
+                out.emplace_back(at, at + v.stored);
+                at += v.stored;
+            }
+            return out;
+        }
+
+        const variable &find(const std::vector<variable> &vars, const std::string &name)
+        {
+            for (auto &v : vars) if (v.name == name) return v;
+            throw failure("No variable named " + name);
+        }
+
+    }
+
+}
@@ -0,0 +1,129 @@
+/*
+ * 2mat/tests/matread.hpp -- a minimal reader of V6 and V7 files, for checking what was written
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_TEST_MATREAD_H
+#define TOO_MAT_TEST_MATREAD_H
+
+#include "types.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace mat
+{
+
+    namespace test
+    {
+
+        /*
+         *  mat::test::variable
+         *
+         * A variable read back from a V6 or V7 file by read_mat, as it is stored: the raw bytes of
+         * its real and imaginary parts, in the datatypes they were written with.
+         *
+         */
+        struct variable
+        {
+            std::string name;
+            array_class mclass = mxUNKNOWN_CLASS;
+            bool complex = false, logical = false;
+            std::vector<dim_t> dims;
+            datatype type = miUNKNOWN, itype = miUNKNOWN;
+            std::vector<unsigned char> real, imag;
+            // The fields of a struct (for 1x1 structs, in order), or the cells of a cell array
+            std::vector<variable> fields;
+            // The size of the element in the file, with its tag
+            dim_t stored = 0;
+            // Whether the element was written as miCOMPRESSED
+            bool compressed = false;
+
+            [[nodiscard]] dim_t numel() const;
+
+            // The values of the real (or imaginary) part, converted to T
+            template <typename T>
+            [[nodiscard]] std::vector<T> values(bool imaginary = false) const;
+
+            // The text of a char array, decoded from whichever encoding it was written with
+            [[nodiscard]] std::u16string text() const;
+
+            // The field of a struct with the passed name; throws if there is none
+            [[nodiscard]] const variable &field(const std::string &name) const;
+        };
+
+        /*
+         * std::vector<variable> mat::test::read_mat(const std::vector<unsigned char> &)
+         *
+         * Parses a V6 or V7 file, checking its header and the structure of each element, and
+         * returns its top-level variables. Throws mat::test::failure if the file is malformed.
+         */
+        std::vector<variable> read_mat(const std::vector<unsigned char> &bytes);
+        std::vector<variable> read_mat(const std::string &path);
+
+        // The bytes of a file on disk
+        std::vector<unsigned char> read_file(const std::string &path);
+
+        // The bytes of each top-level element of a file, with its tag, as they are stored
+        std::vector<std::vector<unsigned char>> elements(const std::vector<unsigned char> &bytes);
+
+        // The bytes a zlib stream decompresses to; throws mat::test::failure if it is malformed
+        std::vector<unsigned char> inflate_all(const unsigned char *data, dim_t bytes);
+
+        // The top-level variable with the passed name; throws if there is none
+        const variable &find(const std::vector<variable> &vars, const std::string &name);
+
+        template <typename T>
+        std::vector<T> variable::values(bool imaginary) const
+        {
+            auto &bytes = imaginary ? imag : real;
+            datatype t = imaginary ? itype : type;
+            const unsigned char *p = bytes.data();
+            std::vector<T> out;
+            auto take = [&](auto zero) {
+                typedef decltype(zero) S;
+                out.resize(bytes.size()/sizeof(S));
+                for (size_t i = 0; i < out.size(); ++i)
+                {
+                    S v;
+                    std::memcpy(&v, p + i*sizeof(S), sizeof(S));
+                    out[i] = (T)v;
+                }
+            };
+            switch (t)
+            {
+                case miINT8: take((int8_t)0); break;
+                case miUINT8: case miUTF8: take((uint8_t)0); break;
+                case miINT16: take((int16_t)0); break;
+                case miUINT16: case miUTF16: take((uint16_t)0); break;
+                case miINT32: take((int32_t)0); break;
+                case miUINT32: case miUTF32: take((uint32_t)0); break;
+                case miINT64: take((int64_t)0); break;
+                case miUINT64: take((uint64_t)0); break;
+                case miSINGLE: take(0.0f); break;
+                case miDOUBLE: take(0.0); break;
+                default: break;
+            }
+            return out;
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * 2mat/tests/plain.hpp -- compares files written through a sink with plain files
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_TEST_PLAIN_H
+#define TOO_MAT_TEST_PLAIN_H
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mat
+{
+
+    namespace test
+    {
+
+        /*
+         * std::vector<unsigned char> mat::test::write_blocks(const std::string &, std::function<void(file<V> &)>)
+         *
+         * Writes a file (without a timestamp) of variables much larger than the blocks of a
+         * buffering sink, so that the sizes of compressed elements are patched into blocks
+         * already handed on, checks that it reads back, and returns its bytes. The file is set up
+         * by setup, if set, before anything is added.
+         */
+        template <file_version V>
+        std::vector<unsigned char> write_blocks(const std::string &name,
+            const std::function<void(file<V> &)> &setup)
+        {
+            std::vector<double> a(20000), b(3000);
+            for (size_t i = 0; i < a.size(); ++i) a[i] = (double)(i % 97);
+            for (size_t i = 0; i < b.size(); ++i) b[i] = 1.0/(double)(i+1);
+            auto path = scratch(name);
+            {
+                file<V> f(path);
+                f.timestamp(false);
+                if (setup) setup(f);
+                f.add("a", a.begin(), a.end(), {100, 200});
+                f.add("b", b.begin(), b.end());
+                f.add("c", std::string("blocks"));
+                f.close().get();
+            }
+            auto bytes = read_file(path);
+            auto vars = read_mat(bytes);
+            CHECK_EQ(vars.size(), (size_t)3);
+            CHECK(find(vars, "a").values<double>() == a);
+            CHECK(find(vars, "b").values<double>() == b);
+            CHECK(find(vars, "c").text() == u"blocks");
+            return bytes;
+        }
+
+        /*
+         * void mat::test::matches_plain_file(const std::string &, std::function<void(file<V> &)>)
+         *
+         * Writes the same file through the sink chosen by setup and as a plain file, and checks
+         * that their bytes are the same.
+         */
+        template <file_version V>
+        void matches_plain_file(const std::string &name,
+            const std::function<void(file<V> &)> &setup)
+        {
+            CHECK(write_blocks<V>(name, setup) == write_blocks<V>("plain.mat", {}));
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * 2mat/tests/rolling.cpp -- tests of output split across numbered files
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+    std::vector<std::string> names(const std::vector<test::variable> &vars)
+    {
+        std::vector<std::string> out;
+        for (auto &v : vars) out.push_back(v.name);
+        return out;
+    }
+}
+
+MAT_TEST(rolling, carried_variables_are_written_once_per_file)
+{
+    auto base = test::scratch("rolling");
+    test::scratch("rolling_0001.mat");
+    test::scratch("rolling_0002.mat");
+    rolling_options opts;
+    opts.max_bytes = 1000;
+    std::vector<double> data(100, 1.0);
+    {
+        rolling<V6> r(base, opts);
+        r.carry("meta");
+        r.add("meta", {1.0});
+        r.add("a", data.begin(), data.end());
+        // Added again while the first file holds it: only the files to come see the new value
+        r.add("meta", {2.0});
+        r.add("meta", {3.0});
+        // Too large for the first file, so this starts the second
+        r.add("b", data.begin(), data.end());
+        r.close().get();
+    }
+
+    auto first = test::read_mat(base + "_0001.mat");
+    CHECK(names(first) == (std::vector<std::string>{"meta", "a"}));
+    CHECK(test::find(first, "meta").values<double>() == std::vector<double>{1.0});
+
+    auto second = test::read_mat(base + "_0002.mat");
+    CHECK(names(second) == (std::vector<std::string>{"meta", "b"}));
+    CHECK(test::find(second, "meta").values<double>() == std::vector<double>{3.0});
+}
+
+MAT_TEST(rolling, carried_variable_added_late_joins_the_current_file)
+{
+    auto base = test::scratch("rolling_late");
+    test::scratch("rolling_late_01.mat");
+    rolling_options opts;
+    opts.digits = 2;
+    {
+        rolling<V7> r(base, opts);
+        r.carry("meta");
+        r.add("a", {1.0});
+        r.add("meta", {4.0});
+        r.close().get();
+    }
+    auto vars = test::read_mat(base + "_01.mat");
+    CHECK(names(vars) == (std::vector<std::string>{"a", "meta"}));
+}
+
+MAT_TEST(rolling, long_file_numbers_are_not_truncated)
+{
+    rolling_options opts;
+    opts.digits = 14;
+    rolling<V6> r("base", opts);
+    CHECK_EQ(r.path(42), std::string("base_00000000000042.mat"));
+    CHECK_EQ(r.path(4000000000u), std::string("base_00004000000000.mat"));
+    opts.digits = 1;
+    rolling<V6> s("base", opts);
+    CHECK_EQ(s.path(123), std::string("base_123.mat"));
+}
+
+MAT_TEST(rolling, blocked_add_does_not_hold_up_other_files)
+{
+    auto base = test::scratch("rolling_blocked");
+    test::scratch("rolling_blocked_0001.mat");
+    test::scratch("rolling_blocked_0002.mat");
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::vector<double> data(100, 2.0);
+    rolling_options opts;
+    opts.async = true;
+    opts.writer.budget = 1000;
+    {
+        rolling<V6> r(base, opts);
+        // Lets the writer go before the files are closed, even if a check fails
+        struct guard
+        {
+            std::promise<void> &p;
+            ~guard() { try { p.set_value(); } catch (...) {} }
+        } let_go{release};
+        // The first file's writer is held up, so the next add to it waits for budget
+        r.add("slow", generate<double>(100, [released](dim_t, dim_t n, double *buf) {
+            released.wait();
+            for (dim_t i = 0; i < n; ++i) buf[i] = 1.0;
+        }));
+        auto waiting = std::async(std::launch::async, [&] {
+            r.add("waiting", data.begin(), data.end());
+        });
+        CHECK(waiting.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+        // Meanwhile, other threads carry on with the next file
+        auto other = std::async(std::launch::async, [&] {
+            r.rotate();
+            r.add("other", {3.0});
+        });
+        auto status = other.wait_for(std::chrono::seconds(10));
+        release.set_value();
+        CHECK(status == std::future_status::ready);
+        waiting.get();
+        other.get();
+        r.close().get();
+    }
+
+    auto first = test::read_mat(base + "_0001.mat");
+    CHECK(names(first) == (std::vector<std::string>{"slow", "waiting"}));
+    CHECK(test::find(first, "waiting").values<double>() == data);
+    auto second = test::read_mat(base + "_0002.mat");
+    CHECK(names(second) == (std::vector<std::string>{"other"}));
+}
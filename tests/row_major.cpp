@@ -0,0 +1,168 @@
+/*
+ * 2mat/tests/row_major.cpp -- tests of matrices added from row-major arrays
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    template <typename T>
+    struct real_of { typedef T type; };
+
+    template <typename T>
+    struct real_of<std::complex<T>> { typedef T type; };
+
+    // A value for each row-major position, distinct for as long as the type allows
+    template <typename T>
+    T value(dim_t i)
+    {
+        typedef typename real_of<T>::type R;
+        if constexpr (std::is_same<T, R>::value) return (T)(i*7 + 3);
+        else return T((R)(i % 100000), -(R)(i % 999));
+    }
+
+    // The column-major position of each row-major position of an array of the passed dimensions
+    std::vector<dim_t> column_positions(const std::vector<dim_t> &dims)
+    {
+        dim_t numel = 1;
+        for (auto d : dims) numel *= d;
+        std::vector<dim_t> out(numel), sub(dims.size(), 0);
+        for (dim_t r = 0; r < numel; ++r)
+        {
+            dim_t col = 0, stride = 1;
+            for (size_t a = 0; a < dims.size(); ++a)
+            {
+                col += sub[a]*stride;
+                stride *= dims[a];
+            }
+            out[r] = col;
+            // The last index varies fastest in row-major order
+            for (size_t a = dims.size(); a-- > 0; )
+            {
+                if (++sub[a] < dims[a]) break;
+                sub[a] = 0;
+            }
+        }
+        return out;
+    }
+
+    // Adds a row-major array through add(name, ptr, n, dims, row_major), and checks that the
+    // file holds it in MATLAB's order
+    template <typename T, file_version V = V6>
+    void check_row_major(const std::vector<dim_t> &dims)
+    {
+        typedef typename real_of<T>::type R;
+        constexpr bool real = std::is_same<T, R>::value;
+        auto cols = column_positions(dims);
+        std::vector<T> data(cols.size());
+        for (size_t i = 0; i < data.size(); ++i) data[i] = value<T>(i);
+        auto path = test::scratch("row_major.mat");
+        {
+            file<V> f(path);
+            f.add("r", data.data(), data.size(), dims, row_major);
+            f.close().get();
+        }
+        auto vars = test::read_mat(path);
+        const test::variable &r = test::find(vars, "r");
+        CHECK(r.dims == dims);
+        CHECK_EQ(r.complex, !real);
+        auto re = r.values<R>(), im = r.values<R>(true);
+        CHECK_EQ(re.size(), data.size());
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            if constexpr (real)
+            {
+                if (re[cols[i]] != data[i])
+                    throw test::failure("Value " + std::to_string(i) + " is out of place");
+            } else {
+                if (re[cols[i]] != data[i].real() || im[cols[i]] != data[i].imag())
+                    throw test::failure("Value " + std::to_string(i) + " is out of place");
+            }
+        }
+    }
+
+    // Shapes that are not whole tiles of the transpose kernels, in two to four dimensions
+    template <typename T>
+    void check_shapes()
+    {
+        check_row_major<T>({37, 53});
+        check_row_major<T>({64, 16});
+        check_row_major<T>({3, 17, 29});
+        check_row_major<T>({2, 3, 5, 7});
+        check_row_major<T, V7>({5, 1, 9, 4});
+    }
+
+}
+
+MAT_TEST(row_major, one_byte_values)
+{
+    check_shapes<int8_t>();
+    check_shapes<uint8_t>();
+}
+
+MAT_TEST(row_major, two_byte_values)
+{
+    check_shapes<int16_t>();
+    check_shapes<uint16_t>();
+}
+
+MAT_TEST(row_major, four_byte_values)
+{
+    check_shapes<int32_t>();
+    check_shapes<float>();
+}
+
+MAT_TEST(row_major, eight_byte_values)
+{
+    check_shapes<int64_t>();
+    check_shapes<double>();
+}
+
+MAT_TEST(row_major, complex_values)
+{
+    check_shapes<std::complex<float>>();
+    check_shapes<std::complex<double>>();
+}
+
+MAT_TEST(row_major, vectors_are_stored_as_they_are)
+{
+    check_row_major<double>({1, 100});
+    check_row_major<double>({100, 1});
+    check_row_major<int16_t>({1, 1, 50});
+}
+
+MAT_TEST(row_major, slab_larger_than_the_buffer)
+{
+    // Each value of the last index selects more than MAT_TBUF bytes, which are gathered and
+    // written in pieces
+    dim_t rows = MAT_TBUF/sizeof(double)/500 + 3;
+    check_row_major<double>({rows, 500, 2});
+    check_row_major<std::complex<float>>({rows, 500, 2});
+    check_row_major<double, V7>({rows, 500, 3});
+}
@@ -0,0 +1,168 @@
+/*
+ * 2mat/tests/sinks.cpp -- tests of files written to memory and to streams
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    // Enough data to span several compressed chunks
+    std::vector<double> big()
+    {
+        std::vector<double> v(3*MAT_ZCHUNK/sizeof(double) + 5);
+        for (size_t i = 0; i < v.size(); ++i) v[i] = (double)(i % 1000) * 0.25;
+        return v;
+    }
+
+    template <file_version V>
+    void fill(file<V> &f, const std::vector<double> &data)
+    {
+        f.add("data", data.begin(), data.end());
+        f.add("small", {1.0, 2.0, 3.0});
+        f.add("text", std::string("written to a sink"));
+    }
+
+    void check(const std::vector<test::variable> &vars, const std::vector<double> &data)
+    {
+        CHECK_EQ(vars.size(), (size_t)3);
+        CHECK(test::find(vars, "data").values<double>() == data);
+        CHECK(test::find(vars, "small").values<double>() == (std::vector<double>{1, 2, 3}));
+        CHECK(test::find(vars, "text").text() == u"written to a sink");
+    }
+
+    // Writes the same file (without a timestamp) to disk, and returns its bytes
+    template <file_version V>
+    std::vector<unsigned char> on_disk(const std::vector<double> &data)
+    {
+        auto path = test::scratch("sinks_disk.mat");
+        {
+            file<V> f(path);
+            f.timestamp(false);
+            fill(f, data);
+            f.close().get();
+        }
+        return test::read_file(path);
+    }
+
+    template <file_version V>
+    void memory_matches_disk()
+    {
+        auto data = big();
+        auto out = std::make_shared<memory_sink>();
+        {
+            file<V> f(out);
+            f.timestamp(false);
+            fill(f, data);
+            f.close().get();
+        }
+        check(test::read_mat(out->data()), data);
+        CHECK(out->data() == on_disk<V>(data));
+    }
+
+    template <file_version V>
+    void stream_matches_disk()
+    {
+        auto data = big();
+        auto path = test::scratch("sinks_stream.mat");
+        {
+            FILE *fp = fopen(path.c_str(), "wb");
+            CHECK(fp != nullptr);
+            file<V> f(std::make_shared<stream_sink>(fp, true));
+            f.timestamp(false);
+            fill(f, data);
+            f.close().get();
+        }
+        check(test::read_mat(path), data);
+        CHECK(test::read_file(path) == on_disk<V>(data));
+    }
+
+}
+
+MAT_TEST(sinks, memory_v6_matches_disk)
+{
+    memory_matches_disk<V6>();
+}
+
+MAT_TEST(sinks, memory_v7_matches_disk)
+{
+    memory_matches_disk<V7>();
+}
+
+MAT_TEST(sinks, stream_v6_matches_disk)
+{
+    stream_matches_disk<V6>();
+}
+
+MAT_TEST(sinks, stream_v7_matches_disk)
+{
+    stream_matches_disk<V7>();
+}
+
+MAT_TEST(sinks, async_to_memory)
+{
+    auto data = big();
+    auto out = std::make_shared<memory_sink>();
+    {
+        file<V7> f(out);
+        f.async({});
+        fill(f, data);
+        f.close().get();
+    }
+    check(test::read_mat(out->data()), data);
+}
+
+MAT_TEST(sinks, take_empties_the_sink)
+{
+    auto out = std::make_shared<memory_sink>(1024);
+    {
+        file<V6> f(out);
+        f.add("x", {4.0});
+        f.close().get();
+    }
+    auto bytes = out->take();
+    CHECK(out->data().empty());
+    CHECK_EQ(out->tell(), (dim_t)0);
+    CHECK_EQ(test::find(test::read_mat(bytes), "x").values<double>()[0], 4.0);
+}
+
+MAT_TEST(sinks, memory_seeks_within_bounds)
+{
+    memory_sink out;
+    const unsigned char bytes[4] = {1, 2, 3, 4};
+    out.write(bytes, 4);
+    out.seek(1, ios::beg);
+    out.write(bytes, 2);
+    CHECK_EQ(out.tell(), (dim_t)3);
+    CHECK(out.data() == (std::vector<unsigned char>{1, 1, 2, 4}));
+    CHECK_THROWS(out.seek(5, ios::beg), mfile_error);
+}
+
+MAT_TEST(sinks, null_sink_throws)
+{
+    CHECK_THROWS(file<V6>(std::shared_ptr<sink>()), mfile_error);
+}
@@ -0,0 +1,168 @@
+/*
+ * 2mat/tests/stats.cpp -- tests of the stats recorded while writing files
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    // Variables of several sizes and types, some of which need padding
+    template <typename F>
+    void add_variables(F &f)
+    {
+        std::vector<double> x(5000);
+        for (size_t i = 0; i < x.size(); ++i) x[i] = (double)(i % 97);
+        std::vector<int8_t> small = {1, 2, 3};
+        f.add("x", x.begin(), x.end());
+        f.add("small", small.begin(), small.end());
+        f.add("text", std::string("some text"));
+        f.add("scalar", {4.0});
+    }
+
+    // Writes the variables, recording stats, and returns them
+    template <file_version V>
+    file_stats write(const std::string &path, bool async = false, unsigned int workers = 0)
+    {
+        file_stats out;
+        {
+            file<V> f(path);
+            f.timestamp(false);
+            f.record_stats([&out](const file_stats &s) { out = s; });
+            if (async)
+            {
+                async_options opts;
+                opts.workers = workers;
+                f.async(opts);
+            }
+            add_variables(f);
+            f.close().get();
+        }
+        return out;
+    }
+
+    dim_t file_size(const std::string &path)
+    {
+        return test::read_file(path).size();
+    }
+
+    // The totals are the header and the sums of the variables
+    void check_sums(const file_stats &s)
+    {
+        write_stats sum;
+        for (auto &v : s.variables) sum += v;
+        CHECK_EQ(s.total.bytes, sum.bytes + 128);
+        CHECK_EQ(s.total.written, sum.written + 128);
+        CHECK_EQ(s.total.padding, sum.padding);
+        CHECK_EQ(s.total.seeks, sum.seeks);
+        CHECK_EQ(s.total.cached, sum.cached);
+        CHECK(s.total.writes > sum.writes);
+    }
+
+    // Two recordings of the same variables
+    void check_same(const file_stats &a, const file_stats &b)
+    {
+        CHECK_EQ(a.variables.size(), b.variables.size());
+        for (size_t i = 0; i < a.variables.size(); ++i)
+        {
+            auto &x = a.variables[i], &y = b.variables[i];
+            CHECK_EQ(x.name, y.name);
+            CHECK_EQ(x.bytes, y.bytes);
+            CHECK_EQ(x.written, y.written);
+            CHECK_EQ(x.padding, y.padding);
+            CHECK_EQ(x.seeks, y.seeks);
+        }
+        CHECK_EQ(a.total.bytes, b.total.bytes);
+        CHECK_EQ(a.total.written, b.total.written);
+    }
+
+}
+
+MAT_TEST(stats, v6_totals_match_the_file)
+{
+    auto path = test::scratch("stats_v6.mat");
+    auto s = write<V6>(path);
+    CHECK_EQ(s.variables.size(), (size_t)4);
+    CHECK_EQ(s.variables[0].name, std::string("x"));
+    CHECK_EQ(s.total.written, file_size(path));
+    // Nothing is compressed
+    CHECK_EQ(s.total.bytes, s.total.written);
+    CHECK(s.total.padding > 0);
+    CHECK_EQ(s.total.seeks, (dim_t)0);
+    check_sums(s);
+}
+
+MAT_TEST(stats, v7_totals_match_the_file)
+{
+    auto path = test::scratch("stats_v7.mat");
+    auto s = write<V7>(path);
+    CHECK_EQ(s.variables.size(), (size_t)4);
+    CHECK_EQ(s.total.written, file_size(path));
+    CHECK(s.total.bytes > s.total.written);
+    // Each compressed size is filled in afterwards: there and back again
+    CHECK_EQ(s.total.seeks, (dim_t)8);
+    check_sums(s);
+    for (auto &v : s.variables) CHECK(v.written < v.bytes + 8);
+}
+
+MAT_TEST(stats, v7_totals_match_an_unseekable_file)
+{
+    auto path = test::scratch("stats_stream.mat");
+    file_stats s;
+    {
+        FILE *fp = fopen(path.c_str(), "wb");
+        CHECK(fp != nullptr);
+        file<V7> f(std::make_shared<stream_sink>(fp, true));
+        f.record_stats([&s](const file_stats &st) { s = st; });
+        add_variables(f);
+        f.close().get();
+    }
+    CHECK_EQ(s.total.written, file_size(path));
+    CHECK_EQ(s.total.seeks, (dim_t)0);
+    check_sums(s);
+    // The same bytes as a seekable file, without the seeks
+    auto t = write<V7>(test::scratch("stats_seekable.mat"));
+    CHECK_EQ(s.total.bytes, t.total.bytes);
+    CHECK_EQ(s.total.written, t.total.written);
+}
+
+MAT_TEST(stats, async_counts_match_sync)
+{
+    for (auto workers : {0u, 2u})
+    {
+        auto v6 = write<V6>(test::scratch("stats_async_v6.mat"), true, workers);
+        check_same(v6, write<V6>(test::scratch("stats_sync_v6.mat")));
+        CHECK_EQ(v6.total.written, file_size(test::scratch("stats_async_v6.mat")));
+        check_sums(v6);
+
+        auto v7 = write<V7>(test::scratch("stats_async_v7.mat"), true, workers);
+        check_same(v7, write<V7>(test::scratch("stats_sync_v7.mat")));
+        CHECK_EQ(v7.total.written, file_size(test::scratch("stats_async_v7.mat")));
+        check_sums(v7);
+    }
+}
@@ -0,0 +1,234 @@
+/*
+ * 2mat/tests/strings.cpp -- tests of strings and char matrices
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+#include "simd/kernels.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    // Reference encoders, one code point at a time
+    std::string utf8(const std::u32string &s)
+    {
+        std::string out;
+        for (char32_t c : s)
+        {
+            if (c < 0x80) {
+                out += (char)c;
+            } else if (c < 0x800) {
+                out += (char)(0xc0 | (c >> 6));
+                out += (char)(0x80 | (c & 0x3f));
+            } else if (c < 0x10000) {
+                out += (char)(0xe0 | (c >> 12));
+                out += (char)(0x80 | ((c >> 6) & 0x3f));
+                out += (char)(0x80 | (c & 0x3f));
+            } else {
+                out += (char)(0xf0 | (c >> 18));
+                out += (char)(0x80 | ((c >> 12) & 0x3f));
+                out += (char)(0x80 | ((c >> 6) & 0x3f));
+                out += (char)(0x80 | (c & 0x3f));
+            }
+        }
+        return out;
+    }
+
+    std::u16string utf16(const std::u32string &s)
+    {
+        std::u16string out;
+        for (char32_t c : s)
+        {
+            if (c < 0x10000)
+            {
+                out += (char16_t)c;
+                continue;
+            }
+            out += (char16_t)(0xd800 + ((c - 0x10000) >> 10));
+            out += (char16_t)(0xdc00 + (c & 0x3ff));
+        }
+        return out;
+    }
+
+    // Long runs of ASCII broken up by characters of every length, at offsets that fall all over
+    // the 16-byte blocks of the kernels
+    std::u32string mixed(size_t n)
+    {
+        const char32_t wide[] = {U'é', U'中', U'\U0001f600', U'߿', U'￿'};
+        std::u32string s;
+        for (size_t i = 0; i < n; ++i)
+            s += i % 37 == 36 || i % 53 == 0 ? wide[i % 5] : (char32_t)(U'a' + i % 26);
+        return s;
+    }
+
+    std::vector<test::variable> write(const std::string &name,
+        const std::function<void(file<V7> &)> &add)
+    {
+        auto path = test::scratch(name);
+        {
+            file<V7> f(path);
+            add(f);
+            f.close().get();
+        }
+        return test::read_mat(path);
+    }
+
+}
+
+MAT_TEST(strings, ascii_is_stored_as_utf8)
+{
+    auto vars = write("strings_ascii.mat", [](file<V7> &f) {
+        f.add("s", std::string("plain text"));
+        f.add("empty", std::string());
+    });
+    auto &s = test::find(vars, "s");
+    CHECK_EQ(s.mclass, mxCHAR_CLASS);
+    CHECK_EQ(s.type, miUTF8);
+    CHECK(s.dims == (std::vector<dim_t>{1, 10}));
+    CHECK(s.text() == u"plain text");
+    CHECK_EQ(test::find(vars, "empty").numel(), (dim_t)0);
+}
+
+MAT_TEST(strings, utf8_is_transcoded_to_utf16)
+{
+    auto text = mixed(1000);
+    std::string nul("a\0b", 3);
+    auto vars = write("strings_utf8.mat", [&](file<V7> &f) {
+        f.add("s", utf8(U"café 中 \U0001f600"));
+        f.add("long", utf8(text));
+        f.add("nul", nul);
+    });
+    auto &s = test::find(vars, "s");
+    CHECK_EQ(s.type, miUTF16);
+    // Characters beyond U+FFFF take two chars, as in MATLAB
+    CHECK(s.dims == (std::vector<dim_t>{1, 9}));
+    CHECK(s.text() == u"café 中 \U0001f600");
+    auto &l = test::find(vars, "long");
+    CHECK(l.text() == utf16(text));
+    CHECK_EQ(l.numel(), (dim_t)utf16(text).size());
+    CHECK(test::find(vars, "nul").text() == std::u16string(u"a\0b", 3));
+}
+
+MAT_TEST(strings, wide_strings)
+{
+    auto vars = write("strings_wide.mat", [](file<V7> &f) {
+        f.add("u16", std::u16string(u"été 中"));
+        f.add("u32", std::u32string(U"été"));
+    });
+    CHECK(test::find(vars, "u16").text() == u"été 中");
+    CHECK(test::find(vars, "u16").dims == (std::vector<dim_t>{1, 5}));
+    CHECK(test::find(vars, "u32").text() == u"été");
+}
+
+MAT_TEST(strings, invalid_utf8_throws)
+{
+    const char *bad[] = {
+        "\xe4\xb8",             // truncated
+        "\xc0\xaf",             // overlong
+        "\xe0\x80\xaf",         // overlong, three bytes
+        "\xed\xa0\x80",         // surrogate
+        "\xf4\x90\x80\x80",     // beyond U+10FFFF
+        "\x80",                 // stray continuation byte
+        "\xff",
+    };
+    for (auto b : bad)
+    {
+        // On its own, and after runs of ASCII of every length up to a couple of blocks
+        for (size_t pad = 0; pad < 40; ++pad)
+        {
+            std::string s = std::string(pad, 'x') + b + "tail";
+            CHECK_THROWS(simd::utf16_length(s.data(), s.size()), mfile_error);
+            std::u16string out(s.size(), u'\0');
+            CHECK_THROWS(simd::utf8_to_utf16(s.data(), s.size(), &out[0]), mfile_error);
+            file<V7> f(test::scratch("strings_bad.mat"));
+            CHECK_THROWS(f.add("s", s), mfile_error);
+            CHECK_THROWS(f.add("m", std::vector<std::string>{"ok", s}), mfile_error);
+        }
+    }
+}
+
+MAT_TEST(strings, kernels_match_reference)
+{
+    for (size_t n = 0; n < 200; ++n)
+    {
+        auto text = mixed(n);
+        auto in = utf8(text);
+        auto expected = utf16(text);
+        CHECK_EQ(simd::utf16_length(in.data(), in.size()), (dim_t)expected.size());
+        std::u16string out(expected.size(), u'\0');
+        CHECK_EQ(simd::utf8_to_utf16(in.data(), in.size(), &out[0]), (dim_t)expected.size());
+        CHECK(out == expected);
+    }
+}
+
+MAT_TEST(strings, char_matrix_rows_are_padded)
+{
+    std::vector<std::string> rows = {"one", utf8(U"twö"), "three", "", utf8(U"\U0001f600")};
+    auto vars = write("strings_matrix.mat", [&](file<V7> &f) {
+        f.add("m", rows);
+        f.add("none", std::vector<std::string>());
+    });
+    auto &m = test::find(vars, "m");
+    CHECK_EQ(m.mclass, mxCHAR_CLASS);
+    // One row that isn't ASCII makes every row UTF-16
+    CHECK_EQ(m.type, miUTF16);
+    CHECK(m.dims == (std::vector<dim_t>{5, 5}));
+    std::u16string padded[] = {u"one  ", u"twö  ", u"three", u"     ", u"\U0001f600   "};
+    std::u16string expected;
+    for (size_t c = 0; c < 5; ++c)
+        for (auto &r : padded) expected += r[c];
+    CHECK(m.text() == expected);
+    CHECK_EQ(test::find(vars, "none").numel(), (dim_t)0);
+}
+
+MAT_TEST(strings, ascii_char_matrix_is_utf8)
+{
+    std::vector<std::string> rows = {"alpha", "be", "", "gamma!"};
+    auto vars = write("strings_ascii.mat", [&](file<V7> &f) {
+        f.add("m", rows);
+    });
+    auto &m = test::find(vars, "m");
+    CHECK_EQ(m.mclass, mxCHAR_CLASS);
+    CHECK_EQ(m.type, miUTF8);
+    CHECK(m.dims == (std::vector<dim_t>{4, 6}));
+    std::u16string padded[] = {u"alpha ", u"be    ", u"      ", u"gamma!"};
+    std::u16string expected;
+    for (size_t c = 0; c < 6; ++c)
+        for (auto &r : padded) expected += r[c];
+    CHECK(m.text() == expected);
+}
+
+MAT_TEST(strings, char_matrix_in_struct)
+{
+    auto vars = write("strings_struct.mat", [](file<V7> &f) {
+        mstruct s("s");
+        s.add("labels", std::vector<std::string>{"ab", "c"});
+        f.add(s);
+    });
+    auto &labels = test::find(vars, "s").field("labels");
+    CHECK(labels.dims == (std::vector<dim_t>{2, 2}));
+    CHECK_EQ(labels.type, miUTF8);
+    CHECK(labels.text() == u"acb ");
+}
@@ -0,0 +1,97 @@
+/*
+ * 2mat/tests/test.hpp -- a minimal test harness for the 2mat tests
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOO_MAT_TEST_H
+#define TOO_MAT_TEST_H
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace mat
+{
+
+    namespace test
+    {
+
+        // Thrown by the CHECK macros when a check fails
+        class failure : public std::runtime_error
+        {
+        public:
+            explicit failure(const std::string &m) : std::runtime_error(m) {}
+        };
+
+        // Adds a test to the suite with the passed name; used by MAT_TEST
+        struct registrar
+        {
+            registrar(const char *suite, const char *name, void (*fn)());
+        };
+
+        // A path for a scratch file, unique to the test program, that is removed once the test
+        // that asked for it has finished
+        std::string scratch(const std::string &name);
+
+        template <typename A, typename B>
+        void check_eq(const A &a, const B &b, const char *expr, const char *file, int line)
+        {
+            if (a == b) return;
+            std::ostringstream ss;
+            ss << file << ":" << line << ": " << expr << " (" << a << " != " << b << ")";
+            throw failure(ss.str());
+        }
+
+    }
+
+}
+
+/*
+ * MAT_TEST(suite, name)
+ *
+ * Defines a test, run as part of the named suite (each suite is a separate ctest test):
+ *
+ * MAT_TEST(sinks, memory_round_trip)
+ * {
+ *     CHECK(...);
+ * }
+ */
+#define MAT_TEST(suite, name) \
+    static void suite##_##name(); \
+    static mat::test::registrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define MAT_TEST_STR2(x) #x
+#define MAT_TEST_STR(x) MAT_TEST_STR2(x)
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) \
+            throw mat::test::failure(__FILE__ ":" MAT_TEST_STR(__LINE__) ": " #cond); \
+    } while (0)
+
+#define CHECK_EQ(a, b) mat::test::check_eq((a), (b), #a " == " #b, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expr, type) \
+    do { \
+        bool thrown = false; \
+        try { expr; } catch (const type &) { thrown = true; } \
+        if (!thrown) throw mat::test::failure(__FILE__ ":" MAT_TEST_STR(__LINE__) \
+            ": " #expr " did not throw " #type); \
+    } while (0)
+
+#endif
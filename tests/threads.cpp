@@ -0,0 +1,110 @@
+/*
+ * 2mat/tests/threads.cpp -- tests of adding to a file from many threads
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    const int THREADS = 8, ADDS = 250;
+
+    // Each thread adds its own variables, named and filled after the thread and the add
+    template<typename F>
+    void add_from_threads(F &f)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&f,t]() {
+                for (int i = 0; i < ADDS; ++i)
+                {
+                    std::vector<double> data(1 + i % 37, t*1000.0 + i);
+                    f.add("t" + std::to_string(t) + "_" + std::to_string(i),
+                        data.begin(), data.end());
+                }
+            });
+        }
+        for (auto &t : threads) t.join();
+    }
+
+    // Every variable is in the file exactly once, with its own data
+    void check_file(const std::string &path)
+    {
+        auto vars = test::read_mat(path);
+        CHECK_EQ(vars.size(), (size_t)(THREADS*ADDS));
+        std::map<std::string,int> seen;
+        for (auto &v : vars) ++seen[v.name];
+        CHECK_EQ(seen.size(), (size_t)(THREADS*ADDS));
+        for (int t = 0; t < THREADS; ++t)
+        {
+            for (int i = 0; i < ADDS; ++i)
+            {
+                auto name = "t" + std::to_string(t) + "_" + std::to_string(i);
+                CHECK_EQ(seen[name], 1);
+                CHECK(test::find(vars, name).values<double>()
+                    == std::vector<double>(1 + i % 37, t*1000.0 + i));
+            }
+        }
+    }
+
+}
+
+MAT_TEST(threads, adds_to_v6)
+{
+    auto path = test::scratch("threads_v6.mat");
+    {
+        file<V6> f(path);
+        add_from_threads(f);
+    }
+    check_file(path);
+}
+
+MAT_TEST(threads, adds_to_v7)
+{
+    auto path = test::scratch("threads_v7.mat");
+    {
+        file<V7> f(path);
+        add_from_threads(f);
+    }
+    check_file(path);
+}
+
+MAT_TEST(threads, adds_to_async_file)
+{
+    auto path = test::scratch("threads_async.mat");
+    {
+        file<V7> f(path);
+        async_options opts;
+        opts.workers = 2;
+        opts.budget = 1 << 16;
+        f.async(opts);
+        add_from_threads(f);
+        f.close().get();
+    }
+    check_file(path);
+}
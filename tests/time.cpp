@@ -0,0 +1,96 @@
+/*
+ * 2mat/tests/time.cpp -- tests of timestamp arrays written as datenums
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace mat;
+
+MAT_TEST(time, epochs_round_trip)
+{
+    std::vector<double> unix_s = {0, 1.5e9, -86400.25}, mjd = {51544.5, 60000};
+    std::vector<int64_t> unix_ns = {0, 1500000000123456789ll, -1};
+    std::vector<long long> tt = {0, 536500869184000000ll, -883655957816000000ll};
+    auto path = test::scratch("time.mat");
+    {
+        file<V7> f(path);
+        f.add_time("unix_s", UNIX, unix_s.data(), unix_s.size());
+        f.add_time("mjd", MJD, mjd.data(), mjd.size(), {2,1});
+        // int64_t is long on LP64 platforms, and long long elsewhere
+        f.add_time("unix_ns", UNIX, unix_ns.data(), unix_ns.size());
+        f.add_time("tt", TT2000, tt.data(), tt.size());
+        f.close().get();
+    }
+    auto vars = test::read_mat(path);
+    auto check = [&](const char *name, const std::vector<double> &expected) {
+        auto &v = test::find(vars, name);
+        CHECK_EQ(v.mclass, mxDOUBLE_CLASS);
+        CHECK(v.values<double>() == expected);
+    };
+    check("unix_s", {unix2dn(0.0), unix2dn(1.5e9), unix2dn(-86400.25)});
+    check("mjd", {mjd2dn(51544.5), mjd2dn(60000.0)});
+    CHECK(test::find(vars, "mjd").dims == (std::vector<dim_t>{2,1}));
+    std::vector<double> ns;
+    for (auto t : unix_ns) ns.push_back(719529.0 + (double)t/86400e9);
+    check("unix_ns", ns);
+    check("tt", {tt20002dn(tt[0]), tt20002dn(tt[1]), tt20002dn(tt[2])});
+}
+
+MAT_TEST(time, long_timestamps_span_pieces)
+{
+    // More values than are widened from long at a time
+    std::vector<long> t(2000);
+    for (size_t i = 0; i < t.size(); ++i) t[i] = (long)i*1000000007l;
+    auto path = test::scratch("time_long.mat");
+    {
+        file<V6> f(path);
+        f.add_time("t", TT2000, t.data(), t.size());
+        f.close().get();
+    }
+    auto dn = test::find(test::read_mat(path), "t").values<double>();
+    CHECK_EQ(dn.size(), t.size());
+    for (size_t i = 0; i < t.size(); ++i) CHECK_EQ(dn[i], tt20002dn((long long)t[i]));
+}
+
+MAT_TEST(time, bad_epochs_throw)
+{
+    double d = 0;
+    long long n = 0;
+    file<V6> f(test::scratch("time_bad.mat"));
+    CHECK_THROWS(f.add_time("x", TT2000, &d, 1), mfile_error);
+    CHECK_THROWS(f.add_time("x", MJD, &n, 1), mfile_error);
+}
+
+MAT_TEST(time, empty_dims_stay_unambiguous)
+{
+    // A trailing {} is the dimensions of a plain matrix, as it always was
+    std::vector<double> d = {1, 2, 3};
+    auto path = test::scratch("time_dims.mat");
+    {
+        file<V6> f(path);
+        f.add("d", d.data(), d.size(), {});
+        f.close().get();
+    }
+    CHECK(test::find(test::read_mat(path), "d").values<double>() == d);
+}
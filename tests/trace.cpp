@@ -0,0 +1,217 @@
+/*
+ * 2mat/tests/trace.cpp -- tests of the trace of the write path, in builds with MAT_TRACE
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "2mat.hpp"
+#include "trace.hpp"
+
+#include <cctype>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Spans are only recorded when tracing is built in; the suite is only run then
+#ifdef MAT_TRACE
+
+using namespace mat;
+
+namespace
+{
+
+    // A small JSON parser, which only checks that the text is valid
+    class json
+    {
+        const std::string &s;
+        size_t p = 0;
+
+        void fail(const char *why)
+        {
+            throw test::failure(std::string("Invalid JSON at ") + std::to_string(p) + ": " + why);
+        }
+
+        void space()
+        {
+            while (p < s.size() && std::isspace((unsigned char)s[p])) ++p;
+        }
+
+        void expect(char c)
+        {
+            space();
+            if (p == s.size() || s[p] != c) fail("unexpected character");
+            ++p;
+        }
+
+        void string()
+        {
+            expect('"');
+            while (p < s.size() && s[p] != '"')
+            {
+                if ((unsigned char)s[p] < 0x20) fail("control character in string");
+                if (s[p++] == '\\') ++p;
+            }
+            expect('"');
+        }
+
+        void number()
+        {
+            size_t start = p;
+            if (s[p] == '-') ++p;
+            while (p < s.size() && (std::isdigit((unsigned char)s[p]) || s[p] == '.' || s[p] == 'e'
+                || s[p] == 'E' || s[p] == '+' || s[p] == '-')) ++p;
+            try
+            {
+                (void)std::stod(s.substr(start, p-start));
+            } catch (std::exception &) {
+                fail("bad number");
+            }
+        }
+
+        template <typename F>
+        void list(char open, char close, F item)
+        {
+            expect(open);
+            space();
+            if (p < s.size() && s[p] == close)
+            {
+                ++p;
+                return;
+            }
+            for (;;)
+            {
+                item();
+                space();
+                if (p < s.size() && s[p] == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                expect(close);
+                return;
+            }
+        }
+
+        void value()
+        {
+            space();
+            if (p == s.size()) fail("missing value");
+            char c = s[p];
+            if (c == '{') list('{', '}', [this] { string(); expect(':'); value(); });
+            else if (c == '[') list('[', ']', [this] { value(); });
+            else if (c == '"') string();
+            else if (c == '-' || std::isdigit((unsigned char)c)) number();
+            else
+            {
+                for (const char *word : {"true", "false", "null"})
+                {
+                    if (s.compare(p, std::string(word).size(), word) == 0)
+                    {
+                        p += std::string(word).size();
+                        return;
+                    }
+                }
+                fail("unknown value");
+            }
+        }
+    public:
+        explicit json(const std::string &s) : s(s)
+        {
+            value();
+            space();
+            if (p != s.size()) fail("text after the value");
+        }
+    };
+
+    std::string dumped()
+    {
+        std::ostringstream out;
+        trace::dump(out);
+        json check(out.str());
+        return out.str();
+    }
+
+    size_t count(const std::string &text, const std::string &name)
+    {
+        size_t n = 0;
+        std::string key = "\"name\":\"" + name + "\"";
+        for (size_t at = text.find(key); at != std::string::npos; at = text.find(key, at+1)) ++n;
+        return n;
+    }
+
+}
+
+MAT_TEST(trace, spans_are_dumped_as_json)
+{
+    trace::clear();
+    auto path = test::scratch("trace.mat");
+    std::vector<double> x(1000, 1.0);
+    {
+        file<V7> f(path);
+        f.add("x", x.begin(), x.end());
+        f.close().get();
+    }
+    {
+        MAT_TRACE_SPAN("test::outer");
+        MAT_TRACE_SPAN("test::inner");
+    }
+    auto text = dumped();
+    CHECK_EQ(count(text, "test::outer"), (size_t)1);
+    CHECK_EQ(count(text, "test::inner"), (size_t)1);
+    CHECK(count(text, "zfilter::compress") > 0);
+    CHECK(text.find("\"ph\":\"X\"") != std::string::npos);
+
+    // Cleared spans are left out
+    trace::clear();
+    text = dumped();
+    CHECK_EQ(count(text, "test::outer"), (size_t)0);
+    CHECK_EQ(count(text, "zfilter::compress"), (size_t)0);
+}
+
+MAT_TEST(trace, full_buffer_is_reused_after_clear)
+{
+    trace::clear();
+    // A thread of its own, so that its buffer starts empty; the checks are made once it is done
+    std::string full, reused;
+    std::thread t([&] {
+        for (unsigned long i = 0; i < (unsigned long)MAT_TRACE_CHUNK*MAT_TRACE_CHUNKS; ++i)
+        {
+            auto now = trace::now();
+            trace::record("test::fill", now, now);
+        }
+        // The buffer is full, so this is dropped
+        auto now = trace::now();
+        trace::record("test::dropped", now, now);
+        full = dumped();
+
+        trace::clear();
+        for (int i = 0; i < 3; ++i)
+        {
+            now = trace::now();
+            trace::record("test::kept", now, now);
+        }
+        reused = dumped();
+    });
+    t.join();
+    CHECK_EQ(count(full, "test::fill"), (size_t)MAT_TRACE_CHUNK*MAT_TRACE_CHUNKS);
+    CHECK_EQ(count(full, "test::dropped"), (size_t)0);
+    CHECK_EQ(count(reused, "test::fill"), (size_t)0);
+    CHECK_EQ(count(reused, "test::kept"), (size_t)3);
+}
+
+#endif
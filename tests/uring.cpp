@@ -0,0 +1,98 @@
+/*
+ * 2mat/tests/uring.cpp -- tests of files written through io_uring
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "plain.hpp"
+#include "2mat.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+// The cases particular to io_uring; whole files are compared with plain files by the same helper
+// as the large-file tests (see plain.hpp). Where io_uring isn't supported, these check the
+// fallback to a plain file.
+
+MAT_TEST(uring, single_buffer)
+{
+    // With one buffer, each block is waited for before the next is filled
+    auto one = [](auto &f) {
+        uring_options opts;
+        opts.depth = 1;
+        opts.block = 4096;
+        f.uring(opts);
+    };
+    test::matches_plain_file<V6>("uring.mat", one);
+    test::matches_plain_file<V7>("uring.mat", one);
+}
+
+MAT_TEST(uring, async_file)
+{
+    std::vector<double> data(50000, 3.0);
+    auto path = test::scratch("uring_async.mat");
+    {
+        file<V7> f(path);
+        uring_options opts;
+        opts.block = 8192;
+        f.uring(opts);
+        f.async({});
+        f.add("x", data.begin(), data.end());
+        f.close().get();
+    }
+    CHECK(test::find(test::read_mat(path), "x").values<double>() == data);
+}
+
+MAT_TEST(uring, open_falls_back_to_file_sink)
+{
+    auto out = uring_sink::open(test::scratch("uring_open.bin"));
+    CHECK_EQ((bool)std::dynamic_pointer_cast<uring_sink>(out), uring_sink::supported());
+    CHECK_EQ((bool)std::dynamic_pointer_cast<file_sink>(out), !uring_sink::supported());
+    out->close();
+}
+
+MAT_TEST(uring, patches_blocks_already_submitted)
+{
+    if (!uring_sink::supported()) return;
+    auto path = test::scratch("uring_patch.bin");
+    std::vector<unsigned char> expected(40000);
+    for (size_t i = 0; i < expected.size(); ++i) expected[i] = (unsigned char)(i*13);
+    {
+        uring_options opts;
+        opts.depth = 2;
+        opts.block = 4096;
+        uring_sink out(path, opts);
+        out.write(expected.data(), expected.size());
+        // Both in a block already submitted, and across into the buffer still being filled
+        const unsigned char patch[6] = {1, 2, 3, 4, 5, 6};
+        out.seek(10, ios::beg);
+        out.write(patch, 6);
+        out.seek(36861, ios::beg);
+        out.write(patch, 6);
+        std::copy(patch, patch+6, expected.begin()+10);
+        std::copy(patch, patch+6, expected.begin()+36861);
+        CHECK_EQ(out.tell(), (dim_t)36867);
+        CHECK_THROWS(out.seek(1, ios::end), mfile_error);
+        out.close();
+    }
+    CHECK(test::read_file(path) == expected);
+}
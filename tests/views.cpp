@@ -0,0 +1,175 @@
+/*
+ * 2mat/tests/views.cpp -- tests of matrices written from views of arrays
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    // Just enough of std::mdspan for a view to be made from it
+    struct fake_mdspan
+    {
+        typedef const int32_t element_type;
+        const int32_t *p;
+        dim_t e[2];
+        std::ptrdiff_t s[2];
+
+        [[nodiscard]] const int32_t *data_handle() const { return p; }
+        [[nodiscard]] static constexpr size_t rank() { return 2; }
+        [[nodiscard]] dim_t extent(size_t r) const { return e[r]; }
+        [[nodiscard]] std::ptrdiff_t stride(size_t r) const { return s[r]; }
+    };
+
+    template <file_version V>
+    std::vector<test::variable> write(const std::string &name,
+        const std::function<void(file<V> &)> &add)
+    {
+        auto path = test::scratch(name);
+        {
+            file<V> f(path);
+            add(f);
+            f.close().get();
+        }
+        return test::read_mat(path);
+    }
+
+    // A sub-block of a larger 3-D array, large enough to be gathered in several pieces
+    template <file_version V>
+    void sub_block()
+    {
+        const dim_t X = 64, Y = 72, Z = 52, x = 60, y = 70, z = 50;
+        std::vector<double> all(X*Y*Z);
+        for (size_t i = 0; i < all.size(); ++i) all[i] = (double)i;
+        std::vector<double> expected;
+        for (dim_t k = 1; k < 1+z; ++k)
+            for (dim_t j = 2; j < 2+y; ++j)
+                for (dim_t i = 3; i < 3+x; ++i) expected.push_back(all[i + X*(j + Y*k)]);
+        auto vars = write<V>("views_block.mat", [&](file<V> &f) {
+            view<double> v(all.data() + 3 + X*(2 + Y*1), {x, y, z},
+                {1, (std::ptrdiff_t)X, (std::ptrdiff_t)(X*Y)});
+            f.add("block", v);
+        });
+        const test::variable &var = test::find(vars, "block");
+        CHECK(var.dims == (std::vector<dim_t>{x, y, z}));
+        CHECK(var.values<double>() == expected);
+    }
+
+}
+
+MAT_TEST(views, contiguous_matches_plain_add)
+{
+    std::vector<float> data(1000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = (float)i * 0.5f;
+    auto plain = test::scratch("views_plain.mat"), viewed = test::scratch("views_viewed.mat");
+    {
+        file<V7> f(plain);
+        f.timestamp(false);
+        f.add("x", data.data(), data.size(), {25, 40});
+        f.close().get();
+    }
+    {
+        file<V7> f(viewed);
+        f.timestamp(false);
+        f.add("x", view<float>(data.data(), {25, 40}));
+        f.close().get();
+    }
+    CHECK(test::read_file(plain) == test::read_file(viewed));
+}
+
+MAT_TEST(views, row_major_is_transposed)
+{
+    std::vector<int16_t> data = {1, 2, 3, 4, 5, 6};
+    auto vars = write<V6>("views_rows.mat", [&](file<V6> &f) {
+        f.add("m", view<int16_t>(data.data(), {2, 3}, row_major));
+    });
+    auto &m = test::find(vars, "m");
+    CHECK_EQ(m.mclass, mxINT16_CLASS);
+    CHECK(m.dims == (std::vector<dim_t>{2, 3}));
+    CHECK(m.values<int16_t>() == (std::vector<int16_t>{1, 4, 2, 5, 3, 6}));
+}
+
+MAT_TEST(views, interleaved_channel)
+{
+    const dim_t h = 3, w = 4;
+    std::vector<uint8_t> rgb(h*w*3);
+    for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = (uint8_t)i;
+    auto vars = write<V7>("views_rgb.mat", [&](file<V7> &f) {
+        f.add("g", view<uint8_t>(rgb.data() + 1, {h, w}, {3*w, 3}));
+    });
+    std::vector<uint8_t> expected;
+    for (dim_t c = 0; c < w; ++c)
+        for (dim_t r = 0; r < h; ++r) expected.push_back(rgb[3*(r*w + c) + 1]);
+    auto &g = test::find(vars, "g");
+    CHECK_EQ(g.mclass, mxUINT8_CLASS);
+    CHECK(g.values<uint8_t>() == expected);
+}
+
+MAT_TEST(views, negative_strides_reverse)
+{
+    std::vector<double> data = {1, 2, 3, 4, 5};
+    auto vars = write<V6>("views_reverse.mat", [&](file<V6> &f) {
+        f.add("r", view<double>(data.data() + 4, {5}, {-1}));
+        f.add("s", view<double>(data.data() + 2, {}, std::vector<std::ptrdiff_t>{}));
+    });
+    auto &r = test::find(vars, "r");
+    CHECK(r.dims == (std::vector<dim_t>{1, 5}));
+    CHECK(r.values<double>() == (std::vector<double>{5, 4, 3, 2, 1}));
+    auto &s = test::find(vars, "s");
+    CHECK(s.dims == (std::vector<dim_t>{1, 1}));
+    CHECK(s.values<double>() == (std::vector<double>{3}));
+}
+
+MAT_TEST(views, v6_sub_block)
+{
+    sub_block<V6>();
+}
+
+MAT_TEST(views, v7_sub_block)
+{
+    sub_block<V7>();
+}
+
+MAT_TEST(views, from_mdspan)
+{
+    std::vector<int32_t> data = {1, 2, 3, 4, 5, 6};
+    fake_mdspan m{data.data(), {3, 2}, {2, 1}};
+    auto vars = write<V7>("views_mdspan.mat", [&](file<V7> &f) {
+        f.add("m", view(m));
+    });
+    auto &v = test::find(vars, "m");
+    CHECK_EQ(v.mclass, mxINT32_CLASS);
+    CHECK(v.dims == (std::vector<dim_t>{3, 2}));
+    CHECK(v.values<int32_t>() == (std::vector<int32_t>{1, 3, 5, 2, 4, 6}));
+}
+
+MAT_TEST(views, strides_must_match_extents)
+{
+    double d = 0;
+    CHECK_THROWS(view<double>(&d, {1, 1}, std::vector<std::ptrdiff_t>{1}), mfile_error);
+}
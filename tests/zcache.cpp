@@ -0,0 +1,189 @@
+/*
+ * 2mat/tests/zcache.cpp -- tests of the cache of compressed elements
+ *
+ * Version: 1.0
+ * Date created: 2026 October 18
+ * Copyright (c) 2026 Aaron Hendry
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test.hpp"
+#include "matread.hpp"
+#include "2mat.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mat;
+
+namespace
+{
+
+    std::vector<double> series(size_t n, double step)
+    {
+        std::vector<double> v(n);
+        for (size_t i = 0; i < v.size(); ++i) v[i] = (double)(i % 251) * step;
+        return v;
+    }
+
+    // Writes x, y and x again, with every variable cached in cache (if any), and returns the bytes
+    // of the file
+    std::vector<unsigned char> write(const std::string &name, std::shared_ptr<zcache> cache,
+        int level = MAT_ZLEVEL)
+    {
+        auto x = series(20000, 0.5), y = series(5000, 2.0);
+        auto path = test::scratch(name);
+        {
+            file<V7> f(path);
+            f.timestamp(false);
+            compress_options opts;
+            opts.cache = std::move(cache);
+            opts.level = level;
+            f.compression(opts);
+            f.add("x", x.begin(), x.end());
+            f.add("y", y.begin(), y.end());
+            f.add("x", x.begin(), x.end());
+            f.close().get();
+        }
+        auto bytes = test::read_file(path);
+        auto vars = test::read_mat(bytes);
+        CHECK_EQ(vars.size(), (size_t)3);
+        CHECK(vars[0].values<double>() == x);
+        CHECK(vars[1].values<double>() == y);
+        CHECK(vars[2].values<double>() == x);
+        return bytes;
+    }
+
+    zcache::blob blob(size_t n)
+    {
+        return std::make_shared<const std::vector<unsigned char>>(n, (unsigned char)n);
+    }
+
+    zcache::key key(uint64_t h)
+    {
+        return {{h, ~h}, 100};
+    }
+
+}
+
+MAT_TEST(zcache, repeats_within_a_file_are_copied)
+{
+    auto plain = write("zcache_plain.mat", nullptr);
+    auto cache = std::make_shared<zcache>();
+    CHECK(write("zcache_cached.mat", cache) == plain);
+    CHECK_EQ(cache->hits(), (dim_t)1);
+    CHECK_EQ(cache->misses(), (dim_t)2);
+    CHECK(cache->size() > 0);
+}
+
+MAT_TEST(zcache, shared_between_files)
+{
+    auto cache = std::make_shared<zcache>();
+    auto first = write("zcache_first.mat", cache);
+    auto second = write("zcache_second.mat", cache);
+    CHECK(first == second);
+    CHECK_EQ(cache->hits(), (dim_t)4);
+    CHECK_EQ(cache->misses(), (dim_t)2);
+}
+
+MAT_TEST(zcache, settings_are_part_of_the_key)
+{
+    auto cache = std::make_shared<zcache>();
+    write("zcache_fast.mat", cache, 1);
+    CHECK(write("zcache_best.mat", cache, 9) == write("zcache_best_plain.mat", nullptr, 9));
+    CHECK_EQ(cache->misses(), (dim_t)4);
+}
+
+MAT_TEST(zcache, names_are_part_of_the_key)
+{
+    auto cache = std::make_shared<zcache>();
+    std::vector<double> x(1000, 1.0);
+    auto path = test::scratch("zcache_names.mat");
+    {
+        file<V7> f(path);
+        compress_options opts;
+        opts.cache = cache;
+        f.compression(opts);
+        f.add("a", x.begin(), x.end());
+        f.add("b", x.begin(), x.end());
+        f.close().get();
+    }
+    CHECK_EQ(cache->hits(), (dim_t)0);
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars[0].name, std::string("a"));
+    CHECK_EQ(vars[1].name, std::string("b"));
+}
+
+MAT_TEST(zcache, per_variable_and_unseekable)
+{
+    auto cache = std::make_shared<zcache>();
+    auto x = series(20000, 0.5);
+    auto path = test::scratch("zcache_stream.mat");
+    {
+        // Unseekable files keep each compressed element in memory, as the cache does
+        FILE *fp = fopen(path.c_str(), "wb");
+        CHECK(fp != nullptr);
+        file<V7> f(std::make_shared<stream_sink>(fp, true));
+        compress_options opts;
+        opts.cache = cache;
+        f.compression("x", opts);
+        f.add("x", x.begin(), x.end());
+        f.add("x", x.begin(), x.end());
+        f.add("y", x.begin(), x.end());
+        f.close().get();
+    }
+    CHECK_EQ(cache->hits(), (dim_t)1);
+    CHECK_EQ(cache->misses(), (dim_t)1);
+    auto vars = test::read_mat(path);
+    CHECK_EQ(vars.size(), (size_t)3);
+    for (auto &v : vars) CHECK(v.values<double>() == x);
+}
+
+MAT_TEST(zcache, least_recently_used_are_dropped)
+{
+    zcache cache(1000);
+    cache.insert(key(1), blob(400));
+    cache.insert(key(2), blob(400));
+    CHECK(cache.find(key(1)) != nullptr);
+    // 2 is now the least recently used, and makes way for 3
+    cache.insert(key(3), blob(400));
+    CHECK(cache.find(key(2)) == nullptr);
+    CHECK(cache.find(key(1)) != nullptr);
+    CHECK(cache.find(key(3)) != nullptr);
+    CHECK_EQ(cache.size(), (dim_t)800);
+    // Larger than the whole cache
+    cache.insert(key(4), blob(1001));
+    CHECK(cache.find(key(4)) == nullptr);
+    CHECK_EQ(cache.size(), (dim_t)800);
+    CHECK_EQ(cache.hits(), (dim_t)3);
+    CHECK_EQ(cache.misses(), (dim_t)2);
+    cache.clear();
+    CHECK_EQ(cache.size(), (dim_t)0);
+    CHECK_EQ(cache.hits(), (dim_t)0);
+    CHECK(cache.find(key(1)) == nullptr);
+}
+
+MAT_TEST(zcache, digest_depends_on_bytes_and_settings)
+{
+    std::vector<unsigned char> a(64, 1), b(64, 1);
+    b[63] = 2;
+    compress_options fast, best;
+    fast.level = 1;
+    best.level = 9;
+    CHECK(zcache::digest(a.data(), a.size(), fast) == zcache::digest(a.data(), a.size(), fast));
+    CHECK(!(zcache::digest(a.data(), a.size(), fast) == zcache::digest(b.data(), b.size(), fast)));
+    CHECK(!(zcache::digest(a.data(), a.size(), fast) == zcache::digest(a.data(), a.size(), best)));
+    CHECK(!(zcache::digest(a.data(), 32, fast) == zcache::digest(a.data(), a.size(), fast)));
+}